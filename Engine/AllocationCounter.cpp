@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "AllocationCounter.h"
+#include "Constants.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace
+{
+	std::atomic<long> s_nAllocations(0);
+}
+
+long AllocationCounter::GetCount()
+{
+	return s_nAllocations.load();
+}
+
+#ifdef BENCHMARK_COLLISION
+
+void * operator new(size_t nBytes)
+{
+	s_nAllocations++;
+
+	void * retVal = malloc(nBytes > 0 ? nBytes : 1);
+
+	if (retVal == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	return retVal;
+}
+
+void * operator new[](size_t nBytes)
+{
+	return operator new(nBytes);
+}
+
+void operator delete(void * pointer)
+{
+	free(pointer);
+}
+
+void operator delete[](void * pointer)
+{
+	free(pointer);
+}
+
+#endif // BENCHMARK_COLLISION
@@ -0,0 +1,16 @@
+#pragma once
+#include "pch.h"
+
+// Counts calls to the global operator new, so the benchmark can
+//	check that a frame of collision detection does not allocate.
+//	operator new is only replaced when BENCHMARK_COLLISION is
+//	defined in Constants.h; otherwise the count stays at 0.
+class AllocationCounter
+{
+public:
+	static long GetCount();
+
+protected:
+
+private:
+};
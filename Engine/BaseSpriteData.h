@@ -1,5 +1,6 @@
 #pragma once
 #include "pch.h"
+#include "Constants.h"
 
 class BaseSpriteData
 {
@@ -14,8 +15,20 @@ public:
 	bool bBlockable;
 	bool bCollidable;
 
+	// COLLISION_LAYER_*, and the layers this sprite may be tested
+	//	against as bits (1 << layer). The spatial hash reads the
+	//	layer when the screen is built.
+	int nLayer;
+	unsigned int nCollisionMask;
+
+	// Unique to every sprite constructed; copies keep it. Collision
+	//	events are keyed and sorted on it.
+	unsigned int nId;
+
 	BaseSpriteData(int column, int row, float x, float y)
 	{
+		this->nId = NextId();
+
 		this->column = column;
 		this->row = row;
 		this->pos.x = x;
@@ -26,6 +39,10 @@ public:
 		this->rotVel = 0.0f;
 
 		this->bBlockable = true;
+		this->bCollidable = true;
+
+		this->nLayer = COLLISION_LAYER_OBSTACLE;
+		this->nCollisionMask = COLLISION_MASK_ALL;
 	}
 
 	void SetBlockable(bool blockable)
@@ -33,8 +50,29 @@ public:
 		this->bBlockable = blockable;
 	}
 
+	// A sprite that is not collidable is never tested at all.
+	void SetCollidable(bool collidable)
+	{
+		this->bCollidable = collidable;
+	}
+
+	void SetLayer(int layer)
+	{
+		this->nLayer = layer;
+	}
+
+	void SetCollisionMask(unsigned int mask)
+	{
+		this->nCollisionMask = mask;
+	}
+
 protected:
 
 private:
+	static unsigned int NextId()
+	{
+		static unsigned int s_nNextId = 0;
 
+		return ++s_nNextId;
+	}
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include "pch.h"
+
+// Axis-aligned box in screen pixels.
+struct BoundingBox
+{
+	float2 lowerBound;
+	float2 upperBound;
+
+	bool Overlaps(const BoundingBox & other) const
+	{
+		return
+			lowerBound.x <= other.upperBound.x &&
+			other.lowerBound.x <= upperBound.x &&
+			lowerBound.y <= other.upperBound.y &&
+			other.lowerBound.y <= upperBound.y;
+	}
+
+	bool Contains(const BoundingBox & other) const
+	{
+		return
+			lowerBound.x <= other.lowerBound.x &&
+			lowerBound.y <= other.lowerBound.y &&
+			other.upperBound.x <= upperBound.x &&
+			other.upperBound.y <= upperBound.y;
+	}
+
+	// Used as the surface area heuristic in 2D.
+	float GetPerimeter() const
+	{
+		return 2.0f * ((upperBound.x - lowerBound.x) + (upperBound.y - lowerBound.y));
+	}
+
+	static BoundingBox Combine(const BoundingBox & a, const BoundingBox & b)
+	{
+		BoundingBox retVal;
+		retVal.lowerBound.x = a.lowerBound.x < b.lowerBound.x ? a.lowerBound.x : b.lowerBound.x;
+		retVal.lowerBound.y = a.lowerBound.y < b.lowerBound.y ? a.lowerBound.y : b.lowerBound.y;
+		retVal.upperBound.x = a.upperBound.x > b.upperBound.x ? a.upperBound.x : b.upperBound.x;
+		retVal.upperBound.y = a.upperBound.y > b.upperBound.y ? a.upperBound.y : b.upperBound.y;
+
+		return retVal;
+	}
+
+	static BoundingBox FromCenter(float2 center, float2 halfSize)
+	{
+		BoundingBox retVal;
+		retVal.lowerBound.x = center.x - halfSize.x;
+		retVal.lowerBound.y = center.y - halfSize.y;
+		retVal.upperBound.x = center.x + halfSize.x;
+		retVal.upperBound.y = center.y + halfSize.y;
+
+		return retVal;
+	}
+};
@@ -1,23 +1,33 @@
 #pragma once
 #include "pch.h"
-#include "CollisionDetectionStrategy.h"
+#include "BroadPhaseStrategy.h"
 #include "Player.h"
 #include <list>
 //#include "GridSpace.h"
 
-class BoundingBoxCornerCollisionStrategy : public CollisionDetectionStrategy
+// A sprite is a candidate when a corner of the player's box is
+//	inside the sprite's box. Cheap, but misses a sprite that only
+//	crosses the middle of one of the player's sides.
+class BoundingBoxCornerCollisionStrategy : public BroadPhaseStrategy<BoundingBoxCornerCollisionStrategy>
 {
 public:
 	BoundingBoxCornerCollisionStrategy();
-	bool Detect(CollisionDetectionInfo * info);
-	void Detect(
-		list<BaseSpriteData> * retVal,
-		float2 playerSize,
-		float2 spriteSize,
-		Player * pPlayer,
-		vector<BaseSpriteData> * sprites,
-		float fWindowWidth,
-		float fWindowHeight);
+
+	bool Accept(const BroadPhaseQuery & query, BaseSpriteData * sprite)
+	{
+		BoundingBox box = GetSpriteBox(query, sprite);
+
+		float left = query.playerBox.lowerBound.x;
+		float right = query.playerBox.upperBound.x;
+		float top = query.playerBox.lowerBound.y;
+		float bottom = query.playerBox.upperBound.y;
+
+		return
+			Contains(box, left, top) ||
+			Contains(box, right, top) ||
+			Contains(box, right, bottom) ||
+			Contains(box, left, bottom);
+	}
 
 protected:
 
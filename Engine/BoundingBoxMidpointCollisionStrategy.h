@@ -1,22 +1,33 @@
 #pragma once
 #include "pch.h"
-#include "CollisionDetectionStrategy.h"
+#include "BroadPhaseStrategy.h"
 #include <list>
 #include "GridSpace.h"
 
-class BoundingBoxMidpointCollisionStrategy : public CollisionDetectionStrategy
+// A sprite is a candidate when the middle of one of the sides of
+//	the player's box is inside the sprite's box. Catches a sprite
+//	square on to the player, which the corners miss, but not one
+//	that only clips a corner.
+class BoundingBoxMidpointCollisionStrategy : public BroadPhaseStrategy<BoundingBoxMidpointCollisionStrategy>
 {
 public:
 	BoundingBoxMidpointCollisionStrategy();
-	bool Detect(CollisionDetectionInfo * info);
-	void Detect(
-		list<BaseSpriteData> * retVal,
-		float2 playerSize,
-		float2 spriteSize,
-		Player * pPlayer,
-		vector<BaseSpriteData> * sprites,
-		float fWindowWidth,
-		float fWindowHeight);
+
+	bool Accept(const BroadPhaseQuery & query, BaseSpriteData * sprite)
+	{
+		BoundingBox box = GetSpriteBox(query, sprite);
+
+		float left = query.playerBox.lowerBound.x;
+		float right = query.playerBox.upperBound.x;
+		float top = query.playerBox.lowerBound.y;
+		float bottom = query.playerBox.upperBound.y;
+
+		return
+			Contains(box, query.center.x, top) ||
+			Contains(box, right, query.center.y) ||
+			Contains(box, query.center.x, bottom) ||
+			Contains(box, left, query.center.y);
+	}
 
 protected:
 
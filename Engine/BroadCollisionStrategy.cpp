@@ -3,21 +3,19 @@
 #include <vector>
 #include "Player.h"
 #include "MathUtils.h"
+#include "CollisionLayers.h"
+#include "Constants.h"
 #include <iostream>
 
 // @see http://www.gamedev.net/page/resources/_/technical/directx-and-xna/pixel-perfect-collision-detection-in-directx-r2939
 BroadCollisionStrategy::BroadCollisionStrategy()
 {
-
-}
-
-bool BroadCollisionStrategy::Detect(CollisionDetectionInfo * info)
-{
-	return false;
+	m_pIndexedSprites = NULL;
+	m_nIndexedSprites = 0;
 }
 
-void BroadCollisionStrategy::Detect(
-	list<BaseSpriteData *> * retVal,
+void BroadCollisionStrategy::FindCandidates(
+	CollisionCandidates * retVal,
 	float2 playerSize,
 	float2 spriteSize,
 	Player * pPlayer,
@@ -36,10 +34,34 @@ void BroadCollisionStrategy::Detect(
 		playerLocation);
 }
 
+void BroadCollisionStrategy::Build(
+	vector<BaseSpriteData *> * sprites,
+	int nColumns,
+	int nRows)
+{
+	m_spatialHash.Resize(nColumns, nRows);
+	m_occupancy.Clear();
+
+	std::vector<BaseSpriteData *>::const_iterator iterator;
+
+	for (iterator = sprites->begin(); iterator != sprites->end(); iterator++)
+	{
+		m_spatialHash.Insert(*iterator);
+
+		if (CollisionLayers::ShouldTest(COLLISION_LAYER_PLAYER, COLLISION_MASK_ALL, *iterator))
+		{
+			m_occupancy.Set((*iterator)->column, (*iterator)->row);
+		}
+	}
+
+	m_pIndexedSprites = sprites;
+	m_nIndexedSprites = sprites->size();
+}
+
 int BroadCollisionStrategy::Calculate(
 	Player * player, 
 	vector<BaseSpriteData *> * sprites, 
-	list<BaseSpriteData *> * retVal,
+	CollisionCandidates * retVal,
 	float fWindowWidth,
 	float fWindowHeight,
 	float * playerLocation)
@@ -55,15 +77,60 @@ int BroadCollisionStrategy::Calculate(
 
 
 	// Don't use grid spaces as locations since sprites might not be
-	//	aligned within a grid space (i.e. moving sprites)
+	//	aligned within a grid space (i.e. moving sprites), so the
+	//	distance test is still applied to the neighbours.
+	if (sprites != m_pIndexedSprites || sprites->size() != m_nIndexedSprites)
+	{
+		Build(sprites, NUM_GRID_COLUMNS, NUM_GRID_ROWS);
+	}
 
-	std::vector<BaseSpriteData *>::const_iterator iterator;
+	// Buckets holding nothing the player can touch are skipped.
+	unsigned int layerMask = CollisionLayers::GetInteractionMask(COLLISION_LAYER_PLAYER);
 
-	for (iterator = sprites->begin(); iterator != sprites->end(); iterator++)
+	m_neighbours.clear();
+
+	// Nothing to find around the player, so the buckets are not
+	//	even looked at.
+	if (m_occupancy.AnyOccupied(
+		nCurrentHorizontalSpace - 1,
+		nCurrentVerticalSpace - 1,
+		nCurrentHorizontalSpace + 1,
+		nCurrentVerticalSpace + 1))
+	{
+		m_spatialHash.QueryNeighbourhood(
+			nCurrentHorizontalSpace,
+			nCurrentVerticalSpace,
+			&m_neighbours,
+			layerMask);
+	}
+
+	CollisionCandidates::const_iterator iterator;
+
+	for (iterator = m_neighbours.begin(); iterator != m_neighbours.end(); iterator++)
 	{
 		BaseSpriteData * sprite = (*iterator);
 
-		if (IsClose(player, sprite, fWindowWidth, fWindowHeight, playerLocation))
+		if (CollisionLayers::ShouldTest(COLLISION_LAYER_PLAYER, COLLISION_MASK_ALL, sprite) &&
+			IsClose(player, sprite, fWindowWidth, fWindowHeight, playerLocation))
+		{
+			retVal->push_back(sprite);
+		}
+	}
+
+	// Moving sprites within reach of the player.
+	float threshold = fWindowWidth * 0.05f;
+	float2 reach(threshold, threshold);
+	float2 center(playerLocation[0], playerLocation[1]);
+
+	m_moving.clear();
+	QueryMovingSprites(BoundingBox::FromCenter(center, reach), &m_moving);
+
+	for (iterator = m_moving.begin(); iterator != m_moving.end(); iterator++)
+	{
+		BaseSpriteData * sprite = (*iterator);
+
+		if (CollisionLayers::ShouldTest(COLLISION_LAYER_PLAYER, COLLISION_MASK_ALL, sprite) &&
+			IsClose(player, sprite, fWindowWidth, fWindowHeight, playerLocation))
 		{
 			retVal->push_back(sprite);
 		}
@@ -72,6 +139,96 @@ int BroadCollisionStrategy::Calculate(
 	return 1;
 }
 
+int BroadCollisionStrategy::AddMovingSprite(BaseSpriteData * sprite, float2 size)
+{
+	MovingSprite moving;
+	moving.sprite = sprite;
+	moving.halfSize.x = size.x * 0.5f;
+	moving.halfSize.y = size.y * 0.5f;
+	moving.proxyId = m_movingTree.CreateProxy(
+		BoundingBox::FromCenter(sprite->pos, moving.halfSize),
+		sprite);
+
+	m_movingSprites.push_back(moving);
+
+	return moving.proxyId;
+}
+
+void BroadCollisionStrategy::RemoveMovingSprite(int proxyId)
+{
+	for (size_t i = 0; i < m_movingSprites.size(); i++)
+	{
+		if (m_movingSprites[i].proxyId == proxyId)
+		{
+			m_movingSprites[i] = m_movingSprites.back();
+			m_movingSprites.pop_back();
+
+			m_movingTree.DestroyProxy(proxyId);
+
+			return;
+		}
+	}
+}
+
+void BroadCollisionStrategy::UpdateMovingSprites(float timeDelta)
+{
+	for (size_t i = 0; i < m_movingSprites.size(); i++)
+	{
+		MovingSprite & moving = m_movingSprites[i];
+
+		float2 displacement(
+			moving.sprite->vel.x * timeDelta,
+			moving.sprite->vel.y * timeDelta);
+
+		m_movingTree.MoveProxy(
+			moving.proxyId,
+			BoundingBox::FromCenter(moving.sprite->pos, moving.halfSize),
+			displacement);
+	}
+}
+
+void BroadCollisionStrategy::QueryMovingPairs(vector<pair<BaseSpriteData *, BaseSpriteData *>> * retVal)
+{
+	m_pairResults.clear();
+	m_movingTree.QueryPairs(&m_pairResults);
+
+	AddMovingPairs(retVal);
+}
+
+void BroadCollisionStrategy::QueryMovingPairs(vector<pair<BaseSpriteData *, BaseSpriteData *>> * retVal, WorkerPool * pool)
+{
+	m_pairResults.clear();
+	m_movingTree.QueryPairs(&m_pairResults, pool);
+
+	AddMovingPairs(retVal);
+}
+
+void BroadCollisionStrategy::AddMovingPairs(vector<pair<BaseSpriteData *, BaseSpriteData *>> * retVal)
+{
+	for (size_t i = 0; i < m_pairResults.size(); i++)
+	{
+		retVal->push_back(make_pair(
+			(BaseSpriteData *)m_movingTree.GetUserData(m_pairResults[i].first),
+			(BaseSpriteData *)m_movingTree.GetUserData(m_pairResults[i].second)));
+	}
+}
+
+void BroadCollisionStrategy::QueryMovingSprites(const BoundingBox & box, CollisionCandidates * retVal)
+{
+	if (m_movingSprites.empty())
+	{
+		return;
+	}
+
+	m_queryResults.clear();
+	m_movingTree.Query(box, &m_queryResults);
+
+	for (size_t i = 0; i < m_queryResults.size(); i++)
+	{
+		retVal->push_back((BaseSpriteData *)m_movingTree.GetUserData(m_queryResults[i]));
+	}
+}
+
 boolean BroadCollisionStrategy::IsClose(
 	Player * player, 
 	BaseSpriteData * data, 
@@ -79,62 +236,30 @@ boolean BroadCollisionStrategy::IsClose(
 	float fWindowHeight,
 	float * playerLocation)
 {
-	float distance = CalculateDistance(
-		*player, 
+	float distanceSquared = CalculateDistanceSquared(
 		data, 
-		fWindowWidth, 
-		fWindowHeight,
 		playerLocation);
 	
 /*
 	char buf[32];
-	sprintf_s(buf, "%f\n", distance);
+	sprintf_s(buf, "%f\n", distanceSquared);
 	OutputDebugStringA(buf);
 */
 
 
-	return (distance < (fWindowWidth * 0.05f));		
+	float threshold = fWindowWidth * 0.05f;
+
+	return (distanceSquared < (threshold * threshold));
 }
 
-float BroadCollisionStrategy::CalculateDistance(
-	Player player, 
+float BroadCollisionStrategy::CalculateDistanceSquared(
 	BaseSpriteData * sprite,
-	float fWindowWidth,
-	float fWindowHeight,
 	float * playerLocation)
 {
-	//float playerLocation[2];
-	float spriteLocation[2];
-
-	// These are within the range of screen pixel size.
-//	playerLocation[0] = (fWindowWidth - (fWindowWidth * LEFT_MARGIN_RATIO) - (fWindowWidth * RIGHT_MARGIN_RATIO)) * player.GetHorizontalRatio() + (fWindowWidth * LEFT_MARGIN_RATIO);
-//	playerLocation[1] = player.GetVerticalRatio() * fWindowHeight;
-
 	// These are within the range of screen pixel size.
-	spriteLocation[0] = sprite->pos.x;
-	spriteLocation[1] = sprite->pos.y;
-
-	float retVal = MathUtils::CalculateDistance(
-		playerLocation[0],
-		playerLocation[1],
-		spriteLocation[0],
-		spriteLocation[1]);
-
-/*
-	char buf[128];
-	sprintf_s(buf,
-		"pX=%f pY=%f sX=%f sY=%f %f %f %f\n",
+	return MathUtils::CalculateDistanceSquared(
 		playerLocation[0],
 		playerLocation[1],
-		spriteLocation[0],
-		spriteLocation[1],
-		retVal,
-		fWindowWidth,
-		player.GetHorizontalRatio());
-
-	OutputDebugStringA(buf);
-*/
-
-	return retVal;
+		sprite->pos.x,
+		sprite->pos.y);
 }
-
@@ -1,18 +1,24 @@
 #pragma once
 #include "pch.h"
-#include "CollisionDetectionStrategy.h"
+#include "BroadPhaseStrategy.h"
 #include "Player.h"
 #include "BaseSpriteData.h"
 #include "GridSpace.h"
+#include "SpatialHashGrid.h"
+#include "DynamicAabbTree.h"
+#include "OccupancyBitboard.h"
+#include <utility>
 
-class BroadCollisionStrategy // : public CollisionDetectionStrategy
+// Finds the sprites around the player through a spatial hash of the
+//	still sprites and a tree of the moving ones, rather than testing
+//	every sprite as the other broad phases do.
+class BroadCollisionStrategy : public BroadPhaseStrategy<BroadCollisionStrategy>
 {
 public:
 	BroadCollisionStrategy();
-	bool Detect(CollisionDetectionInfo * info);
 
-	void Detect(
-		list<BaseSpriteData *> * retVal,
+	void FindCandidates(
+		CollisionCandidates * retVal,
 		float2 playerSize,
 		float2 spriteSize,
 		Player * pPlayer,
@@ -21,11 +27,44 @@ public:
 		float fWindowHeight,
 		float * playerLocation);
 
+	// Buckets the sprites by grid cell. Call whenever the screen
+	//	is rebuilt.
+	void Build(
+		vector<BaseSpriteData *> * sprites,
+		int nColumns,
+		int nRows);
+
+	// Sprites that move (enemies, projectiles, pushed rocks) are kept
+	//	in a dynamic tree rather than the grid. size is in screen
+	//	pixels. Returns an id for RemoveMovingSprite.
+	int AddMovingSprite(BaseSpriteData * sprite, float2 size);
+	void RemoveMovingSprite(int proxyId);
+
+	// Refits the moving sprites to their current positions. Only
+	//	sprites that left their fattened boxes touch the tree.
+	void UpdateMovingSprites(float timeDelta);
+
+	// Appends the pairs of moving sprites that may have started
+	//	overlapping since the last call.
+	void QueryMovingPairs(vector<pair<BaseSpriteData *, BaseSpriteData *>> * retVal);
+
+	// The same, with the tree queried over the workers of pool.
+	void QueryMovingPairs(vector<pair<BaseSpriteData *, BaseSpriteData *>> * retVal, WorkerPool * pool);
+
+	// Appends the moving sprites that may overlap box.
+	void QueryMovingSprites(const BoundingBox & box, CollisionCandidates * retVal);
+
+	// The buckets of the sprites that do not move, for CollisionQuery.
+	SpatialHashGrid * GetSpatialHash()
+	{
+		return &m_spatialHash;
+	}
+
 protected:
 	int Calculate(
 		Player * player, 
 		vector<BaseSpriteData *> * sprites, 
-		list<BaseSpriteData *> * retVal,
+		CollisionCandidates * retVal,
 		float fWindowWidth,
 		float fWindowHeight,
 		float * playerLocation);
@@ -37,12 +76,36 @@ protected:
 		float fWindowHeight,
 		float * playerLocation);
 
-	float CalculateDistance(
-		Player player, 
+	float CalculateDistanceSquared(
 		BaseSpriteData * sprite, 
-		float fWindowWidth, 
-		float fWindowHeight,
 		float * playerLocation);
 
+	// The sprites of the proxy pairs in m_pairResults.
+	void AddMovingPairs(vector<pair<BaseSpriteData *, BaseSpriteData *>> * retVal);
+
 private:
+	SpatialHashGrid m_spatialHash;
+
+	// Grid spaces holding a sprite the player may be tested against.
+	OccupancyBitboard m_occupancy;
+
+	// What m_spatialHash was built from.
+	vector<BaseSpriteData *> * m_pIndexedSprites;
+	size_t m_nIndexedSprites;
+
+	struct MovingSprite
+	{
+		int proxyId;
+		BaseSpriteData * sprite;
+		float2 halfSize;
+	};
+
+	// Kept between frames so that they stop allocating.
+	CollisionCandidates m_neighbours;
+	CollisionCandidates m_moving;
+
+	DynamicAabbTree m_movingTree;
+	vector<MovingSprite> m_movingSprites;
+	vector<int> m_queryResults;
+	vector<pair<int, int>> m_pairResults;
 };
\ No newline at end of file
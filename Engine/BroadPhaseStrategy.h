@@ -0,0 +1,115 @@
+#pragma once
+#include "pch.h"
+#include "CollisionDetectionStrategy.h"
+#include "CollisionLayers.h"
+#include "BoundingBox.h"
+#include "Player.h"
+#include "BaseSpriteData.h"
+
+// What a broad phase tests every sprite against, worked out once
+//	per call rather than once per sprite.
+struct BroadPhaseQuery
+{
+	Player * pPlayer;
+
+	// Centre of the player, in screen pixels.
+	float2 center;
+	float2 playerHalfSize;
+	float2 spriteHalfSize;
+
+	BoundingBox playerBox;
+};
+
+// Base of the broad phases. Derived is the strategy itself (CRTP), so
+//	CollisionPipeline can call FindCandidates with the strategy's own
+//	test inlined into the loop, while Detect still serves whoever only
+//	has a CollisionDetectionStrategy.
+//
+//	A strategy either provides
+//
+//		bool Accept(const BroadPhaseQuery & query, BaseSpriteData * sprite);
+//
+//	and lets FindCandidates walk every sprite, or hides FindCandidates
+//	with one of its own that uses an index instead.
+template<class Derived>
+class BroadPhaseStrategy : public CollisionDetectionStrategy
+{
+public:
+	bool Detect(CollisionDetectionInfo * info)
+	{
+		return false;
+	}
+
+	void Detect(
+		CollisionCandidates * retVal,
+		float2 playerSize,
+		float2 spriteSize,
+		Player * pPlayer,
+		vector<BaseSpriteData *> * sprites,
+		float fWindowWidth,
+		float fWindowHeight,
+		float * playerLocation)
+	{
+		static_cast<Derived *>(this)->FindCandidates(
+			retVal,
+			playerSize,
+			spriteSize,
+			pPlayer,
+			sprites,
+			fWindowWidth,
+			fWindowHeight,
+			playerLocation);
+	}
+
+	void FindCandidates(
+		CollisionCandidates * retVal,
+		float2 playerSize,
+		float2 spriteSize,
+		Player * pPlayer,
+		vector<BaseSpriteData *> * sprites,
+		float fWindowWidth,
+		float fWindowHeight,
+		float * playerLocation)
+	{
+		BroadPhaseQuery query;
+		query.pPlayer = pPlayer;
+		query.center = float2(playerLocation[0], playerLocation[1]);
+		query.playerHalfSize = float2(playerSize.x / 2.0f, playerSize.y / 2.0f);
+		query.spriteHalfSize = float2(spriteSize.x / 2.0f, spriteSize.y / 2.0f);
+		query.playerBox = BoundingBox::FromCenter(query.center, query.playerHalfSize);
+
+		Derived * derived = static_cast<Derived *>(this);
+
+		std::vector<BaseSpriteData *>::const_iterator iterator;
+
+		for (iterator = sprites->begin(); iterator != sprites->end(); iterator++)
+		{
+			BaseSpriteData * sprite = (*iterator);
+
+			if (CollisionLayers::ShouldTest(COLLISION_LAYER_PLAYER, COLLISION_MASK_ALL, sprite) &&
+				derived->Accept(query, sprite))
+			{
+				retVal->push_back(sprite);
+			}
+		}
+	}
+
+protected:
+	BroadPhaseStrategy(){}
+
+	static BoundingBox GetSpriteBox(const BroadPhaseQuery & query, BaseSpriteData * sprite)
+	{
+		return BoundingBox::FromCenter(sprite->pos, query.spriteHalfSize);
+	}
+
+	static bool Contains(const BoundingBox & box, float x, float y)
+	{
+		return
+			x >= box.lowerBound.x &&
+			x <= box.upperBound.x &&
+			y >= box.lowerBound.y &&
+			y <= box.upperBound.y;
+	}
+
+private:
+};
@@ -1,25 +1,91 @@
 #include "pch.h"
 #include "CircularZoneCollisionStrategy.h"
+#include "CollisionKernels.h"
+#include "CollisionLayers.h"
 #include <list>
 
 using namespace std;
 
 CircularZoneCollisionStrategy::CircularZoneCollisionStrategy()
 {
+	m_pIndexedSprites = NULL;
+	m_nIndexedSprites = 0;
 }
 
-bool CircularZoneCollisionStrategy::Detect(CollisionDetectionInfo * info)
-{
-	return false;
-}
-
-void CircularZoneCollisionStrategy::Detect(
-	list<BaseSpriteData> * retVal,
+void CircularZoneCollisionStrategy::FindCandidates(
+	CollisionCandidates * retVal,
 	float2 playerSize,
 	float2 spriteSize,
 	Player * pPlayer,
-	vector<BaseSpriteData> * sprites,
+	vector<BaseSpriteData *> * sprites,
 	float fWindowWidth,
-	float fWindowHeight)
+	float fWindowHeight,
+	float * playerLocation)
+{
+	if (sprites != m_pIndexedSprites ||
+		sprites->size() != m_nIndexedSprites ||
+		spriteSize.x != m_indexedSize.x ||
+		spriteSize.y != m_indexedSize.y)
+	{
+		Build(sprites, spriteSize);
+	}
+
+	const int * hits;
+
+	int nHits = Query(
+		float2(playerLocation[0], playerLocation[1]),
+		(std::min)(playerSize.x, playerSize.y) / 2.0f,
+		&hits);
+
+	for (int i = 0; i < nHits; i++)
+	{
+		BaseSpriteData * sprite = (*sprites)[hits[i]];
+
+		if (CollisionLayers::ShouldTest(COLLISION_LAYER_PLAYER, COLLISION_MASK_ALL, sprite))
+		{
+			retVal->push_back(sprite);
+		}
+	}
+}
+
+void CircularZoneCollisionStrategy::Build(vector<BaseSpriteData *> * sprites, float2 spriteSize)
 {
-}
\ No newline at end of file
+	size_t count = sprites->size();
+	float radius = (std::min)(spriteSize.x, spriteSize.y) / 2.0f;
+
+	m_x.resize(count);
+	m_y.resize(count);
+	m_radius.resize(count);
+	m_hits.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		m_x[i] = (*sprites)[i]->pos.x;
+		m_y[i] = (*sprites)[i]->pos.y;
+		m_radius[i] = radius;
+	}
+
+	m_pIndexedSprites = sprites;
+	m_nIndexedSprites = count;
+	m_indexedSize = spriteSize;
+}
+
+int CircularZoneCollisionStrategy::Query(float2 center, float fRadius, const int ** hits)
+{
+	*hits = m_hits.empty() ? NULL : &m_hits[0];
+
+	if (m_x.empty())
+	{
+		return 0;
+	}
+
+	return CollisionKernels::Get()->CirclesOverlap(
+		&m_x[0],
+		&m_y[0],
+		&m_radius[0],
+		(int)m_x.size(),
+		center.x,
+		center.y,
+		fRadius,
+		&m_hits[0]);
+}
@@ -1,26 +1,63 @@
 #pragma once
 #include "pch.h"
-#include "CollisionDetectionStrategy.h"
+#include "BroadPhaseStrategy.h"
 #include "Player.h"
 #include "BaseSpriteData.h"
 #include <list>
 #include "GridSpace.h"
 
-class CircularZoneCollisionStrategy : public CollisionDetectionStrategy
+// The player and every sprite are circles inscribed in their boxes;
+//	a sprite is a candidate when the circles overlap. Corners of the
+//	boxes are cut off, so this errs towards letting the player past.
+//
+//	The centres and radii are kept as separate arrays, so the test
+//	runs through CollisionKernelTable::CirclesOverlap, 8 circles at
+//	a time with AVX2 and 4 with SSE2.
+class CircularZoneCollisionStrategy : public BroadPhaseStrategy<CircularZoneCollisionStrategy>
 {
 public:
 	CircularZoneCollisionStrategy();
-	bool Detect(CollisionDetectionInfo * info);
-	void Detect(
-		list<BaseSpriteData> * retVal,
+
+	void FindCandidates(
+		CollisionCandidates * retVal,
 		float2 playerSize,
 		float2 spriteSize,
 		Player * pPlayer,
-		vector<BaseSpriteData> * sprites,
+		vector<BaseSpriteData *> * sprites,
 		float fWindowWidth,
-		float fWindowHeight);
+		float fWindowHeight,
+		float * playerLocation);
+
+	// Copies the centres and radii of sprites into the arrays.
+	//	FindCandidates calls it when given other sprites or another
+	//	size, or after Invalidate; call one of the two whenever the
+	//	sprites have moved.
+	void Build(vector<BaseSpriteData *> * sprites, float2 spriteSize);
+
+	// The same vector can hold a new screen's sprites, so the next
+	//	FindCandidates builds the arrays again.
+	void Invalidate()
+	{
+		m_pIndexedSprites = NULL;
+	}
+
+	// Indices, into the sprites given to Build, of the circles that
+	//	overlap the one at center; returns how many. They stay in
+	//	*hits until the next call.
+	int Query(float2 center, float fRadius, const int ** hits);
 
 protected:
 
 private:
-};
\ No newline at end of file
+	vector<float> m_x;
+	vector<float> m_y;
+	vector<float> m_radius;
+
+	// One per circle, so the kernel can write every lane.
+	vector<int> m_hits;
+
+	// What the arrays were built from.
+	vector<BaseSpriteData *> * m_pIndexedSprites;
+	size_t m_nIndexedSprites;
+	float2 m_indexedSize;
+};
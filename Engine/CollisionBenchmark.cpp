@@ -0,0 +1,844 @@
+#include "pch.h"
+#include "CollisionBenchmark.h"
+#include "NarrowCollisionStrategy.h"
+#include "CollisionKernels.h"
+#include "BasicTimer.h"
+#include "DynamicAabbTree.h"
+#include "SweepAndPrune.h"
+#include "BroadCollisionStrategy.h"
+#include "BoundingBoxCornerCollisionStrategy.h"
+#include "BoundingBoxMidpointCollisionStrategy.h"
+#include "CircularZoneCollisionStrategy.h"
+#include "SpriteOverlapCollisionStrategy.h"
+#include "CollisionPipeline.h"
+#include "ParallelNarrowPhase.h"
+#include "WorkerPool.h"
+#include "FrameArena.h"
+#include "AllocationCounter.h"
+#include "Constants.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <math.h>
+#include <thread>
+
+void CollisionBenchmark::NarrowPhase(
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,
+	int width,
+	int height)
+{
+	if (playerMasks == NULL || obstacleMasks == NULL)
+	{
+		return;
+	}
+
+	// Build the packed masks at the benchmark size rather than
+	//	whatever size the window currently renders at.
+	CollisionMaskSet player = *playerMasks;
+	CollisionMaskSet obstacle = *obstacleMasks;
+
+	player.scaled = player.mask.Resample(width, height);
+	obstacle.scaled = obstacle.mask.Resample(width, height);
+	player.packed = PackedCollisionMask(&player.mask, width, height);
+	obstacle.packed = PackedCollisionMask(&obstacle.mask, width, height);
+	player.hierarchy = CollisionMaskHierarchy(&player.packed);
+	obstacle.hierarchy = CollisionMaskHierarchy(&obstacle.packed);
+	player.scaledShape = player.shape.Scale(width, height);
+	obstacle.scaledShape = obstacle.shape.Scale(width, height);
+
+	NarrowCollisionStrategy strategy;
+	BasicTimer ^ timer = ref new BasicTimer();
+
+	int renderedSpriteDimensions[2] = { width, height };
+	int playerTopLeft[2] = { 0, 0 };
+
+	int modes[6] = { NARROW_PHASE_PER_PIXEL, NARROW_PHASE_ALPHA, NARROW_PHASE_PACKED, NARROW_PHASE_HIERARCHY, NARROW_PHASE_POLYGON, NARROW_PHASE_DISTANCE_FIELD };
+	const char * modeNames[6] = { "per-pixel", "alpha", "packed", "hierarchy", "polygon", "distance field" };
+
+	int instructionSets[3] = { COLLISION_KERNEL_SCALAR, COLLISION_KERNEL_SSE2, COLLISION_KERNEL_AVX2 };
+	int nSelected = CollisionKernels::Get()->nInstructionSet;
+
+	for (int isa = 0; isa < 3; isa++)
+	{
+		if (!CollisionKernels::Select(instructionSets[isa]))
+		{
+			continue;
+		}
+
+		for (int mode = 0; mode < 6; mode++)
+		{
+			// Only the packed and alpha paths use the kernels.
+			if ((modes[mode] == NARROW_PHASE_PER_PIXEL ||
+				modes[mode] == NARROW_PHASE_POLYGON ||
+				modes[mode] == NARROW_PHASE_DISTANCE_FIELD) && isa > 0)
+			{
+				continue;
+			}
+
+			int nTests = 0;
+			int nCollisions = 0;
+
+			strategy.SetMode(modes[mode]);
+			timer->Update();
+
+			for (int dy = 1 - height; dy < height; dy++)
+			{
+				for (int dx = 1 - width; dx < width; dx++)
+				{
+					int obstacleTopLeft[2] = { dx, dy };
+					int intersectRect[4];
+
+					if (strategy.IntersectRect(playerTopLeft, obstacleTopLeft, width, height, intersectRect))
+					{
+						if (strategy.TestPixels(
+							&player,
+							&obstacle,
+							playerTopLeft,
+							obstacleTopLeft,
+							renderedSpriteDimensions,
+							intersectRect))
+						{
+							nCollisions++;
+						}
+
+						nTests++;
+					}
+				}
+			}
+
+			timer->Update();
+
+			// Every pixel path must agree on the number of collisions;
+			//	the polygons and distance fields should come within a
+			//	few percent.
+			char name[64];
+			sprintf_s(name, "%s (%s)", modeNames[mode], CollisionKernels::Get()->name);
+
+			Report(name, timer->Delta, nTests, nCollisions);
+		}
+	}
+
+	CollisionKernels::Select(nSelected);
+}
+
+void CollisionBenchmark::BroadPhase(int nBodies, int nFrames)
+{
+	// About one 32 pixel sprite per 64 x 64 pixels.
+	float fSide = 64.0f * sqrtf((float)nBodies);
+	float2 halfSize(16.0f, 16.0f);
+
+	std::vector<BoundingBox> start(nBodies);
+	std::vector<float2> startVelocities(nBodies);
+
+	srand(1);
+
+	for (int i = 0; i < nBodies; i++)
+	{
+		float2 center(
+			fSide * rand() / RAND_MAX,
+			fSide * rand() / RAND_MAX);
+
+		// Up to 2 pixels per frame in each direction.
+		startVelocities[i] = float2(
+			4.0f * rand() / RAND_MAX - 2.0f,
+			4.0f * rand() / RAND_MAX - 2.0f);
+
+		start[i] = BoundingBox::FromCenter(center, halfSize);
+	}
+
+	BasicTimer ^ timer = ref new BasicTimer();
+	char name[64];
+
+	// Dynamic tree: refit and collect the pairs of moved proxies.
+	{
+		std::vector<BoundingBox> boxes = start;
+		std::vector<float2> velocities = startVelocities;
+		std::vector<int> proxies(nBodies);
+
+		DynamicAabbTree tree;
+
+		for (int i = 0; i < nBodies; i++)
+		{
+			proxies[i] = tree.CreateProxy(boxes[i], NULL);
+		}
+
+		std::vector<std::pair<int, int>> pairs;
+		tree.QueryPairs(&pairs);
+
+		int nPairs = 0;
+		timer->Update();
+
+		for (int frame = 0; frame < nFrames; frame++)
+		{
+			MoveBodies(&boxes, &velocities, fSide);
+
+			for (int i = 0; i < nBodies; i++)
+			{
+				tree.MoveProxy(proxies[i], boxes[i], velocities[i]);
+			}
+
+			pairs.clear();
+			tree.QueryPairs(&pairs);
+
+			nPairs += (int)pairs.size();
+		}
+
+		timer->Update();
+
+		sprintf_s(name, "aabb tree %d bodies", nBodies);
+		Report(name, timer->Delta, nBodies * nFrames, nPairs);
+	}
+
+	// Sweep-and-prune: update endpoints and collect the pair changes.
+	{
+		std::vector<BoundingBox> boxes = start;
+		std::vector<float2> velocities = startVelocities;
+		std::vector<int> proxies(nBodies);
+
+		SweepAndPrune sweepAndPrune;
+		sweepAndPrune.AddProxies(&boxes[0], NULL, nBodies, &proxies[0]);
+
+		std::vector<std::pair<int, int>> added;
+		std::vector<std::pair<int, int>> removed;
+		sweepAndPrune.GetPairChanges(&added, &removed);
+
+		int nChanges = 0;
+		timer->Update();
+
+		for (int frame = 0; frame < nFrames; frame++)
+		{
+			MoveBodies(&boxes, &velocities, fSide);
+
+			for (int i = 0; i < nBodies; i++)
+			{
+				sweepAndPrune.UpdateProxy(proxies[i], boxes[i]);
+			}
+
+			added.clear();
+			removed.clear();
+			sweepAndPrune.GetPairChanges(&added, &removed);
+
+			nChanges += (int)(added.size() + removed.size());
+		}
+
+		timer->Update();
+
+		sprintf_s(name, "sweep and prune %d bodies", nBodies);
+		Report(name, timer->Delta, nBodies * nFrames, nChanges);
+	}
+}
+
+void CollisionBenchmark::SteadyState(
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,
+	int nFrames)
+{
+	if (playerMasks == NULL || obstacleMasks == NULL)
+	{
+		return;
+	}
+
+	float fWindowWidth = 1024.0f;
+	float fWindowHeight = 768.0f;
+
+	Grid grid;
+	CollisionMaskSet player = *playerMasks;
+	CollisionMaskSet obstacle = *obstacleMasks;
+	std::vector<BaseSpriteData> obstacles;
+	std::vector<BaseSpriteData *> sprites;
+
+	BuildScreen(fWindowWidth, fWindowHeight, &grid, &player, &obstacle, &obstacles, &sprites);
+
+	int width = (int)grid.GetColumnWidth();
+	int height = (int)grid.GetRowHeight();
+
+	Player walker(&grid);
+	BroadCollisionStrategy broad;
+	NarrowCollisionStrategy narrow;
+	FrameArena arena(FRAME_ARENA_SIZE);
+	DirectionalCollsionDetectionInfo contacts;
+	DirectionalCollsionDetectionInfo unblocked;
+	unblocked.Clear();
+
+	CollisionCandidates collided;
+	collided.SetArena(&arena);
+
+	CollisionEventStream events;
+	BaseSpriteData walkerSprite(0, 0, 0.0f, 0.0f);
+	narrow.SetEventStream(&events, &walkerSprite);
+	int nEnterEvents = 0;
+
+	float2 spriteSize((float)width, (float)height);
+	int intersectRect[4];
+	long nAllocations = 0;
+	int nCollisions = 0;
+
+	// The first frames grow whatever the loop keeps between frames.
+	int nWarmUpFrames = 8;
+
+	for (int frame = 0; frame < nWarmUpFrames + nFrames; frame++)
+	{
+		if (frame == nWarmUpFrames)
+		{
+			nAllocations = AllocationCounter::GetCount();
+		}
+
+		// Walk the player back and forth across the middle row.
+		if (frame % 200 < 100)
+		{
+			walker.MoveEast(&unblocked, 0.01f);
+		}
+		else
+		{
+			walker.MoveWest(&unblocked, 0.01f);
+		}
+
+		float playerLocation[2];
+		playerLocation[HORIZONTAL_AXIS] = walker.GetHorizontalRatio() * fWindowWidth;
+		playerLocation[VERTICAL_AXIS] = walker.GetVerticalRatio() * fWindowHeight;
+
+		broad.Detect(
+			&collided,
+			spriteSize,
+			spriteSize,
+			&walker,
+			&sprites,
+			fWindowWidth,
+			fWindowHeight,
+			playerLocation);
+
+		events.BeginFrame();
+
+		if (narrow.Detect(
+			&player,
+			&obstacle,
+			&walker,
+			&collided,
+			playerLocation,
+			&grid,
+			intersectRect,
+			&contacts) == COLLISION)
+		{
+			nCollisions++;
+		}
+
+		events.EndFrame();
+
+		for (int i = 0; i < events.GetNumEvents(); i++)
+		{
+			if (events.GetEvent(i).nType == COLLISION_EVENT_ENTER)
+			{
+				nEnterEvents++;
+			}
+		}
+
+		collided.clear();
+		arena.Reset();
+	}
+
+	nAllocations = AllocationCounter::GetCount() - nAllocations;
+
+	char buf[192];
+	sprintf_s(
+		buf,
+		"steady state: %d frames, %d collisions, %d enter events, %ld allocations, %d arena bytes, %.0f%% pair cache hits\n",
+		nFrames,
+		nCollisions,
+		nEnterEvents,
+		nAllocations,
+		(int)arena.GetHighWater(),
+		narrow.GetPairCache()->GetHitRate() * 100.0f);
+
+	OutputDebugStringA(buf);
+}
+
+namespace
+{
+	// Runs pipeline, a CollisionPipeline or a RuntimeCollisionPipeline,
+	//	while a player walks back and forth across the middle row of
+	//	the screen. Returns the frames that collided.
+	template<class Pipeline>
+	int Walk(
+		Pipeline * pipeline,
+		Grid * grid,
+		CollisionMaskSet * player,
+		CollisionMaskSet * obstacle,
+		std::vector<BaseSpriteData *> * sprites,
+		int nFrames,
+		int * pnCandidates)
+	{
+		float fWindowWidth = grid->GetWindowWidth();
+		float fWindowHeight = grid->GetWindowHeight();
+		float2 spriteSize(grid->GetColumnWidth(), grid->GetRowHeight());
+
+		Player walker(grid);
+		DirectionalCollsionDetectionInfo contacts;
+		DirectionalCollsionDetectionInfo unblocked;
+		unblocked.Clear();
+
+		CollisionCandidates candidates;
+		int intersectRect[4];
+		int nCollisions = 0;
+
+		*pnCandidates = 0;
+
+		for (int frame = 0; frame < nFrames; frame++)
+		{
+			if (frame % 200 < 100)
+			{
+				walker.MoveEast(&unblocked, 0.01f);
+			}
+			else
+			{
+				walker.MoveWest(&unblocked, 0.01f);
+			}
+
+			float playerLocation[2];
+			playerLocation[HORIZONTAL_AXIS] = walker.GetHorizontalRatio() * fWindowWidth;
+			playerLocation[VERTICAL_AXIS] = walker.GetVerticalRatio() * fWindowHeight;
+
+			if (pipeline->Detect(
+				&candidates,
+				spriteSize,
+				spriteSize,
+				&walker,
+				sprites,
+				fWindowWidth,
+				fWindowHeight,
+				playerLocation,
+				player,
+				obstacle,
+				grid,
+				intersectRect,
+				&contacts) == COLLISION)
+			{
+				nCollisions++;
+			}
+
+			*pnCandidates += (int)candidates.size();
+			candidates.clear();
+		}
+
+		return nCollisions;
+	}
+
+	// Times broad with the narrow phase, first through a
+	//	CollisionPipeline and then through runtime, switched to the
+	//	same strategy. Each is run once untimed so that both start
+	//	with the same caches.
+	template<class BroadPhase>
+	void CompareDispatch(
+		BroadPhase * broad,
+		int nBroadPhase,
+		NarrowCollisionStrategy * narrow,
+		RuntimeCollisionPipeline * runtime,
+		Grid * grid,
+		CollisionMaskSet * player,
+		CollisionMaskSet * obstacle,
+		std::vector<BaseSpriteData *> * sprites,
+		int nFrames)
+	{
+		CollisionPipeline<BroadPhase, NarrowCollisionStrategy> pipeline(broad, narrow);
+		runtime->SetBroadPhase(nBroadPhase);
+
+		BasicTimer ^ timer = ref new BasicTimer();
+
+		for (int dispatch = 0; dispatch < 2; dispatch++)
+		{
+			int nCandidates;
+			int nCollisions;
+
+			if (dispatch == 0)
+			{
+				Walk(&pipeline, grid, player, obstacle, sprites, nFrames, &nCandidates);
+				timer->Update();
+				nCollisions = Walk(&pipeline, grid, player, obstacle, sprites, nFrames, &nCandidates);
+				timer->Update();
+			}
+			else
+			{
+				Walk(runtime, grid, player, obstacle, sprites, nFrames, &nCandidates);
+				timer->Update();
+				nCollisions = Walk(runtime, grid, player, obstacle, sprites, nFrames, &nCandidates);
+				timer->Update();
+			}
+
+			char buf[160];
+			sprintf_s(
+				buf,
+				"%s (%s): %d frames, %d candidates, %d collisions, %.1f ns/frame\n",
+				RuntimeCollisionPipeline::GetBroadPhaseName(nBroadPhase),
+				dispatch == 0 ? "static" : "runtime",
+				nFrames,
+				nCandidates,
+				nCollisions,
+				timer->Delta * 1.0e9f / nFrames);
+
+			OutputDebugStringA(buf);
+		}
+	}
+}
+
+void CollisionBenchmark::Strategies(
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,
+	int nFrames)
+{
+	if (playerMasks == NULL || obstacleMasks == NULL)
+	{
+		return;
+	}
+
+	Grid grid;
+	CollisionMaskSet player = *playerMasks;
+	CollisionMaskSet obstacle = *obstacleMasks;
+	std::vector<BaseSpriteData> obstacles;
+	std::vector<BaseSpriteData *> sprites;
+
+	BuildScreen(1024.0f, 768.0f, &grid, &player, &obstacle, &obstacles, &sprites);
+
+	NarrowCollisionStrategy narrow;
+
+	BroadCollisionStrategy gridStrategy;
+	BoundingBoxCornerCollisionStrategy corner;
+	BoundingBoxMidpointCollisionStrategy midpoint;
+	CircularZoneCollisionStrategy circularZone;
+	SpriteOverlapCollisionStrategy spriteOverlap;
+
+	RuntimeCollisionPipeline runtime(&gridStrategy, &narrow);
+
+	CompareDispatch(&gridStrategy, BROAD_PHASE_GRID, &narrow, &runtime, &grid, &player, &obstacle, &sprites, nFrames);
+	CompareDispatch(&corner, BROAD_PHASE_CORNER, &narrow, &runtime, &grid, &player, &obstacle, &sprites, nFrames);
+	CompareDispatch(&midpoint, BROAD_PHASE_MIDPOINT, &narrow, &runtime, &grid, &player, &obstacle, &sprites, nFrames);
+	CompareDispatch(&circularZone, BROAD_PHASE_CIRCULAR_ZONE, &narrow, &runtime, &grid, &player, &obstacle, &sprites, nFrames);
+	CompareDispatch(&spriteOverlap, BROAD_PHASE_SPRITE_OVERLAP, &narrow, &runtime, &grid, &player, &obstacle, &sprites, nFrames);
+}
+
+void CollisionBenchmark::Parallel(
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,
+	int nBodies,
+	int nFrames)
+{
+	if (playerMasks == NULL || obstacleMasks == NULL)
+	{
+		return;
+	}
+
+	int width = 32;
+	int height = 32;
+
+	CollisionMaskSet player = *playerMasks;
+	CollisionMaskSet obstacle = *obstacleMasks;
+
+	player.packed = PackedCollisionMask(&player.mask, width, height);
+	obstacle.packed = PackedCollisionMask(&obstacle.mask, width, height);
+	player.hierarchy = CollisionMaskHierarchy(&player.packed);
+	obstacle.hierarchy = CollisionMaskHierarchy(&obstacle.packed);
+
+	// Crowded enough that most sprites touch a neighbour or two.
+	float fSide = 40.0f * sqrtf((float)nBodies);
+	float2 size((float)width, (float)height);
+
+	int nCores = (std::max)(1, (int)std::thread::hardware_concurrency());
+
+	// What the first run found, for the others to match.
+	unsigned long long nExpected = 0;
+	float fSingleSeconds = 0.0f;
+
+	BasicTimer ^ timer = ref new BasicTimer();
+
+	for (int nWorkers = 1; nWorkers <= nCores; nWorkers++)
+	{
+		// The same start every run. The ids are new every run, so
+		//	they are taken relative to the first sprite's.
+		std::vector<BaseSpriteData> bodies;
+		bodies.reserve(nBodies);
+
+		srand(1);
+
+		for (int i = 0; i < nBodies; i++)
+		{
+			bodies.push_back(BaseSpriteData(
+				0,
+				0,
+				fSide * rand() / RAND_MAX,
+				fSide * rand() / RAND_MAX));
+
+			bodies.back().vel = float2(
+				4.0f * rand() / RAND_MAX - 2.0f,
+				4.0f * rand() / RAND_MAX - 2.0f);
+		}
+
+		unsigned int nFirstId = bodies[0].nId;
+
+		WorkerPool pool(nWorkers);
+		BroadCollisionStrategy broad;
+		NarrowCollisionStrategy narrow;
+		ParallelNarrowPhase parallel(&narrow, &pool);
+
+		for (int i = 0; i < nBodies; i++)
+		{
+			broad.AddMovingSprite(&bodies[i], size);
+		}
+
+		std::vector<std::pair<BaseSpriteData *, BaseSpriteData *>> pairs;
+		std::vector<CollisionPairTest> tests;
+		std::vector<CollisionPairResult> results;
+
+		// FNV-1a over every result, to tell runs apart.
+		unsigned long long nHash = 14695981039346656037ULL;
+		int nPairs = 0;
+		int nCollisions = 0;
+
+		timer->Update();
+
+		for (int frame = 0; frame < nFrames; frame++)
+		{
+			for (int i = 0; i < nBodies; i++)
+			{
+				BaseSpriteData & body = bodies[i];
+
+				if (body.pos.x + body.vel.x < 0.0f || body.pos.x + body.vel.x > fSide)
+				{
+					body.vel.x = -body.vel.x;
+				}
+
+				if (body.pos.y + body.vel.y < 0.0f || body.pos.y + body.vel.y > fSide)
+				{
+					body.vel.y = -body.vel.y;
+				}
+
+				body.pos.x += body.vel.x;
+				body.pos.y += body.vel.y;
+			}
+
+			broad.UpdateMovingSprites(1.0f);
+
+			pairs.clear();
+			broad.QueryMovingPairs(&pairs, &pool);
+
+			// Half the sprites wear each mask.
+			tests.clear();
+
+			for (size_t i = 0; i < pairs.size(); i++)
+			{
+				CollisionPairTest test;
+				test.a = pairs[i].first;
+				test.b = pairs[i].second;
+				test.aMasks = (test.a->nId & 1) ? &player : &obstacle;
+				test.bMasks = (test.b->nId & 1) ? &player : &obstacle;
+
+				tests.push_back(test);
+			}
+
+			results.clear();
+			nCollisions += parallel.Detect(&tests, width, height, &results);
+			nPairs += (int)tests.size();
+
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				unsigned long long values[4];
+				values[0] = ((unsigned long long)(results[i].a->nId - nFirstId) << 32) | (results[i].b->nId - nFirstId);
+				values[1] = (unsigned long long)(results[i].depth * 1024.0f);
+				values[2] = (unsigned long long)(long long)(results[i].normal.x * 1024.0f);
+				values[3] = (unsigned long long)(long long)(results[i].normal.y * 1024.0f);
+
+				for (int j = 0; j < 4; j++)
+				{
+					nHash = (nHash ^ values[j]) * 1099511628211ULL;
+				}
+			}
+		}
+
+		timer->Update();
+
+		if (nWorkers == 1)
+		{
+			nExpected = nHash;
+			fSingleSeconds = timer->Delta;
+		}
+
+		char buf[192];
+		sprintf_s(
+			buf,
+			"parallel, %d workers: %d bodies, %d pairs, %d collisions, %.3f ms/frame, %.2fx, %s\n",
+			nWorkers,
+			nBodies,
+			nPairs,
+			nCollisions,
+			timer->Delta * 1000.0f / nFrames,
+			timer->Delta > 0.0f ? fSingleSeconds / timer->Delta : 0.0f,
+			nHash == nExpected ? "same results" : "RESULTS DIFFER");
+
+		OutputDebugStringA(buf);
+	}
+}
+
+void CollisionBenchmark::Circles(int nCircles, int nFrames)
+{
+	// About one 32 pixel circle per 64 x 64 pixels, as in BroadPhase.
+	float fSide = 64.0f * sqrtf((float)nCircles);
+
+	std::vector<BaseSpriteData> circles;
+	std::vector<BaseSpriteData *> sprites;
+
+	circles.reserve(nCircles);
+	srand(1);
+
+	for (int i = 0; i < nCircles; i++)
+	{
+		circles.push_back(BaseSpriteData(0, 0, fSide * rand() / RAND_MAX, fSide * rand() / RAND_MAX));
+		sprites.push_back(&circles.back());
+	}
+
+	CircularZoneCollisionStrategy strategy;
+	strategy.Build(&sprites, float2(32.0f, 32.0f));
+
+	BasicTimer ^ timer = ref new BasicTimer();
+
+	int instructionSets[3] = { COLLISION_KERNEL_SCALAR, COLLISION_KERNEL_SSE2, COLLISION_KERNEL_AVX2 };
+	int nSelected = CollisionKernels::Get()->nInstructionSet;
+
+	// The scalar kernel runs first, and every hit list, in order, is
+	//	hashed into a number the other sets must match.
+	unsigned long long nExpected = 0;
+
+	for (int isa = 0; isa < 3; isa++)
+	{
+		if (!CollisionKernels::Select(instructionSets[isa]))
+		{
+			continue;
+		}
+
+		int nHits = 0;
+		unsigned long long nHash = 14695981039346656037ULL;
+
+		timer->Update();
+
+		for (int frame = 0; frame < nFrames; frame++)
+		{
+			// An explosion sweeping along the diagonal.
+			float t = (float)frame / (float)nFrames;
+			const int * hits;
+
+			int nFrameHits = strategy.Query(float2(t * fSide, t * fSide), 256.0f, &hits);
+			nHits += nFrameHits;
+
+			for (int i = 0; i < nFrameHits; i++)
+			{
+				nHash = (nHash ^ (unsigned long long)hits[i]) * 1099511628211ULL;
+			}
+
+			// Ends the frame, so that a hit cannot move between frames.
+			nHash = (nHash ^ 0xFFFFFFFFULL) * 1099511628211ULL;
+		}
+
+		timer->Update();
+
+		if (instructionSets[isa] == COLLISION_KERNEL_SCALAR)
+		{
+			nExpected = nHash;
+		}
+
+		char buf[160];
+		sprintf_s(
+			buf,
+			"circles (%s): %d circles, %d hits, %.3f ms/frame, %s\n",
+			CollisionKernels::Get()->name,
+			nCircles,
+			nHits,
+			timer->Delta * 1000.0f / nFrames,
+			nHash == nExpected ? "same results" : "RESULTS DIFFER");
+
+		OutputDebugStringA(buf);
+	}
+
+	CollisionKernels::Select(nSelected);
+}
+
+// An obstacle in the middle of every grid space of a window of
+//	fWindowWidth x fWindowHeight, with the packed masks built at the
+//	size of a grid space.
+void CollisionBenchmark::BuildScreen(
+	float fWindowWidth,
+	float fWindowHeight,
+	Grid * grid,
+	CollisionMaskSet * player,
+	CollisionMaskSet * obstacle,
+	std::vector<BaseSpriteData> * obstacles,
+	std::vector<BaseSpriteData *> * sprites)
+{
+	grid->SetWindowWidth(fWindowWidth);
+	grid->SetWindowHeight(fWindowHeight);
+	grid->SetNumColumns(NUM_GRID_COLUMNS);
+	grid->SetNumRows(NUM_GRID_ROWS);
+
+	int width = (int)grid->GetColumnWidth();
+	int height = (int)grid->GetRowHeight();
+
+	player->packed = PackedCollisionMask(&player->mask, width, height);
+	obstacle->packed = PackedCollisionMask(&obstacle->mask, width, height);
+	player->hierarchy = CollisionMaskHierarchy(&player->packed);
+	obstacle->hierarchy = CollisionMaskHierarchy(&obstacle->packed);
+
+	for (int row = 0; row < NUM_GRID_ROWS; row++)
+	{
+		for (int column = 0; column < NUM_GRID_COLUMNS; column++)
+		{
+			obstacles->push_back(BaseSpriteData(
+				column,
+				row,
+				(column + 0.5f) * grid->GetColumnWidth(),
+				(row + 0.5f) * grid->GetRowHeight()));
+		}
+	}
+
+	// Only once obstacles has stopped growing.
+	for (size_t i = 0; i < obstacles->size(); i++)
+	{
+		sprites->push_back(&(*obstacles)[i]);
+	}
+}
+
+// Bounces the bodies off the edges of a fSide x fSide area.
+void CollisionBenchmark::MoveBodies(
+	std::vector<BoundingBox> * boxes,
+	std::vector<float2> * velocities,
+	float fSide)
+{
+	for (size_t i = 0; i < boxes->size(); i++)
+	{
+		BoundingBox & box = (*boxes)[i];
+		float2 & velocity = (*velocities)[i];
+
+		if (box.lowerBound.x + velocity.x < 0.0f || box.upperBound.x + velocity.x > fSide)
+		{
+			velocity.x = -velocity.x;
+		}
+
+		if (box.lowerBound.y + velocity.y < 0.0f || box.upperBound.y + velocity.y > fSide)
+		{
+			velocity.y = -velocity.y;
+		}
+
+		box.lowerBound.x += velocity.x;
+		box.lowerBound.y += velocity.y;
+		box.upperBound.x += velocity.x;
+		box.upperBound.y += velocity.y;
+	}
+}
+
+void CollisionBenchmark::Report(const char * name, float fSeconds, int nTests, int nCollisions)
+{
+	char buf[128];
+	sprintf_s(
+		buf,
+		"%s: %d tests, %d collisions, %.1f ns/test\n",
+		name,
+		nTests,
+		nCollisions,
+		nTests > 0 ? fSeconds * 1.0e9f / nTests : 0.0f);
+
+	OutputDebugStringA(buf);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "pch.h"
+#include "CollisionMaskSet.h"
+#include "BoundingBox.h"
+#include "BaseSpriteData.h"
+#include "Grid.h"
+#include <vector>
+
+// Timings for the collision code, written to the debugger output.
+//	Only run when BENCHMARK_COLLISION is defined in Constants.h.
+class CollisionBenchmark
+{
+public:
+	// Compares the narrow phase paths, with each instruction set the
+	//	CPU supports, by placing the obstacle at every offset where the
+	//	two sprites overlap.
+	static void NarrowPhase(
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		int width,
+		int height);
+
+	// Moves nBodies sprites around for nFrames frames and times the
+	//	dynamic tree against sweep-and-prune on the same motion. The
+	//	area grows with nBodies so the density stays the same.
+	static void BroadPhase(int nBodies, int nFrames);
+
+	// Runs the per-frame collision loop (broad phase, narrow phase,
+	//	contacts, events) over a full screen of obstacles and reports how many
+	//	heap allocations the last nFrames made. Should be 0.
+	static void SteadyState(
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		int nFrames);
+
+	// Times each broad phase with the narrow phase over the same
+	//	screen and walk as SteadyState, called through a
+	//	CollisionPipeline and through a RuntimeCollisionPipeline.
+	//	The candidate counts show how much each strategy lets through.
+	static void Strategies(
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		int nFrames);
+
+	// Moves nBodies sprites of 32 x 32 pixels around for nFrames
+	//	frames, pairing them up in the dynamic tree and testing the
+	//	pairs with ParallelNarrowPhase, with 1 worker and then with
+	//	each count up to one per core. Every run must give the same
+	//	pairs and results as the first.
+	static void Parallel(
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		int nBodies,
+		int nFrames);
+
+	// Tests a circle moving across nCircles circles for nFrames
+	//	frames with the circular zone strategy's arrays, once with each
+	//	instruction set the CPU supports. Every set must find the
+	//	same hits as the scalar one; a set that does not reports
+	//	RESULTS DIFFER.
+	static void Circles(int nCircles, int nFrames);
+
+protected:
+
+private:
+	static void BuildScreen(
+		float fWindowWidth,
+		float fWindowHeight,
+		Grid * grid,
+		CollisionMaskSet * player,
+		CollisionMaskSet * obstacle,
+		std::vector<BaseSpriteData> * obstacles,
+		std::vector<BaseSpriteData *> * sprites);
+
+	static void MoveBodies(
+		std::vector<BoundingBox> * boxes,
+		std::vector<float2> * velocities,
+		float fSide);
+
+	static void Report(const char * name, float fSeconds, int nTests, int nCollisions);
+};
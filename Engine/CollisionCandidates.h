@@ -0,0 +1,10 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "SmallVector.h"
+#include "Constants.h"
+
+// Output of the broad phase and input of the narrow phase. The
+//	3x3 neighbourhood of the player rarely holds more than a few
+//	sprites, so this normally lives entirely inline.
+typedef SmallVector<BaseSpriteData *, COLLISION_CANDIDATES_INLINE> CollisionCandidates;
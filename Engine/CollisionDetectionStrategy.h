@@ -6,6 +6,7 @@
 #include "BaseSpriteData.h"
 #include <list>
 #include "GridSpace.h"
+#include "CollisionCandidates.h"
 
 using namespace std;
 
@@ -21,21 +22,35 @@ using namespace std;
 //	in the direction of the collision.
 //
 //	Not all sprites will block the character.
+//
+//	This is the runtime interface. The strategies themselves derive
+//	from BroadPhaseStrategy, which also lets CollisionPipeline call
+//	them without going through the virtual functions.
 class CollisionDetectionStrategy
 {
 public:
 	CollisionDetectionStrategy(){}
+	virtual ~CollisionDetectionStrategy(){}
 
 	virtual bool Detect(CollisionDetectionInfo * info) = 0;
 
+	// Appends the sprites that may touch the player. playerLocation
+	//	is the centre of the player, in screen pixels.
 	virtual void Detect(
-		list<BaseSpriteData *> * retVal,
+		CollisionCandidates * retVal,
 		float2 playerSize,
 		float2 spriteSize,
 		Player * pPlayer,
 		vector<BaseSpriteData *> * sprites,
 		float fWindowWidth,
-		float fWindowHeight) = 0;
+		float fWindowHeight,
+		float * playerLocation) = 0;
+
+	// The sprites given to Detect were changed in place, say for a
+	//	new screen. Strategies that index them index them again.
+	virtual void Invalidate()
+	{
+	}
 
 protected:
 
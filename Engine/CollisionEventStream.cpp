@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "CollisionEventStream.h"
+#include <algorithm>
+
+CollisionEventStream::CollisionEventStream()
+{
+
+}
+
+void CollisionEventStream::BeginFrame()
+{
+	m_current.clear();
+}
+
+void CollisionEventStream::AddPair(BaseSpriteData * a, BaseSpriteData * b)
+{
+	if (b->nId < a->nId)
+	{
+		std::swap(a, b);
+	}
+
+	Pair pair;
+	pair.nKey = ((unsigned long long)a->nId << 32) | b->nId;
+	pair.a = a;
+	pair.b = b;
+
+	m_current.push_back(pair);
+}
+
+void CollisionEventStream::EndFrame()
+{
+	m_events.clear();
+
+	std::sort(m_current.begin(), m_current.end());
+
+	// A pair can be added more than once, e.g. by the still and the
+	//	moving sprite passes.
+	size_t nUnique = 0;
+
+	for (size_t i = 0; i < m_current.size(); i++)
+	{
+		if (nUnique == 0 || m_current[nUnique - 1].nKey != m_current[i].nKey)
+		{
+			m_current[nUnique++] = m_current[i];
+		}
+	}
+
+	m_current.resize(nUnique);
+
+	// Both lists are sorted, so one merge finds every change.
+	size_t previous = 0;
+	size_t current = 0;
+
+	while (previous < m_previous.size() || current < m_current.size())
+	{
+		if (current == m_current.size() ||
+			(previous < m_previous.size() && m_previous[previous].nKey < m_current[current].nKey))
+		{
+			Publish(COLLISION_EVENT_EXIT, m_previous[previous++]);
+		}
+		else if (previous == m_previous.size() ||
+			m_current[current].nKey < m_previous[previous].nKey)
+		{
+			Publish(COLLISION_EVENT_ENTER, m_current[current++]);
+		}
+		else
+		{
+			Publish(COLLISION_EVENT_STAY, m_current[current++]);
+			previous++;
+		}
+	}
+
+	m_previous.swap(m_current);
+	m_current.clear();
+}
+
+void CollisionEventStream::Clear()
+{
+	m_previous.clear();
+	m_current.clear();
+	m_events.clear();
+}
+
+void CollisionEventStream::Publish(int nType, const Pair & pair)
+{
+	CollisionEvent collisionEvent;
+	collisionEvent.nType = nType;
+	collisionEvent.a = pair.a;
+	collisionEvent.b = pair.b;
+
+	m_events.push_back(collisionEvent);
+}
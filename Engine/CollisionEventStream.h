@@ -0,0 +1,74 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "Constants.h"
+#include <vector>
+
+struct CollisionEvent
+{
+	// COLLISION_EVENT_ENTER, COLLISION_EVENT_STAY or COLLISION_EVENT_EXIT.
+	int nType;
+
+	// a has the lower nId of the two.
+	BaseSpriteData * a;
+	BaseSpriteData * b;
+};
+
+// Turns the pairs that touch each frame into enter, stay and exit
+//	events, by diffing them against the pairs of the frame before,
+//	so that triggers, damage and sounds only react to a change
+//	instead of polling every object every frame.
+//
+//	Events are sorted on the ids of the pair. The buffers are kept
+//	between frames and stop allocating once they have grown.
+class CollisionEventStream
+{
+public:
+	CollisionEventStream();
+
+	// Starts collecting this frame's pairs.
+	void BeginFrame();
+
+	// A pair that touches this frame, in either order. Adding the
+	//	same pair twice is harmless.
+	void AddPair(BaseSpriteData * a, BaseSpriteData * b);
+
+	// Diffs the pairs against the last frame and publishes the events.
+	void EndFrame();
+
+	// Drops the pairs of the last frame without an exit event, for
+	//	when the sprites themselves go away (a new screen).
+	void Clear();
+
+	int GetNumEvents()
+	{
+		return (int)m_events.size();
+	}
+
+	const CollisionEvent & GetEvent(int index)
+	{
+		return m_events[index];
+	}
+
+protected:
+
+private:
+	struct Pair
+	{
+		unsigned long long nKey;
+		BaseSpriteData * a;
+		BaseSpriteData * b;
+
+		bool operator<(const Pair & other) const
+		{
+			return nKey < other.nKey;
+		}
+	};
+
+	void Publish(int nType, const Pair & pair);
+
+	std::vector<Pair> m_previous;
+	std::vector<Pair> m_current;
+
+	std::vector<CollisionEvent> m_events;
+};
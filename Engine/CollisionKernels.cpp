@@ -0,0 +1,512 @@
+#include "pch.h"
+#include "CollisionKernels.h"
+#include "PackedCollisionMask.h"
+#include "Constants.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define COLLISION_KERNELS_X86
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	//
+	// Scalar
+	//
+
+	bool AlphaSpanOverlapScalar(
+		const uint8_t * a,
+		const uint8_t * b,
+		int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (a[i] > 0 && b[i] > 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool PackedSpanOverlapScalar(
+		const uint64_t * a,
+		int aBit,
+		const uint64_t * b,
+		int bBit,
+		int nBits)
+	{
+		for (int bit = 0; bit < nBits; bit += 64)
+		{
+			uint64_t overlap =
+				PackedCollisionMask::ExtractWord(a, aBit + bit) &
+				PackedCollisionMask::ExtractWord(b, bBit + bit);
+
+			// Ignore whatever lies past the end of the span.
+			if (nBits - bit < 64)
+			{
+				overlap &= ((uint64_t)1 << (nBits - bit)) - 1;
+			}
+
+			if (overlap != 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// The circles touch when the squared distance between the centres
+	//	is at most the squared sum of the radii. Every instruction set
+	//	rounds the same steps the same way, so they all agree.
+	int CirclesOverlapScalar(
+		const float * x,
+		const float * y,
+		const float * radius,
+		int count,
+		float centerX,
+		float centerY,
+		float centerRadius,
+		int * hits)
+	{
+		int nHits = 0;
+
+		for (int i = 0; i < count; i++)
+		{
+			float dx = x[i] - centerX;
+			float dy = y[i] - centerY;
+			float reach = radius[i] + centerRadius;
+
+			if (dx * dx + dy * dy <= reach * reach)
+			{
+				hits[nHits++] = i;
+			}
+		}
+
+		return nHits;
+	}
+
+	CollisionKernelTable ScalarKernels =
+	{
+		AlphaSpanOverlapScalar,
+		PackedSpanOverlapScalar,
+		CirclesOverlapScalar,
+		COLLISION_KERNEL_SCALAR,
+		"scalar"
+	};
+
+#ifdef COLLISION_KERNELS_X86
+
+	//
+	// SSE2: 16 alpha texels or 128 mask bits per instruction.
+	//
+
+	bool AlphaSpanOverlapSse2(
+		const uint8_t * a,
+		const uint8_t * b,
+		int count)
+	{
+		__m128i zero = _mm_setzero_si128();
+		int i = 0;
+
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i alphaA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+			__m128i alphaB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+
+			// A lane is empty if either side is transparent.
+			__m128i empty = _mm_or_si128(
+				_mm_cmpeq_epi8(alphaA, zero),
+				_mm_cmpeq_epi8(alphaB, zero));
+
+			if (_mm_movemask_epi8(empty) != 0xFFFF)
+			{
+				return true;
+			}
+		}
+
+		return AlphaSpanOverlapScalar(a + i, b + i, count - i);
+	}
+
+	// Funnel-shifts two words at a time. A shift of 64 yields zero
+	//	in SSE2, so an aligned offset needs no special case.
+	inline __m128i ExtractWordsSse2(const uint64_t * words, __m128i right, __m128i left)
+	{
+		__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words));
+		__m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + 1));
+
+		return _mm_or_si128(_mm_srl_epi64(low, right), _mm_sll_epi64(high, left));
+	}
+
+	bool PackedSpanOverlapSse2(
+		const uint64_t * a,
+		int aBit,
+		const uint64_t * b,
+		int bBit,
+		int nBits)
+	{
+		const uint64_t * aWords = a + (aBit >> 6);
+		const uint64_t * bWords = b + (bBit >> 6);
+
+		__m128i aRight = _mm_cvtsi32_si128(aBit & 63);
+		__m128i aLeft = _mm_cvtsi32_si128(64 - (aBit & 63));
+		__m128i bRight = _mm_cvtsi32_si128(bBit & 63);
+		__m128i bLeft = _mm_cvtsi32_si128(64 - (bBit & 63));
+		__m128i zero = _mm_setzero_si128();
+
+		int bit = 0;
+
+		for (; bit + 128 <= nBits; bit += 128, aWords += 2, bWords += 2)
+		{
+			__m128i overlap = _mm_and_si128(
+				ExtractWordsSse2(aWords, aRight, aLeft),
+				ExtractWordsSse2(bWords, bRight, bLeft));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(overlap, zero)) != 0xFFFF)
+			{
+				return true;
+			}
+		}
+
+		return PackedSpanOverlapScalar(a, aBit + bit, b, bBit + bit, nBits - bit);
+	}
+
+	// 4 circles at a time. Each lane's index is written whether it
+	//	hit or not, and the count only moves on for a hit, so there
+	//	is no branch per circle; nHits never passes i, so every write
+	//	stays inside hits.
+	int CirclesOverlapSse2(
+		const float * x,
+		const float * y,
+		const float * radius,
+		int count,
+		float centerX,
+		float centerY,
+		float centerRadius,
+		int * hits)
+	{
+		__m128 cx = _mm_set1_ps(centerX);
+		__m128 cy = _mm_set1_ps(centerY);
+		__m128 cr = _mm_set1_ps(centerRadius);
+
+		int nHits = 0;
+		int i = 0;
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), cx);
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), cy);
+			__m128 reach = _mm_add_ps(_mm_loadu_ps(radius + i), cr);
+
+			__m128 distanceSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+			int mask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, _mm_mul_ps(reach, reach)));
+
+			hits[nHits] = i;
+			nHits += mask & 1;
+			hits[nHits] = i + 1;
+			nHits += (mask >> 1) & 1;
+			hits[nHits] = i + 2;
+			nHits += (mask >> 2) & 1;
+			hits[nHits] = i + 3;
+			nHits += (mask >> 3) & 1;
+		}
+
+		for (; i < count; i++)
+		{
+			float dx = x[i] - centerX;
+			float dy = y[i] - centerY;
+			float reach = radius[i] + centerRadius;
+
+			if (dx * dx + dy * dy <= reach * reach)
+			{
+				hits[nHits++] = i;
+			}
+		}
+
+		return nHits;
+	}
+
+	CollisionKernelTable Sse2Kernels =
+	{
+		AlphaSpanOverlapSse2,
+		PackedSpanOverlapSse2,
+		CirclesOverlapSse2,
+		COLLISION_KERNEL_SSE2,
+		"sse2"
+	};
+
+	//
+	// AVX2: 32 alpha texels or 256 mask bits per instruction.
+	//
+
+	bool AlphaSpanOverlapAvx2(
+		const uint8_t * a,
+		const uint8_t * b,
+		int count)
+	{
+		__m256i zero = _mm256_setzero_si256();
+		int i = 0;
+
+		for (; i + 32 <= count; i += 32)
+		{
+			__m256i alphaA = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+			__m256i alphaB = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+
+			__m256i empty = _mm256_or_si256(
+				_mm256_cmpeq_epi8(alphaA, zero),
+				_mm256_cmpeq_epi8(alphaB, zero));
+
+			if (_mm256_movemask_epi8(empty) != -1)
+			{
+				_mm256_zeroupper();
+				return true;
+			}
+		}
+
+		_mm256_zeroupper();
+
+		return AlphaSpanOverlapSse2(a + i, b + i, count - i);
+	}
+
+	inline __m256i ExtractWordsAvx2(const uint64_t * words, __m128i right, __m128i left)
+	{
+		__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words));
+		__m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + 1));
+
+		return _mm256_or_si256(_mm256_srl_epi64(low, right), _mm256_sll_epi64(high, left));
+	}
+
+	bool PackedSpanOverlapAvx2(
+		const uint64_t * a,
+		int aBit,
+		const uint64_t * b,
+		int bBit,
+		int nBits)
+	{
+		const uint64_t * aWords = a + (aBit >> 6);
+		const uint64_t * bWords = b + (bBit >> 6);
+
+		__m128i aRight = _mm_cvtsi32_si128(aBit & 63);
+		__m128i aLeft = _mm_cvtsi32_si128(64 - (aBit & 63));
+		__m128i bRight = _mm_cvtsi32_si128(bBit & 63);
+		__m128i bLeft = _mm_cvtsi32_si128(64 - (bBit & 63));
+
+		int bit = 0;
+
+		for (; bit + 256 <= nBits; bit += 256, aWords += 4, bWords += 4)
+		{
+			__m256i overlap = _mm256_and_si256(
+				ExtractWordsAvx2(aWords, aRight, aLeft),
+				ExtractWordsAvx2(bWords, bRight, bLeft));
+
+			if (!_mm256_testz_si256(overlap, overlap))
+			{
+				_mm256_zeroupper();
+				return true;
+			}
+		}
+
+		_mm256_zeroupper();
+
+		return PackedSpanOverlapSse2(a, aBit + bit, b, bBit + bit, nBits - bit);
+	}
+
+	// For each 8 bit movemask, the lanes that are set, packed 4 bits
+	//	a lane from the bottom, and how many there are.
+	struct CompressTable
+	{
+		uint32_t lanes[256];
+		uint8_t counts[256];
+
+		CompressTable()
+		{
+			for (int mask = 0; mask < 256; mask++)
+			{
+				int n = 0;
+				lanes[mask] = 0;
+
+				for (int lane = 0; lane < 8; lane++)
+				{
+					if (mask & (1 << lane))
+					{
+						lanes[mask] |= (uint32_t)lane << (4 * n++);
+					}
+				}
+
+				counts[mask] = (uint8_t)n;
+			}
+		}
+	};
+
+	CompressTable Compress;
+
+	// 8 circles at a time. The indices of the hits are moved to the
+	//	front of the vector with one permute and stored whole; the
+	//	lanes past the hits are overwritten by the next store.
+	int CirclesOverlapAvx2(
+		const float * x,
+		const float * y,
+		const float * radius,
+		int count,
+		float centerX,
+		float centerY,
+		float centerRadius,
+		int * hits)
+	{
+		__m256 cx = _mm256_set1_ps(centerX);
+		__m256 cy = _mm256_set1_ps(centerY);
+		__m256 cr = _mm256_set1_ps(centerRadius);
+
+		__m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+		__m256i nibble = _mm256_set1_epi32(15);
+		__m256i indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		__m256i step = _mm256_set1_epi32(8);
+
+		int nHits = 0;
+		int i = 0;
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), cx);
+			__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), cy);
+			__m256 reach = _mm256_add_ps(_mm256_loadu_ps(radius + i), cr);
+
+			__m256 distanceSquared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+			int mask = _mm256_movemask_ps(_mm256_cmp_ps(distanceSquared, _mm256_mul_ps(reach, reach), _CMP_LE_OQ));
+
+			if (mask != 0)
+			{
+				__m256i permute = _mm256_and_si256(
+					_mm256_srlv_epi32(_mm256_set1_epi32((int)Compress.lanes[mask]), shifts),
+					nibble);
+
+				_mm256_storeu_si256(
+					reinterpret_cast<__m256i *>(hits + nHits),
+					_mm256_permutevar8x32_epi32(indices, permute));
+
+				nHits += Compress.counts[mask];
+			}
+
+			indices = _mm256_add_epi32(indices, step);
+		}
+
+		_mm256_zeroupper();
+
+		int nTail = CirclesOverlapSse2(
+			x + i,
+			y + i,
+			radius + i,
+			count - i,
+			centerX,
+			centerY,
+			centerRadius,
+			hits + nHits);
+
+		// Those are counted from i.
+		for (int j = nHits; j < nHits + nTail; j++)
+		{
+			hits[j] += i;
+		}
+
+		return nHits + nTail;
+	}
+
+	CollisionKernelTable Avx2Kernels =
+	{
+		AlphaSpanOverlapAvx2,
+		PackedSpanOverlapAvx2,
+		CirclesOverlapAvx2,
+		COLLISION_KERNEL_AVX2,
+		"avx2"
+	};
+
+#endif // COLLISION_KERNELS_X86
+}
+
+CollisionKernelTable * CollisionKernels::s_pKernels = &ScalarKernels;
+
+void CollisionKernels::Initialize()
+{
+	if (!Select(COLLISION_KERNEL_AVX2))
+	{
+		if (!Select(COLLISION_KERNEL_SSE2))
+		{
+			Select(COLLISION_KERNEL_SCALAR);
+		}
+	}
+}
+
+bool CollisionKernels::IsSupported(int nInstructionSet)
+{
+	if (nInstructionSet == COLLISION_KERNEL_SCALAR)
+	{
+		return true;
+	}
+
+#ifdef COLLISION_KERNELS_X86
+	int info[4];
+
+	__cpuid(info, 0);
+	int nHighestFunction = info[0];
+
+	__cpuid(info, 1);
+	bool bSse2 = (info[3] & (1 << 26)) != 0;
+	bool bOsXSave = (info[2] & (1 << 27)) != 0;
+	bool bAvx = (info[2] & (1 << 28)) != 0;
+
+	if (nInstructionSet == COLLISION_KERNEL_SSE2)
+	{
+		return bSse2;
+	}
+
+	if (nInstructionSet == COLLISION_KERNEL_AVX2)
+	{
+		if (!bOsXSave || !bAvx || nHighestFunction < 7)
+		{
+			return false;
+		}
+
+		// The OS has to save the YMM registers on a context switch.
+		if ((_xgetbv(0) & 6) != 6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+
+		return (info[1] & (1 << 5)) != 0;
+	}
+#endif // COLLISION_KERNELS_X86
+
+	return false;
+}
+
+bool CollisionKernels::Select(int nInstructionSet)
+{
+	if (!IsSupported(nInstructionSet))
+	{
+		return false;
+	}
+
+	switch (nInstructionSet)
+	{
+#ifdef COLLISION_KERNELS_X86
+	case COLLISION_KERNEL_AVX2:
+		s_pKernels = &Avx2Kernels;
+		break;
+
+	case COLLISION_KERNEL_SSE2:
+		s_pKernels = &Sse2Kernels;
+		break;
+#endif // COLLISION_KERNELS_X86
+
+	default:
+		s_pKernels = &ScalarKernels;
+		break;
+	}
+
+	return true;
+}
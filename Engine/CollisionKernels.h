@@ -0,0 +1,63 @@
+#pragma once
+#include "pch.h"
+
+// The innermost loops of the collision code.
+//	One table exists per instruction set; the best one the CPU
+//	supports is selected once by CollisionKernels::Initialize.
+struct CollisionKernelTable
+{
+	// True if a[i] > 0 and b[i] > 0 for any i in [0, count).
+	bool (*AlphaSpanOverlap)(
+		const uint8_t * a,
+		const uint8_t * b,
+		int count);
+
+	// True if any of the nBits bits starting at aBit in a and
+	//	at bBit in b are set in both. Rows must be padded by one
+	//	word, as PackedCollisionMask rows are.
+	bool (*PackedSpanOverlap)(
+		const uint64_t * a,
+		int aBit,
+		const uint64_t * b,
+		int bBit,
+		int nBits);
+
+	// Writes the index of every circle i in [0, count) that overlaps
+	//	the circle at (centerX, centerY) of centerRadius, in order,
+	//	and returns how many were written. hits must hold count ints.
+	int (*CirclesOverlap)(
+		const float * x,
+		const float * y,
+		const float * radius,
+		int count,
+		float centerX,
+		float centerY,
+		float centerRadius,
+		int * hits);
+
+	int nInstructionSet;
+	const char * name;
+};
+
+class CollisionKernels
+{
+public:
+	// Picks the widest instruction set supported by the CPU and the OS.
+	static void Initialize();
+
+	// COLLISION_KERNEL_SCALAR, COLLISION_KERNEL_SSE2 or COLLISION_KERNEL_AVX2.
+	//	Returns false, and leaves the selection alone, if it is not supported.
+	static bool Select(int nInstructionSet);
+
+	static bool IsSupported(int nInstructionSet);
+
+	static CollisionKernelTable * Get()
+	{
+		return s_pKernels;
+	}
+
+protected:
+
+private:
+	static CollisionKernelTable * s_pKernels;
+};
@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "CollisionLayers.h"
+
+unsigned int CollisionLayers::s_matrix[NUM_COLLISION_LAYERS];
+
+namespace
+{
+	// Every layer starts out interacting with nothing. Reset fills
+	//	in the pairs the game uses.
+	struct DefaultLayers
+	{
+		DefaultLayers()
+		{
+			CollisionLayers::Reset();
+		}
+	} s_defaultLayers;
+}
+
+void CollisionLayers::SetInteraction(int layerA, int layerB, bool bInteracts)
+{
+	if (bInteracts)
+	{
+		s_matrix[layerA] |= GetBit(layerB);
+		s_matrix[layerB] |= GetBit(layerA);
+	}
+	else
+	{
+		s_matrix[layerA] &= ~GetBit(layerB);
+		s_matrix[layerB] &= ~GetBit(layerA);
+	}
+}
+
+void CollisionLayers::Reset()
+{
+	for (int layer = 0; layer < NUM_COLLISION_LAYERS; layer++)
+	{
+		s_matrix[layer] = 0;
+	}
+
+	// Decoration interacts with nothing.
+	SetInteraction(COLLISION_LAYER_PLAYER, COLLISION_LAYER_OBSTACLE, true);
+	SetInteraction(COLLISION_LAYER_PLAYER, COLLISION_LAYER_WATER, true);
+	SetInteraction(COLLISION_LAYER_PLAYER, COLLISION_LAYER_PICKUP, true);
+	SetInteraction(COLLISION_LAYER_PLAYER, COLLISION_LAYER_TRIGGER, true);
+	SetInteraction(COLLISION_LAYER_PLAYER, COLLISION_LAYER_ENEMY, true);
+
+	SetInteraction(COLLISION_LAYER_ENEMY, COLLISION_LAYER_OBSTACLE, true);
+	SetInteraction(COLLISION_LAYER_ENEMY, COLLISION_LAYER_WATER, true);
+	SetInteraction(COLLISION_LAYER_ENEMY, COLLISION_LAYER_ENEMY, true);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "Constants.h"
+
+// Which collision layers are tested against each other. Checked
+//	before any distance or pixel work, so sprites on layers that
+//	cannot interact (grass, other decoration) cost nothing.
+class CollisionLayers
+{
+public:
+	static unsigned int GetBit(int layer)
+	{
+		return 1u << layer;
+	}
+
+	// The layers that layer is tested against, as bits.
+	static unsigned int GetInteractionMask(int layer)
+	{
+		return s_matrix[layer];
+	}
+
+	static bool Interacts(int layerA, int layerB)
+	{
+		return (s_matrix[layerA] & GetBit(layerB)) != 0;
+	}
+
+	// Sets both directions, so the matrix stays symmetric.
+	static void SetInteraction(int layerA, int layerB, bool bInteracts);
+
+	// Back to the matrix the game starts with.
+	static void Reset();
+
+	// Whether something on layer with mask should be tested against
+	//	sprite: both collidable, the layers interact, and each side's
+	//	mask lets the other through.
+	static bool ShouldTest(int layer, unsigned int mask, BaseSpriteData * sprite)
+	{
+		return
+			sprite->bCollidable &&
+			Interacts(layer, sprite->nLayer) &&
+			(mask & GetBit(sprite->nLayer)) != 0 &&
+			(sprite->nCollisionMask & GetBit(layer)) != 0;
+	}
+
+protected:
+
+private:
+	static unsigned int s_matrix[NUM_COLLISION_LAYERS];
+};
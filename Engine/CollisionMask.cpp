@@ -0,0 +1,83 @@
+#include "pch.h"
+#include "CollisionMask.h"
+#include "CollisionKernels.h"
+#include "Constants.h"
+
+CollisionMask::CollisionMask()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+CollisionMask::CollisionMask(
+	int width,
+	int height,
+	const uint8_t * pixels,
+	int rowPitch)
+{
+	m_nWidth = width;
+	m_nHeight = height;
+
+	m_alpha.resize(width * height);
+
+	for (int row = 0; row < height; row++)
+	{
+		const uint32_t * source = reinterpret_cast<const uint32_t *>(pixels + row * rowPitch);
+
+		for (int column = 0; column < width; column++)
+		{
+			m_alpha[row * width + column] =
+				(uint8_t)((source[column] & 0xff000000) >> 24);
+		}
+	}
+}
+
+CollisionMask CollisionMask::Resample(int width, int height)
+{
+	CollisionMask retVal;
+
+	retVal.m_nWidth = width;
+	retVal.m_nHeight = height;
+	retVal.m_alpha.resize(width * height);
+
+	for (int row = 0; row < height; row++)
+	{
+		// Same mapping as the per-pixel path in NarrowCollisionStrategy.
+		int rawRow = (int)((float)row / (float)height * m_nHeight);
+
+		for (int column = 0; column < width; column++)
+		{
+			int rawColumn = (int)((float)column / (float)width * m_nWidth);
+
+			retVal.m_alpha[row * width + column] = GetAlpha(rawColumn, rawRow);
+		}
+	}
+
+	return retVal;
+}
+
+bool CollisionMask::Overlap(
+	CollisionMask * a,
+	int * aTopLeft,
+	CollisionMask * b,
+	int * bTopLeft,
+	int * intersectRect)
+{
+	int left = intersectRect[INTERSECTION_LEFT];
+	int width = intersectRect[INTERSECTION_RIGHT] - left;
+
+	CollisionKernelTable * kernels = CollisionKernels::Get();
+
+	for (int row = intersectRect[INTERSECTION_TOP]; row < intersectRect[INTERSECTION_BOTTOM]; row++)
+	{
+		if (kernels->AlphaSpanOverlap(
+			a->GetRow(row - aTopLeft[VERTICAL_AXIS]) + (left - aTopLeft[HORIZONTAL_AXIS]),
+			b->GetRow(row - bTopLeft[VERTICAL_AXIS]) + (left - bTopLeft[HORIZONTAL_AXIS]),
+			width))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
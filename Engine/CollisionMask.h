@@ -0,0 +1,68 @@
+#pragma once
+#include "pch.h"
+#include <vector>
+
+// CPU-side copy of the alpha channel of a sprite texture.
+//	It is extracted once, when the texture is registered, so that
+//	the narrow phase never has to read pixels back from the GPU.
+//	Nothing in here depends on a Direct3D device.
+class CollisionMask
+{
+public:
+	CollisionMask();
+
+	// pixels points to 32-bit texels with the alpha channel in
+	//	the most significant byte (0xff000000).
+	CollisionMask(
+		int width,
+		int height,
+		const uint8_t * pixels,
+		int rowPitch);
+
+	int GetWidth()
+	{
+		return m_nWidth;
+	}
+
+	int GetHeight()
+	{
+		return m_nHeight;
+	}
+
+	uint8_t GetAlpha(int column, int row)
+	{
+		return m_alpha[row * m_nWidth + column];
+	}
+
+	bool IsOpaque(int column, int row)
+	{
+		return GetAlpha(column, row) > 0;
+	}
+
+	const uint8_t * GetRow(int row)
+	{
+		return &m_alpha[row * m_nWidth];
+	}
+
+	// Nearest-neighbour copy at width x height.
+	CollisionMask Resample(int width, int height);
+
+	// Tests whether any opaque texel of a overlaps an opaque texel of b.
+	//	Both masks must be at the same scale. The top-left corners and
+	//	the intersection rectangle (left, right, top, bottom) are in
+	//	screen pixels.
+	static bool Overlap(
+		CollisionMask * a,
+		int * aTopLeft,
+		CollisionMask * b,
+		int * bTopLeft,
+		int * intersectRect);
+
+protected:
+
+private:
+	int m_nWidth;
+	int m_nHeight;
+
+	std::vector<uint8_t> m_alpha;
+};
@@ -0,0 +1,274 @@
+#include "pch.h"
+#include "CollisionMaskCache.h"
+#include "DirectXSample.h"
+#include <ppltasks.h>
+
+using namespace Microsoft::WRL;
+
+// @see http://gamedev.stackexchange.com/questions/27690/reading-from-a-staging-2d-texture-array-in-directx10
+CollisionMaskCache::CollisionMaskCache()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_fPolygonTolerance = POLYGON_TOLERANCE;
+	m_nGeneration = 0;
+	m_nAppliedGeneration = 0;
+	m_nVersion = 0;
+
+	m_pRebuild = std::make_shared<Rebuild>();
+	m_pRebuild->nGeneration = 0;
+	m_pRebuild->bReady = false;
+}
+
+CollisionMaskCache::~CollisionMaskCache()
+{
+
+}
+
+void CollisionMaskCache::AddTexture(
+	ID3D11Device2 * device,
+	ID3D11Texture2D * texture)
+{
+	D3D11_TEXTURE2D_DESC description;
+	texture->GetDesc(&description);
+
+	description.BindFlags = 0;
+	description.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	description.Usage = D3D11_USAGE_STAGING;
+	description.MiscFlags = 0;
+
+	ComPtr<ID3D11Texture2D> stagingTexture;
+
+	DX::ThrowIfFailed(
+		device->CreateTexture2D(&description, NULL, &stagingTexture)
+		);
+
+	ComPtr<ID3D11DeviceContext> context;
+	device->GetImmediateContext(&context);
+
+	context->CopyResource(stagingTexture.Get(), texture);
+
+	D3D11_MAPPED_SUBRESOURCE resource;
+	UINT subresource = D3D11CalcSubresource(0, 0, 0);
+
+	DX::ThrowIfFailed(
+		context->Map(stagingTexture.Get(), subresource, D3D11_MAP_READ, 0, &resource)
+		);
+
+	CollisionMask mask(
+		description.Width,
+		description.Height,
+		reinterpret_cast<const uint8_t *>(resource.pData),
+		resource.RowPitch);
+
+	context->Unmap(stagingTexture.Get(), subresource);
+
+	AddMask(texture, mask);
+}
+
+void CollisionMaskCache::AddMask(
+	ID3D11Texture2D * texture,
+	const CollisionMask & mask)
+{
+	CollisionMaskSet * maskSet = &m_masks[texture];
+
+	maskSet->mask = mask;
+	maskSet->shape = CollisionShape::FromMask(&maskSet->mask, m_fPolygonTolerance);
+	maskSet->field = DistanceField::FromMask(&maskSet->mask, DISTANCE_FIELD_RESOLUTION);
+	BuildResolutionDependentMasks(maskSet, m_nWidth, m_nHeight);
+}
+
+void CollisionMaskCache::RemoveTexture(ID3D11Texture2D * texture)
+{
+	m_masks.erase(texture);
+}
+
+void CollisionMaskCache::SetPolygonTolerance(float fTolerance)
+{
+	m_fPolygonTolerance = fTolerance;
+	m_nVersion++;
+
+	std::map<ID3D11Texture2D *, CollisionMaskSet>::iterator iterator;
+
+	for (iterator = m_masks.begin(); iterator != m_masks.end(); iterator++)
+	{
+		CollisionMaskSet * maskSet = &iterator->second;
+
+		maskSet->shape = CollisionShape::FromMask(&maskSet->mask, fTolerance);
+		maskSet->scaledShape = maskSet->shape.Scale(m_nWidth, m_nHeight);
+	}
+
+	// A rebuild under way was handed the old outlines, and would
+	//	swap them back in; start it again with the new ones.
+	if (IsRebuildPending())
+	{
+		StartRebuild();
+	}
+}
+
+void CollisionMaskCache::Clear()
+{
+	m_masks.clear();
+	m_nVersion++;
+}
+
+CollisionMask * CollisionMaskCache::GetMask(ID3D11Texture2D * texture)
+{
+	CollisionMaskSet * maskSet = GetMaskSet(texture);
+
+	if (maskSet == NULL)
+	{
+		return NULL;
+	}
+
+	return &maskSet->mask;
+}
+
+CollisionMaskSet * CollisionMaskCache::GetMaskSet(ID3D11Texture2D * texture)
+{
+	std::map<ID3D11Texture2D *, CollisionMaskSet>::iterator iterator =
+		m_masks.find(texture);
+
+	if (iterator == m_masks.end())
+	{
+		return NULL;
+	}
+
+	return &iterator->second;
+}
+
+void CollisionMaskCache::SetResolution(int width, int height)
+{
+	if (width == m_nWidth && height == m_nHeight)
+	{
+		return;
+	}
+
+	m_nWidth = width;
+	m_nHeight = height;
+	m_nGeneration++;
+	m_nAppliedGeneration = m_nGeneration;
+	m_nVersion++;
+
+	std::map<ID3D11Texture2D *, CollisionMaskSet>::iterator iterator;
+
+	for (iterator = m_masks.begin(); iterator != m_masks.end(); iterator++)
+	{
+		BuildResolutionDependentMasks(&iterator->second, width, height);
+	}
+}
+
+void CollisionMaskCache::RequestResolution(int width, int height)
+{
+	if (width == m_nWidth && height == m_nHeight)
+	{
+		return;
+	}
+
+	m_nWidth = width;
+	m_nHeight = height;
+
+	StartRebuild();
+}
+
+void CollisionMaskCache::StartRebuild()
+{
+	int width = m_nWidth;
+	int height = m_nHeight;
+
+	m_nGeneration++;
+
+	// The worker gets its own copy of the raw masks, so textures can
+	//	still be added and removed while it runs.
+	std::shared_ptr<std::map<ID3D11Texture2D *, CollisionMaskSet>> masks =
+		std::make_shared<std::map<ID3D11Texture2D *, CollisionMaskSet>>();
+
+	std::map<ID3D11Texture2D *, CollisionMaskSet>::iterator iterator;
+
+	for (iterator = m_masks.begin(); iterator != m_masks.end(); iterator++)
+	{
+		(*masks)[iterator->first].mask = iterator->second.mask;
+		(*masks)[iterator->first].shape = iterator->second.shape;
+	}
+
+	std::shared_ptr<Rebuild> rebuild = m_pRebuild;
+	int nGeneration = m_nGeneration;
+
+	concurrency::create_task([rebuild, masks, nGeneration, width, height]()
+	{
+		std::map<ID3D11Texture2D *, CollisionMaskSet>::iterator iterator;
+
+		for (iterator = masks->begin(); iterator != masks->end(); iterator++)
+		{
+			BuildResolutionDependentMasks(&iterator->second, width, height);
+		}
+
+		std::lock_guard<std::mutex> guard(rebuild->lock);
+
+		// A later request may have finished first.
+		if (nGeneration > rebuild->nGeneration)
+		{
+			rebuild->nGeneration = nGeneration;
+			rebuild->masks.swap(*masks);
+			rebuild->bReady = true;
+		}
+	});
+}
+
+void CollisionMaskCache::Update()
+{
+	if (!IsRebuildPending())
+	{
+		return;
+	}
+
+	// Never stall the frame on the worker; try again next frame.
+	std::unique_lock<std::mutex> guard(m_pRebuild->lock, std::try_to_lock);
+
+	if (!guard.owns_lock() ||
+		!m_pRebuild->bReady ||
+		m_pRebuild->nGeneration != m_nGeneration)
+	{
+		return;
+	}
+
+	std::map<ID3D11Texture2D *, CollisionMaskSet>::iterator iterator;
+
+	for (iterator = m_pRebuild->masks.begin(); iterator != m_pRebuild->masks.end(); iterator++)
+	{
+		// Skip textures that were removed while the worker ran.
+		CollisionMaskSet * maskSet = GetMaskSet(iterator->first);
+
+		if (maskSet == NULL)
+		{
+			continue;
+		}
+
+		std::swap(maskSet->scaled, iterator->second.scaled);
+		std::swap(maskSet->packed, iterator->second.packed);
+		std::swap(maskSet->hierarchy, iterator->second.hierarchy);
+		std::swap(maskSet->scaledShape, iterator->second.scaledShape);
+	}
+
+	m_pRebuild->masks.clear();
+	m_pRebuild->bReady = false;
+
+	m_nAppliedGeneration = m_nGeneration;
+	m_nVersion++;
+}
+
+void CollisionMaskCache::BuildResolutionDependentMasks(
+	CollisionMaskSet * maskSet,
+	int width,
+	int height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	maskSet->scaled = maskSet->mask.Resample(width, height);
+	maskSet->packed = PackedCollisionMask(&maskSet->mask, width, height);
+	maskSet->hierarchy = CollisionMaskHierarchy(&maskSet->packed);
+	maskSet->scaledShape = maskSet->shape.Scale(width, height);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "pch.h"
+#include "CollisionMaskSet.h"
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Collision masks keyed by texture, in the same way that
+//	SpriteBatch keys its shader resource views.
+//	Textures are read back from the GPU exactly once, when they are added.
+class CollisionMaskCache
+{
+public:
+	CollisionMaskCache();
+	~CollisionMaskCache();
+
+	// Copies the texture into a staging texture and extracts its alpha.
+	void AddTexture(
+		ID3D11Device2 * device,
+		ID3D11Texture2D * texture);
+
+	// Registers a mask that was built without a device.
+	void AddMask(
+		ID3D11Texture2D * texture,
+		const CollisionMask & mask);
+
+	void RemoveTexture(ID3D11Texture2D * texture);
+
+	// How far, in texels, the polygon outlines may stray from the
+	//	alpha. Retraces the outlines of every mask already added, so
+	//	the version goes up.
+	void SetPolygonTolerance(float fTolerance);
+	void Clear();
+
+	// Returns NULL if the texture was never added.
+	CollisionMask * GetMask(ID3D11Texture2D * texture);
+	CollisionMaskSet * GetMaskSet(ID3D11Texture2D * texture);
+
+	// Rebuilds the resolution-dependent masks right away if the
+	//	rendered sprite size has changed since the last call.
+	void SetResolution(int width, int height);
+
+	// Starts rebuilding the resolution-dependent masks on a worker.
+	//	Until Update picks the results up, the old masks no longer
+	//	match the rendered size and the narrow phase falls back to
+	//	the raw masks, so a resize never waits for the rebuild.
+	void RequestResolution(int width, int height);
+
+	// Swaps in the masks from a finished rebuild. Call once per frame,
+	//	from the thread that runs the collision detection.
+	void Update();
+
+	// Goes up every time the masks in use are rebuilt.
+	int GetAppliedGeneration()
+	{
+		return m_nAppliedGeneration;
+	}
+
+	bool IsRebuildPending()
+	{
+		return m_nGeneration != m_nAppliedGeneration;
+	}
+
+	// Goes up every time the masks in use change, rebuilt or
+	//	retraced, so that results kept from them can be dropped.
+	int GetVersion()
+	{
+		return m_nVersion;
+	}
+
+protected:
+
+private:
+	// Handed to the worker. Shared so that it outlives the cache
+	//	if the worker is still running when the cache is deleted.
+	struct Rebuild
+	{
+		std::mutex lock;
+		int nGeneration;
+		bool bReady;
+		std::map<ID3D11Texture2D *, CollisionMaskSet> masks;
+	};
+
+	// Rebuilds the resolution-dependent masks at the current size on
+	//	a worker. Any rebuild already running is thrown away.
+	void StartRebuild();
+
+	static void BuildResolutionDependentMasks(
+		CollisionMaskSet * maskSet,
+		int width,
+		int height);
+
+	std::map<ID3D11Texture2D *, CollisionMaskSet> m_masks;
+
+	int m_nWidth;
+	int m_nHeight;
+
+	float m_fPolygonTolerance;
+
+	// Bumped on every change of resolution; results of an older
+	//	generation are thrown away.
+	int m_nGeneration;
+	int m_nAppliedGeneration;
+
+	int m_nVersion;
+
+	std::shared_ptr<Rebuild> m_pRebuild;
+};
@@ -0,0 +1,363 @@
+#include "pch.h"
+#include "CollisionMaskHierarchy.h"
+#include "CollisionKernels.h"
+
+CollisionMaskHierarchy::CollisionMaskHierarchy()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+CollisionMaskHierarchy::CollisionMaskHierarchy(PackedCollisionMask * mask)
+{
+	m_nWidth = mask->GetWidth();
+	m_nHeight = mask->GetHeight();
+
+	if (m_nWidth <= 0 || m_nHeight <= 0)
+	{
+		return;
+	}
+
+	// Level 0 straight from the bits.
+	Level finest;
+	finest.nColumns = (m_nWidth + COVERAGE_BLOCK_SIZE - 1) / COVERAGE_BLOCK_SIZE;
+	finest.nRows = (m_nHeight + COVERAGE_BLOCK_SIZE - 1) / COVERAGE_BLOCK_SIZE;
+	finest.flags.resize(finest.nColumns * finest.nRows);
+
+	for (int blockRow = 0; blockRow < finest.nRows; blockRow++)
+	{
+		int top = blockRow * COVERAGE_BLOCK_SIZE;
+		int bottom = top + COVERAGE_BLOCK_SIZE < m_nHeight ? top + COVERAGE_BLOCK_SIZE : m_nHeight;
+
+		for (int blockColumn = 0; blockColumn < finest.nColumns; blockColumn++)
+		{
+			int left = blockColumn * COVERAGE_BLOCK_SIZE;
+			int width = left + COVERAGE_BLOCK_SIZE < m_nWidth ? COVERAGE_BLOCK_SIZE : m_nWidth - left;
+			uint64_t full = ((uint64_t)1 << width) - 1;
+
+			bool bAny = false;
+			bool bAll = true;
+
+			for (int row = top; row < bottom; row++)
+			{
+				uint64_t bits = PackedCollisionMask::ExtractWord(mask->GetRow(row), left) & full;
+
+				bAny = bAny || bits != 0;
+				bAll = bAll && bits == full;
+			}
+
+			finest.flags[blockRow * finest.nColumns + blockColumn] =
+				(bAny ? COVERAGE_ANY : 0) | (bAll ? COVERAGE_ALL : 0);
+		}
+	}
+
+	m_levels.push_back(finest);
+
+	// Each coarser block combines up to 2 x 2 blocks of the level below.
+	while (m_levels.back().nColumns > 1 || m_levels.back().nRows > 1)
+	{
+		Level & below = m_levels.back();
+
+		Level level;
+		level.nColumns = (below.nColumns + 1) / 2;
+		level.nRows = (below.nRows + 1) / 2;
+		level.flags.resize(level.nColumns * level.nRows);
+
+		for (int row = 0; row < level.nRows; row++)
+		{
+			for (int column = 0; column < level.nColumns; column++)
+			{
+				int any = 0;
+				int all = COVERAGE_ALL;
+
+				for (int childRow = row * 2; childRow < row * 2 + 2 && childRow < below.nRows; childRow++)
+				{
+					for (int childColumn = column * 2; childColumn < column * 2 + 2 && childColumn < below.nColumns; childColumn++)
+					{
+						uint8_t flags = below.flags[childRow * below.nColumns + childColumn];
+
+						any |= flags & COVERAGE_ANY;
+						all &= flags;
+					}
+				}
+
+				level.flags[row * level.nColumns + column] = (uint8_t)(any | all);
+			}
+		}
+
+		m_levels.push_back(level);
+	}
+}
+
+int CollisionMaskHierarchy::Classify(int left, int top, int right, int bottom, int wanted)
+{
+	int rect[4];
+	rect[INTERSECTION_LEFT] = left > 0 ? left : 0;
+	rect[INTERSECTION_RIGHT] = right < m_nWidth ? right : m_nWidth;
+	rect[INTERSECTION_TOP] = top > 0 ? top : 0;
+	rect[INTERSECTION_BOTTOM] = bottom < m_nHeight ? bottom : m_nHeight;
+
+	if (m_levels.empty() ||
+		rect[INTERSECTION_LEFT] >= rect[INTERSECTION_RIGHT] ||
+		rect[INTERSECTION_TOP] >= rect[INTERSECTION_BOTTOM])
+	{
+		return COVERAGE_NONE;
+	}
+
+	// Assume all and none until a block says otherwise.
+	int retVal = COVERAGE_ALL | COVERAGE_NONE;
+
+	ClassifyBlock((int)m_levels.size() - 1, 0, 0, rect, wanted, &retVal);
+
+	return retVal;
+}
+
+void CollisionMaskHierarchy::ClassifyBlock(
+	int level,
+	int column,
+	int row,
+	int * rect,
+	int wanted,
+	int * retVal)
+{
+	int size = GetBlockSize(level);
+
+	int left = column * size;
+	int top = row * size;
+	int right = left + size < m_nWidth ? left + size : m_nWidth;
+	int bottom = top + size < m_nHeight ? top + size : m_nHeight;
+
+	if (right <= rect[INTERSECTION_LEFT] || left >= rect[INTERSECTION_RIGHT] ||
+		bottom <= rect[INTERSECTION_TOP] || top >= rect[INTERSECTION_BOTTOM])
+	{
+		return;
+	}
+
+	uint8_t flags = GetFlags(level, column, row);
+
+	if ((flags & COVERAGE_ANY) == 0)
+	{
+		*retVal &= ~COVERAGE_ALL;
+		return;
+	}
+
+	if ((flags & COVERAGE_ALL) != 0)
+	{
+		*retVal |= COVERAGE_ANY;
+		*retVal &= ~COVERAGE_NONE;
+		return;
+	}
+
+	bool bInside =
+		left >= rect[INTERSECTION_LEFT] && right <= rect[INTERSECTION_RIGHT] &&
+		top >= rect[INTERSECTION_TOP] && bottom <= rect[INTERSECTION_BOTTOM];
+
+	if (bInside)
+	{
+		*retVal |= COVERAGE_ANY;
+		*retVal &= ~(COVERAGE_ALL | COVERAGE_NONE);
+		return;
+	}
+
+	if (level == 0)
+	{
+		// Partly covered and partly inside: could be anything.
+		*retVal &= ~(COVERAGE_ALL | COVERAGE_NONE);
+		return;
+	}
+
+	for (int childRow = row * 2; childRow < row * 2 + 2 && childRow < m_levels[level - 1].nRows; childRow++)
+	{
+		for (int childColumn = column * 2; childColumn < column * 2 + 2 && childColumn < m_levels[level - 1].nColumns; childColumn++)
+		{
+			ClassifyBlock(level - 1, childColumn, childRow, rect, wanted, retVal);
+
+			// Stop once none of the wanted answers can change.
+			if ((*retVal & (COVERAGE_ALL | COVERAGE_NONE) & wanted) == 0 &&
+				((wanted & COVERAGE_ANY) == 0 || (*retVal & COVERAGE_ANY) != 0))
+			{
+				return;
+			}
+		}
+	}
+}
+
+bool CollisionMaskHierarchy::Overlap(
+	CollisionMaskHierarchy * a,
+	PackedCollisionMask * aMask,
+	int * aTopLeft,
+	CollisionMaskHierarchy * b,
+	PackedCollisionMask * bMask,
+	int * bTopLeft,
+	int * intersectRect)
+{
+	if (a->m_levels.empty() || b->m_levels.empty())
+	{
+		return false;
+	}
+
+	return OverlapBlock(
+		a,
+		aMask,
+		aTopLeft,
+		b,
+		bMask,
+		bTopLeft,
+		intersectRect,
+		(int)a->m_levels.size() - 1,
+		0,
+		0);
+}
+
+// Descends a's blocks; b is classified over whatever part of the
+//	intersection each block covers.
+bool CollisionMaskHierarchy::OverlapBlock(
+	CollisionMaskHierarchy * a,
+	PackedCollisionMask * aMask,
+	int * aTopLeft,
+	CollisionMaskHierarchy * b,
+	PackedCollisionMask * bMask,
+	int * bTopLeft,
+	int * intersectRect,
+	int level,
+	int column,
+	int row)
+{
+	int size = a->GetBlockSize(level);
+
+	// The block in screen pixels.
+	int blockLeft = aTopLeft[HORIZONTAL_AXIS] + column * size;
+	int blockTop = aTopLeft[VERTICAL_AXIS] + row * size;
+	int blockRight = aTopLeft[HORIZONTAL_AXIS] + (column * size + size < a->m_nWidth ? column * size + size : a->m_nWidth);
+	int blockBottom = aTopLeft[VERTICAL_AXIS] + (row * size + size < a->m_nHeight ? row * size + size : a->m_nHeight);
+
+	// Clipped to the intersection.
+	int left = blockLeft > intersectRect[INTERSECTION_LEFT] ? blockLeft : intersectRect[INTERSECTION_LEFT];
+	int top = blockTop > intersectRect[INTERSECTION_TOP] ? blockTop : intersectRect[INTERSECTION_TOP];
+	int right = blockRight < intersectRect[INTERSECTION_RIGHT] ? blockRight : intersectRect[INTERSECTION_RIGHT];
+	int bottom = blockBottom < intersectRect[INTERSECTION_BOTTOM] ? blockBottom : intersectRect[INTERSECTION_BOTTOM];
+
+	if (left >= right || top >= bottom)
+	{
+		return false;
+	}
+
+	uint8_t flags = a->GetFlags(level, column, row);
+
+	if ((flags & COVERAGE_ANY) == 0)
+	{
+		return false;
+	}
+
+	bool bInside =
+		blockLeft == left && blockRight == right &&
+		blockTop == top && blockBottom == bottom;
+
+	// Only ask b for what could decide the block.
+	int wanted = COVERAGE_NONE;
+
+	if ((flags & COVERAGE_ALL) != 0)
+	{
+		wanted |= COVERAGE_ANY;
+	}
+
+	if (bInside)
+	{
+		wanted |= COVERAGE_ALL;
+	}
+
+	int bFlags = b->Classify(
+		left - bTopLeft[HORIZONTAL_AXIS],
+		top - bTopLeft[VERTICAL_AXIS],
+		right - bTopLeft[HORIZONTAL_AXIS],
+		bottom - bTopLeft[VERTICAL_AXIS],
+		wanted);
+
+	if ((bFlags & COVERAGE_NONE) != 0)
+	{
+		return false;
+	}
+
+	// Full on one side and something on the other.
+	if ((flags & COVERAGE_ALL) != 0 && (bFlags & COVERAGE_ANY) != 0)
+	{
+		return true;
+	}
+
+	if (bInside && (bFlags & COVERAGE_ALL) != 0)
+	{
+		return true;
+	}
+
+	// Once the region is a handful of rows, comparing the bits is
+	//	cheaper than descending further.
+	if (level == 0 || bottom - top <= COVERAGE_DIRECT_ROWS)
+	{
+		// Both sides partly covered: compare the texels.
+		int aColumn = left - aTopLeft[HORIZONTAL_AXIS];
+		int bColumn = left - bTopLeft[HORIZONTAL_AXIS];
+		int width = right - left;
+
+		if (width <= 64)
+		{
+			// A single word per row; not worth a call into the kernels.
+			uint64_t span = width == 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1;
+
+			for (int screenRow = top; screenRow < bottom; screenRow++)
+			{
+				uint64_t overlap =
+					PackedCollisionMask::ExtractWord(aMask->GetRow(screenRow - aTopLeft[VERTICAL_AXIS]), aColumn) &
+					PackedCollisionMask::ExtractWord(bMask->GetRow(screenRow - bTopLeft[VERTICAL_AXIS]), bColumn);
+
+				if ((overlap & span) != 0)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		CollisionKernelTable * kernels = CollisionKernels::Get();
+
+		for (int screenRow = top; screenRow < bottom; screenRow++)
+		{
+			if (kernels->PackedSpanOverlap(
+				aMask->GetRow(screenRow - aTopLeft[VERTICAL_AXIS]),
+				aColumn,
+				bMask->GetRow(screenRow - bTopLeft[VERTICAL_AXIS]),
+				bColumn,
+				width))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	Level & below = a->m_levels[level - 1];
+
+	for (int childRow = row * 2; childRow < row * 2 + 2 && childRow < below.nRows; childRow++)
+	{
+		for (int childColumn = column * 2; childColumn < column * 2 + 2 && childColumn < below.nColumns; childColumn++)
+		{
+			if (OverlapBlock(
+				a,
+				aMask,
+				aTopLeft,
+				b,
+				bMask,
+				bTopLeft,
+				intersectRect,
+				level - 1,
+				childColumn,
+				childRow))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "pch.h"
+#include "PackedCollisionMask.h"
+#include "Constants.h"
+#include <vector>
+
+// Coverage pyramid over a packed mask. Level 0 has one entry per
+//	8 x 8 block of texels and each level above halves the blocks
+//	in each direction, up to one block for the whole sprite. Every
+//	block records whether any and whether all of its texels are set.
+class CollisionMaskHierarchy
+{
+public:
+	CollisionMaskHierarchy();
+	CollisionMaskHierarchy(PackedCollisionMask * mask);
+
+	int GetWidth()
+	{
+		return m_nWidth;
+	}
+
+	int GetHeight()
+	{
+		return m_nHeight;
+	}
+
+	int GetNumLevels()
+	{
+		return (int)m_levels.size();
+	}
+
+	// COVERAGE_ANY, COVERAGE_ALL and COVERAGE_NONE for the rectangle
+	//	(left, top inclusive; right, bottom exclusive) in mask texels.
+	//	Each flag is only set if it is certain; blocks cut by the
+	//	rectangle that are neither empty nor full leave all three clear.
+	//	The search stops as soon as the flags in wanted are settled.
+	int Classify(
+		int left,
+		int top,
+		int right,
+		int bottom,
+		int wanted = COVERAGE_ANY | COVERAGE_ALL | COVERAGE_NONE);
+
+	// Same contract as PackedCollisionMask::Overlap. Blocks that are
+	//	empty on either side are skipped, blocks that are full on one
+	//	side only need a set texel on the other, and bits are only
+	//	compared where both sides are partially covered, once the
+	//	region is down to COVERAGE_DIRECT_ROWS rows.
+	static bool Overlap(
+		CollisionMaskHierarchy * a,
+		PackedCollisionMask * aMask,
+		int * aTopLeft,
+		CollisionMaskHierarchy * b,
+		PackedCollisionMask * bMask,
+		int * bTopLeft,
+		int * intersectRect);
+
+protected:
+
+private:
+	struct Level
+	{
+		int nColumns;
+		int nRows;
+		std::vector<uint8_t> flags;
+	};
+
+	uint8_t GetFlags(int level, int column, int row)
+	{
+		return m_levels[level].flags[row * m_levels[level].nColumns + column];
+	}
+
+	int GetBlockSize(int level)
+	{
+		return COVERAGE_BLOCK_SIZE << level;
+	}
+
+	void ClassifyBlock(
+		int level,
+		int column,
+		int row,
+		int * rect,
+		int wanted,
+		int * retVal);
+
+	static bool OverlapBlock(
+		CollisionMaskHierarchy * a,
+		PackedCollisionMask * aMask,
+		int * aTopLeft,
+		CollisionMaskHierarchy * b,
+		PackedCollisionMask * bMask,
+		int * bTopLeft,
+		int * intersectRect,
+		int level,
+		int column,
+		int row);
+
+	int m_nWidth;
+	int m_nHeight;
+
+	std::vector<Level> m_levels;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include "pch.h"
+#include "CollisionMask.h"
+#include "PackedCollisionMask.h"
+#include "CollisionMaskHierarchy.h"
+#include "CollisionShape.h"
+#include "DistanceField.h"
+
+// Every collision representation that has been derived from one texture.
+//	The raw mask is built once at load; the others depend on the
+//	size the sprite is rendered at and are rebuilt when that changes.
+struct CollisionMaskSet
+{
+	CollisionMask mask;
+
+	// The alpha at the rendered size, one byte per texel.
+	CollisionMask scaled;
+
+	PackedCollisionMask packed;
+
+	// Coverage of packed, coarsest block last.
+	CollisionMaskHierarchy hierarchy;
+
+	// Convex outline of the opaque texels, traced from mask at load,
+	//	and the same outline at the rendered size.
+	CollisionShape shape;
+	CollisionShape scaledShape;
+
+	// Signed distance to the outline, coarse enough to build at load
+	//	and sampled at whatever size the sprite is rendered at.
+	DistanceField field;
+};
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "CollisionPairCache.h"
+#include "Constants.h"
+
+CollisionPairCache::CollisionPairCache()
+{
+	m_entries.resize(COLLISION_PAIR_CACHE_SIZE);
+	m_nMask = COLLISION_PAIR_CACHE_SIZE - 1;
+	m_nStamp = 0;
+	m_nHits = 0;
+	m_nMisses = 0;
+
+	Clear();
+}
+
+bool CollisionPairCache::Lookup(
+	const void * a,
+	const void * b,
+	int dx,
+	int dy,
+	int width,
+	int height,
+	bool * pbCollision,
+	DistanceFieldContact * contact)
+{
+	unsigned int index = Hash(a, b, dx, dy);
+
+	for (int probe = 0; probe < COLLISION_PAIR_CACHE_PROBES; probe++)
+	{
+		Entry & entry = m_entries[(index + probe) & m_nMask];
+
+		if (!entry.bUsed)
+		{
+			break;
+		}
+
+		if (Matches(entry, a, b, dx, dy, width, height))
+		{
+			entry.nStamp = ++m_nStamp;
+			*pbCollision = entry.bCollision;
+			*contact = entry.contact;
+			m_nHits++;
+
+			return true;
+		}
+	}
+
+	m_nMisses++;
+
+	return false;
+}
+
+void CollisionPairCache::Store(
+	const void * a,
+	const void * b,
+	int dx,
+	int dy,
+	int width,
+	int height,
+	bool bCollision,
+	const DistanceFieldContact & contact)
+{
+	unsigned int index = Hash(a, b, dx, dy);
+	Entry * target = NULL;
+
+	for (int probe = 0; probe < COLLISION_PAIR_CACHE_PROBES; probe++)
+	{
+		Entry & entry = m_entries[(index + probe) & m_nMask];
+
+		if (!entry.bUsed || Matches(entry, a, b, dx, dy, width, height))
+		{
+			target = &entry;
+			break;
+		}
+
+		// Nothing free in reach: replace the least recently used.
+		if (target == NULL || entry.nStamp < target->nStamp)
+		{
+			target = &entry;
+		}
+	}
+
+	target->a = a;
+	target->b = b;
+	target->dx = dx;
+	target->dy = dy;
+	target->width = width;
+	target->height = height;
+	target->bUsed = true;
+	target->bCollision = bCollision;
+	target->contact = contact;
+	target->nStamp = ++m_nStamp;
+}
+
+void CollisionPairCache::Clear()
+{
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		m_entries[i].bUsed = false;
+	}
+}
+
+unsigned int CollisionPairCache::Hash(const void * a, const void * b, int dx, int dy)
+{
+	// FNV-1a over the four keys.
+	uint64_t keys[4] = { (uint64_t)(uintptr_t)a, (uint64_t)(uintptr_t)b, (uint64_t)(uint32_t)dx, (uint64_t)(uint32_t)dy };
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (int key = 0; key < 4; key++)
+	{
+		for (int byte = 0; byte < 8; byte++)
+		{
+			hash ^= (keys[key] >> (byte * 8)) & 0xff;
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	return (unsigned int)(hash ^ (hash >> 32)) & m_nMask;
+}
+
+bool CollisionPairCache::Matches(
+	Entry & entry,
+	const void * a,
+	const void * b,
+	int dx,
+	int dy,
+	int width,
+	int height)
+{
+	return
+		entry.a == a &&
+		entry.b == b &&
+		entry.dx == dx &&
+		entry.dy == dy &&
+		entry.width == width &&
+		entry.height == height;
+}
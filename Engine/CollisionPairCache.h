@@ -0,0 +1,105 @@
+#pragma once
+#include "pch.h"
+#include "DistanceField.h"
+#include <vector>
+
+// Pixel test results from earlier frames, keyed on the two objects
+//	and the offset between them in whole pixels (the narrow phase
+//	places sprites on whole pixels, so nothing finer can change the
+//	result). While neither side moves relative to the other, the
+//	stored result is returned instead of testing the masks again.
+//	The contact is kept with it, so that a pair the distance fields
+//	found touching still resolves without being tested again.
+//	Clear it whenever the masks are rebuilt.
+class CollisionPairCache
+{
+public:
+	CollisionPairCache();
+
+	// Returns true, and the stored result in pbCollision and contact,
+	//	if the pair was tested at this offset and size before.
+	bool Lookup(
+		const void * a,
+		const void * b,
+		int dx,
+		int dy,
+		int width,
+		int height,
+		bool * pbCollision,
+		DistanceFieldContact * contact);
+
+	// contact has a zero normal if the test that was run gives none.
+	void Store(
+		const void * a,
+		const void * b,
+		int dx,
+		int dy,
+		int width,
+		int height,
+		bool bCollision,
+		const DistanceFieldContact & contact);
+
+	void Clear();
+
+	unsigned int GetHits()
+	{
+		return m_nHits;
+	}
+
+	unsigned int GetMisses()
+	{
+		return m_nMisses;
+	}
+
+	// Share of lookups answered from the cache, 0 to 1.
+	float GetHitRate()
+	{
+		unsigned int nLookups = m_nHits + m_nMisses;
+
+		return nLookups > 0 ? (float)m_nHits / (float)nLookups : 0.0f;
+	}
+
+	void ResetCounters()
+	{
+		m_nHits = 0;
+		m_nMisses = 0;
+	}
+
+protected:
+
+private:
+	struct Entry
+	{
+		const void * a;
+		const void * b;
+		int dx;
+		int dy;
+		int width;
+		int height;
+		bool bUsed;
+		bool bCollision;
+		DistanceFieldContact contact;
+
+		// When it was last stored or found, to pick what to evict.
+		unsigned int nStamp;
+	};
+
+	unsigned int Hash(const void * a, const void * b, int dx, int dy);
+
+	bool Matches(
+		Entry & entry,
+		const void * a,
+		const void * b,
+		int dx,
+		int dy,
+		int width,
+		int height);
+
+	// Open addressing with linear probing over a power of two table.
+	std::vector<Entry> m_entries;
+	unsigned int m_nMask;
+	unsigned int m_nStamp;
+
+	unsigned int m_nHits;
+	unsigned int m_nMisses;
+};
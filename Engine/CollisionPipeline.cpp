@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "CollisionPipeline.h"
+#include "BoundingBoxCornerCollisionStrategy.h"
+#include "BoundingBoxMidpointCollisionStrategy.h"
+#include "CircularZoneCollisionStrategy.h"
+#include "SpriteOverlapCollisionStrategy.h"
+
+RuntimeCollisionPipeline::RuntimeCollisionPipeline(
+	BroadCollisionStrategy * grid,
+	NarrowCollisionStrategy * narrow)
+{
+	m_broadPhases[BROAD_PHASE_GRID] = grid;
+	m_broadPhases[BROAD_PHASE_CORNER] = new BoundingBoxCornerCollisionStrategy();
+	m_broadPhases[BROAD_PHASE_MIDPOINT] = new BoundingBoxMidpointCollisionStrategy();
+	m_broadPhases[BROAD_PHASE_CIRCULAR_ZONE] = new CircularZoneCollisionStrategy();
+	m_broadPhases[BROAD_PHASE_SPRITE_OVERLAP] = new SpriteOverlapCollisionStrategy();
+
+	m_pNarrow = narrow;
+	m_nBroadPhase = BROAD_PHASE_GRID;
+}
+
+RuntimeCollisionPipeline::~RuntimeCollisionPipeline()
+{
+	for (int i = 0; i < NUM_BROAD_PHASES; i++)
+	{
+		if (i != BROAD_PHASE_GRID)
+		{
+			delete m_broadPhases[i];
+		}
+	}
+}
+
+bool RuntimeCollisionPipeline::SetBroadPhase(int nBroadPhase)
+{
+	if (nBroadPhase < 0 || nBroadPhase >= NUM_BROAD_PHASES)
+	{
+		return false;
+	}
+
+	m_nBroadPhase = nBroadPhase;
+
+	return true;
+}
+
+void RuntimeCollisionPipeline::Invalidate()
+{
+	for (int i = 0; i < NUM_BROAD_PHASES; i++)
+	{
+		m_broadPhases[i]->Invalidate();
+	}
+}
+
+const char * RuntimeCollisionPipeline::GetBroadPhaseName(int nBroadPhase)
+{
+	switch (nBroadPhase)
+	{
+	case BROAD_PHASE_GRID:
+		return "grid";
+	case BROAD_PHASE_CORNER:
+		return "corner";
+	case BROAD_PHASE_MIDPOINT:
+		return "midpoint";
+	case BROAD_PHASE_CIRCULAR_ZONE:
+		return "circular zone";
+	case BROAD_PHASE_SPRITE_OVERLAP:
+		return "sprite overlap";
+	}
+
+	return "unknown";
+}
+
+int RuntimeCollisionPipeline::Detect(
+	CollisionCandidates * candidates,
+	float2 playerSize,
+	float2 spriteSize,
+	Player * pPlayer,
+	vector<BaseSpriteData *> * sprites,
+	float fWindowWidth,
+	float fWindowHeight,
+	float * playerLocation,
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,
+	Grid * grid,
+	int * intersectRect,
+	DirectionalCollsionDetectionInfo * contacts)
+{
+	m_broadPhases[m_nBroadPhase]->Detect(
+		candidates,
+		playerSize,
+		spriteSize,
+		pPlayer,
+		sprites,
+		fWindowWidth,
+		fWindowHeight,
+		playerLocation);
+
+	return m_pNarrow->Detect(
+		playerMasks,
+		obstacleMasks,
+		pPlayer,
+		candidates,
+		playerLocation,
+		grid,
+		intersectRect,
+		contacts);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "pch.h"
+#include "CollisionDetectionStrategy.h"
+#include "BroadCollisionStrategy.h"
+#include "NarrowCollisionStrategy.h"
+#include "CollisionCandidates.h"
+#include "CollisionMaskSet.h"
+#include "Constants.h"
+
+// A broad phase and a narrow phase, chosen at compile time. The
+//	broad phase is called through FindCandidates and the narrow phase
+//	directly, so nothing goes through a virtual function and the
+//	strategy's test is inlined into the loop over the sprites.
+//
+//	BroadPhase is one of the BroadPhaseStrategy classes; NarrowPhase
+//	needs the Detect of NarrowCollisionStrategy.
+template<class BroadPhase, class NarrowPhase>
+class CollisionPipeline
+{
+public:
+	CollisionPipeline(BroadPhase * broad, NarrowPhase * narrow)
+	{
+		m_pBroad = broad;
+		m_pNarrow = narrow;
+	}
+
+	// Fills candidates with what the broad phase finds and tests
+	//	them with the narrow phase. Returns the narrow phase's state.
+	int Detect(
+		CollisionCandidates * candidates,
+		float2 playerSize,
+		float2 spriteSize,
+		Player * pPlayer,
+		vector<BaseSpriteData *> * sprites,
+		float fWindowWidth,
+		float fWindowHeight,
+		float * playerLocation,
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		Grid * grid,
+		int * intersectRect,
+		DirectionalCollsionDetectionInfo * contacts)
+	{
+		m_pBroad->FindCandidates(
+			candidates,
+			playerSize,
+			spriteSize,
+			pPlayer,
+			sprites,
+			fWindowWidth,
+			fWindowHeight,
+			playerLocation);
+
+		return m_pNarrow->Detect(
+			playerMasks,
+			obstacleMasks,
+			pPlayer,
+			candidates,
+			playerLocation,
+			grid,
+			intersectRect,
+			contacts);
+	}
+
+	// Call when the sprites have been rebuilt.
+	void Invalidate()
+	{
+		m_pBroad->Invalidate();
+	}
+
+	BroadPhase * GetBroadPhase()
+	{
+		return m_pBroad;
+	}
+
+	NarrowPhase * GetNarrowPhase()
+	{
+		return m_pNarrow;
+	}
+
+protected:
+
+private:
+	BroadPhase * m_pBroad;
+	NarrowPhase * m_pNarrow;
+};
+
+// The same pipeline with the broad phase picked at run time
+//	(BROAD_PHASE_*), through CollisionDetectionStrategy, for trying
+//	the strategies against each other without rebuilding.
+class RuntimeCollisionPipeline
+{
+public:
+	// grid is the BROAD_PHASE_GRID strategy and stays the caller's,
+	//	since it also holds the moving sprites; the others are made
+	//	here. Starts on BROAD_PHASE_GRID.
+	RuntimeCollisionPipeline(BroadCollisionStrategy * grid, NarrowCollisionStrategy * narrow);
+	~RuntimeCollisionPipeline();
+
+	// Returns false, and keeps the current one, for an unknown id.
+	bool SetBroadPhase(int nBroadPhase);
+
+	int GetBroadPhase()
+	{
+		return m_nBroadPhase;
+	}
+
+	static const char * GetBroadPhaseName(int nBroadPhase);
+
+	// Call when the sprites have been rebuilt. Every broad phase is
+	//	told, not just the current one, so switching is safe.
+	void Invalidate();
+
+	int Detect(
+		CollisionCandidates * candidates,
+		float2 playerSize,
+		float2 spriteSize,
+		Player * pPlayer,
+		vector<BaseSpriteData *> * sprites,
+		float fWindowWidth,
+		float fWindowHeight,
+		float * playerLocation,
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		Grid * grid,
+		int * intersectRect,
+		DirectionalCollsionDetectionInfo * contacts);
+
+protected:
+
+private:
+	CollisionDetectionStrategy * m_broadPhases[NUM_BROAD_PHASES];
+	NarrowCollisionStrategy * m_pNarrow;
+
+	int m_nBroadPhase;
+};
@@ -0,0 +1,502 @@
+#include "pch.h"
+#include "CollisionQuery.h"
+#include "SweptCollision.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+CollisionQuery::CollisionQuery(BroadCollisionStrategy * broad)
+{
+	m_pBroad = broad;
+
+	m_fLeft = 0.0f;
+	m_fTop = 0.0f;
+	m_fColumnWidth = 0.0f;
+	m_fRowHeight = 0.0f;
+}
+
+void CollisionQuery::SetLayout(float fLeft, float fTop, float fColumnWidth, float fRowHeight)
+{
+	m_fLeft = fLeft;
+	m_fTop = fTop;
+	m_fColumnWidth = fColumnWidth;
+	m_fRowHeight = fRowHeight;
+}
+
+int CollisionQuery::Raycast(
+	float2 origin,
+	float2 direction,
+	float fMaxDistance,
+	unsigned int layerMask,
+	RaycastHit * hits,
+	int nMaxHits)
+{
+	int nHits = 0;
+
+	float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+
+	if (length == 0.0f || fMaxDistance <= 0.0f || nMaxHits <= 0 ||
+		m_fColumnWidth <= 0.0f || m_fRowHeight <= 0.0f)
+	{
+		return 0;
+	}
+
+	direction = float2(direction.x / length, direction.y / length);
+
+	SpatialHashGrid * hash = m_pBroad->GetSpatialHash();
+	hash->BeginQuery();
+
+	// Start the walk where the ray enters the grid.
+	BoundingBox gridBox;
+	gridBox.lowerBound = float2(m_fLeft, m_fTop);
+	gridBox.upperBound = float2(
+		m_fLeft + hash->GetNumColumns() * m_fColumnWidth,
+		m_fTop + hash->GetNumRows() * m_fRowHeight);
+
+	BoundingBox originBox;
+	originBox.lowerBound = origin;
+	originBox.upperBound = origin;
+
+	float2 displacement(direction.x * fMaxDistance, direction.y * fMaxDistance);
+
+	float enter;
+	float exit;
+	int axis;
+
+	if (hash->GetNumColumns() > 0 &&
+		SweptCollision::SweptBox(originBox, displacement, gridBox, &enter, &exit, &axis))
+	{
+		float tStart = (std::max)(enter, 0.0f) * fMaxDistance;
+		float tEnd = (std::min)(exit, 1.0f) * fMaxDistance;
+
+		float2 start(origin.x + direction.x * tStart, origin.y + direction.y * tStart);
+
+		int column = (std::max)(0, (std::min)(GetColumn(start.x), hash->GetNumColumns() - 1));
+		int row = (std::max)(0, (std::min)(GetRow(start.y), hash->GetNumRows() - 1));
+
+		int stepColumn = direction.x > 0.0f ? 1 : -1;
+		int stepRow = direction.y > 0.0f ? 1 : -1;
+
+		// Distance along the ray to the next vertical and horizontal
+		//	grid line, and between two of them.
+		float nextColumn = FLT_MAX;
+		float nextRow = FLT_MAX;
+		float deltaColumn = FLT_MAX;
+		float deltaRow = FLT_MAX;
+
+		if (direction.x != 0.0f)
+		{
+			float edge = m_fLeft + (column + (stepColumn > 0 ? 1 : 0)) * m_fColumnWidth;
+
+			nextColumn = (edge - origin.x) / direction.x;
+			deltaColumn = m_fColumnWidth / fabs(direction.x);
+		}
+
+		if (direction.y != 0.0f)
+		{
+			float edge = m_fTop + (row + (stepRow > 0 ? 1 : 0)) * m_fRowHeight;
+
+			nextRow = (edge - origin.y) / direction.y;
+			deltaRow = m_fRowHeight / fabs(direction.y);
+		}
+
+		while (true)
+		{
+			BaseSpriteData * batch[COLLISION_QUERY_BATCH];
+			int nBatch;
+
+			do
+			{
+				nBatch = hash->QueryCell(column, row, layerMask, batch, COLLISION_QUERY_BATCH);
+
+				for (int i = 0; i < nBatch; i++)
+				{
+					if (IsWanted(batch[i], layerMask))
+					{
+						TestRay(batch[i], origin, direction, fMaxDistance, hits, &nHits, nMaxHits);
+					}
+				}
+			}
+			while (nBatch == COLLISION_QUERY_BATCH);
+
+			// Sprites further along are in spaces the ray has not
+			//	reached yet, so none of them can beat a full buffer of
+			//	hits that end inside this one.
+			float tLeave = (std::min)(nextColumn, nextRow);
+
+			if (tLeave >= tEnd ||
+				(nHits == nMaxHits && hits[nHits - 1].fDistance <= tLeave))
+			{
+				break;
+			}
+
+			if (nextColumn < nextRow)
+			{
+				column += stepColumn;
+				nextColumn += deltaColumn;
+			}
+			else
+			{
+				row += stepRow;
+				nextRow += deltaRow;
+			}
+
+			if (column < 0 || column >= hash->GetNumColumns() || row < 0 || row >= hash->GetNumRows())
+			{
+				break;
+			}
+		}
+	}
+
+	// Moving sprites are only looked for as far as the hits go.
+	float fReach = nHits == nMaxHits ? hits[nHits - 1].fDistance : fMaxDistance;
+	float2 end(origin.x + direction.x * fReach, origin.y + direction.y * fReach);
+
+	BoundingBox segment;
+	segment.lowerBound = float2((std::min)(origin.x, end.x), (std::min)(origin.y, end.y));
+	segment.upperBound = float2((std::max)(origin.x, end.x), (std::max)(origin.y, end.y));
+
+	QueryMoving(segment, layerMask);
+
+	CollisionCandidates::const_iterator iterator;
+
+	for (iterator = m_moving.begin(); iterator != m_moving.end(); iterator++)
+	{
+		TestRay(*iterator, origin, direction, fMaxDistance, hits, &nHits, nMaxHits);
+	}
+
+	return nHits;
+}
+
+int CollisionQuery::QueryBox(
+	const BoundingBox & box,
+	unsigned int layerMask,
+	BaseSpriteData ** results,
+	int nMaxResults)
+{
+	return QueryArea(box, false, float2(0.0f, 0.0f), 0.0f, layerMask, results, nMaxResults);
+}
+
+int CollisionQuery::QueryCircle(
+	float2 center,
+	float fRadius,
+	unsigned int layerMask,
+	BaseSpriteData ** results,
+	int nMaxResults)
+{
+	return QueryArea(
+		BoundingBox::FromCenter(center, float2(fRadius, fRadius)),
+		true,
+		center,
+		fRadius,
+		layerMask,
+		results,
+		nMaxResults);
+}
+
+BaseSpriteData * CollisionQuery::QueryNearest(
+	float2 point,
+	float fMaxDistance,
+	unsigned int layerMask,
+	float * pfDistance)
+{
+	BaseSpriteData * retVal = NULL;
+	float fBestSquared = fMaxDistance * fMaxDistance;
+
+	SpatialHashGrid * hash = m_pBroad->GetSpatialHash();
+
+	if (m_fColumnWidth > 0.0f && m_fRowHeight > 0.0f && hash->GetNumColumns() > 0)
+	{
+		hash->BeginQuery();
+
+		int centerColumn = GetColumn(point.x);
+		int centerRow = GetRow(point.y);
+
+		// Past this ring every grid space is off the grid.
+		int nLastRing = (std::max)(
+			(std::max)(abs(centerColumn), abs(hash->GetNumColumns() - 1 - centerColumn)),
+			(std::max)(abs(centerRow), abs(hash->GetNumRows() - 1 - centerRow)));
+
+		float fCellSize = (std::min)(m_fColumnWidth, m_fRowHeight);
+
+		for (int ring = 0; ring <= nLastRing; ring++)
+		{
+			// The point is somewhere inside ring 0, so everything in
+			//	this ring is at least ring - 1 spaces away.
+			float fRingDistance = (ring - 1) * fCellSize;
+
+			if (ring > 1 && fRingDistance * fRingDistance >= fBestSquared)
+			{
+				break;
+			}
+
+			for (int row = centerRow - ring; row <= centerRow + ring; row++)
+			{
+				// Only the top and bottom rows of the ring are whole.
+				bool bEdgeRow = row == centerRow - ring || row == centerRow + ring;
+				int step = bEdgeRow || ring == 0 ? 1 : 2 * ring;
+
+				for (int column = centerColumn - ring; column <= centerColumn + ring; column += step)
+				{
+					BaseSpriteData * batch[COLLISION_QUERY_BATCH];
+					int nBatch;
+
+					do
+					{
+						nBatch = hash->QueryCell(column, row, layerMask, batch, COLLISION_QUERY_BATCH);
+
+						for (int i = 0; i < nBatch; i++)
+						{
+							if (IsWanted(batch[i], layerMask))
+							{
+								TestNearest(batch[i], point, &fBestSquared, &retVal);
+							}
+						}
+					}
+					while (nBatch == COLLISION_QUERY_BATCH);
+				}
+			}
+		}
+	}
+
+	float fReach = sqrtf(fBestSquared);
+
+	QueryMoving(BoundingBox::FromCenter(point, float2(fReach, fReach)), layerMask);
+
+	CollisionCandidates::const_iterator iterator;
+
+	for (iterator = m_moving.begin(); iterator != m_moving.end(); iterator++)
+	{
+		TestNearest(*iterator, point, &fBestSquared, &retVal);
+	}
+
+	if (retVal != NULL && pfDistance != NULL)
+	{
+		*pfDistance = sqrtf(fBestSquared);
+	}
+
+	return retVal;
+}
+
+int CollisionQuery::QueryArea(
+	const BoundingBox & bounds,
+	bool bCircle,
+	float2 center,
+	float fRadius,
+	unsigned int layerMask,
+	BaseSpriteData ** results,
+	int nMaxResults)
+{
+	int nResults = 0;
+
+	if (nMaxResults <= 0 || m_fColumnWidth <= 0.0f || m_fRowHeight <= 0.0f)
+	{
+		return 0;
+	}
+
+	SpatialHashGrid * hash = m_pBroad->GetSpatialHash();
+	hash->BeginQuery();
+
+	int minColumn = (std::max)(GetColumn(bounds.lowerBound.x), 0);
+	int minRow = (std::max)(GetRow(bounds.lowerBound.y), 0);
+	int maxColumn = (std::min)(GetColumn(bounds.upperBound.x), hash->GetNumColumns() - 1);
+	int maxRow = (std::min)(GetRow(bounds.upperBound.y), hash->GetNumRows() - 1);
+
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int column = minColumn; column <= maxColumn; column++)
+		{
+			BaseSpriteData * batch[COLLISION_QUERY_BATCH];
+			int nBatch;
+
+			do
+			{
+				nBatch = hash->QueryCell(column, row, layerMask, batch, COLLISION_QUERY_BATCH);
+
+				for (int i = 0; i < nBatch; i++)
+				{
+					if (IsWanted(batch[i], layerMask) &&
+						IsInArea(batch[i], bounds, bCircle, center, fRadius))
+					{
+						results[nResults++] = batch[i];
+
+						if (nResults == nMaxResults)
+						{
+							return nResults;
+						}
+					}
+				}
+			}
+			while (nBatch == COLLISION_QUERY_BATCH);
+		}
+	}
+
+	QueryMoving(bounds, layerMask);
+
+	CollisionCandidates::const_iterator iterator;
+
+	for (iterator = m_moving.begin(); iterator != m_moving.end() && nResults < nMaxResults; iterator++)
+	{
+		if (IsInArea(*iterator, bounds, bCircle, center, fRadius))
+		{
+			results[nResults++] = *iterator;
+		}
+	}
+
+	return nResults;
+}
+
+bool CollisionQuery::IsInArea(
+	BaseSpriteData * sprite,
+	const BoundingBox & bounds,
+	bool bCircle,
+	float2 center,
+	float fRadius)
+{
+	BoundingBox box = GetBox(sprite);
+
+	if (bCircle)
+	{
+		return DistanceSquared(center, box) <= fRadius * fRadius;
+	}
+
+	return bounds.Overlaps(box);
+}
+
+void CollisionQuery::TestNearest(
+	BaseSpriteData * sprite,
+	float2 point,
+	float * pfBestSquared,
+	BaseSpriteData ** ppBest)
+{
+	float distanceSquared = DistanceSquared(point, GetBox(sprite));
+
+	if (distanceSquared < *pfBestSquared)
+	{
+		*pfBestSquared = distanceSquared;
+		*ppBest = sprite;
+	}
+}
+
+void CollisionQuery::QueryMoving(const BoundingBox & box, unsigned int layerMask)
+{
+	m_moving.clear();
+	m_pBroad->QueryMovingSprites(box, &m_moving);
+
+	// Drop what the layers rule out, in place.
+	int nKept = 0;
+
+	for (int i = 0; i < m_moving.size(); i++)
+	{
+		if (IsWanted(m_moving[i], layerMask))
+		{
+			m_moving[nKept++] = m_moving[i];
+		}
+	}
+
+	while (m_moving.size() > nKept)
+	{
+		m_moving.pop_back();
+	}
+}
+
+bool CollisionQuery::IsWanted(BaseSpriteData * sprite, unsigned int layerMask)
+{
+	return sprite->bCollidable && (layerMask & (1u << sprite->nLayer)) != 0;
+}
+
+BoundingBox CollisionQuery::GetBox(BaseSpriteData * sprite)
+{
+	return BoundingBox::FromCenter(
+		sprite->pos,
+		float2(m_fColumnWidth * 0.5f, m_fRowHeight * 0.5f));
+}
+
+int CollisionQuery::GetColumn(float x)
+{
+	return (int)floorf((x - m_fLeft) / m_fColumnWidth);
+}
+
+int CollisionQuery::GetRow(float y)
+{
+	return (int)floorf((y - m_fTop) / m_fRowHeight);
+}
+
+void CollisionQuery::TestRay(
+	BaseSpriteData * sprite,
+	float2 origin,
+	float2 direction,
+	float fMaxDistance,
+	RaycastHit * hits,
+	int * pnHits,
+	int nMaxHits)
+{
+	BoundingBox originBox;
+	originBox.lowerBound = origin;
+	originBox.upperBound = origin;
+
+	float enter;
+	float exit;
+	int axis;
+
+	if (!SweptCollision::SweptBox(
+		originBox,
+		float2(direction.x * fMaxDistance, direction.y * fMaxDistance),
+		GetBox(sprite),
+		&enter,
+		&exit,
+		&axis))
+	{
+		return;
+	}
+
+	RaycastHit hit;
+	hit.sprite = sprite;
+	hit.normal = float2(0.0f, 0.0f);
+
+	if (enter <= 0.0f)
+	{
+		hit.fDistance = 0.0f;
+	}
+	else
+	{
+		hit.fDistance = enter * fMaxDistance;
+
+		if (axis == HORIZONTAL_AXIS)
+		{
+			hit.normal.x = direction.x > 0.0f ? -1.0f : 1.0f;
+		}
+		else
+		{
+			hit.normal.y = direction.y > 0.0f ? -1.0f : 1.0f;
+		}
+	}
+
+	hit.point = float2(
+		origin.x + direction.x * hit.fDistance,
+		origin.y + direction.y * hit.fDistance);
+
+	if (*pnHits == nMaxHits && hit.fDistance >= hits[nMaxHits - 1].fDistance)
+	{
+		return;
+	}
+
+	// Insertion into the sorted hits, dropping the furthest if full.
+	int index = *pnHits < nMaxHits ? (*pnHits)++ : nMaxHits - 1;
+
+	while (index > 0 && hits[index - 1].fDistance > hit.fDistance)
+	{
+		hits[index] = hits[index - 1];
+		index--;
+	}
+
+	hits[index] = hit;
+}
+
+float CollisionQuery::DistanceSquared(float2 point, const BoundingBox & box)
+{
+	float dx = (std::max)((std::max)(box.lowerBound.x - point.x, 0.0f), point.x - box.upperBound.x);
+	float dy = (std::max)((std::max)(box.lowerBound.y - point.y, 0.0f), point.y - box.upperBound.y);
+
+	return dx * dx + dy * dy;
+}
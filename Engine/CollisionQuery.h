@@ -0,0 +1,137 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "BoundingBox.h"
+#include "BroadCollisionStrategy.h"
+#include "CollisionCandidates.h"
+#include "Constants.h"
+
+struct RaycastHit
+{
+	BaseSpriteData * sprite;
+
+	// Along the ray, in screen pixels; 0 if the ray starts inside.
+	float fDistance;
+	float2 point;
+
+	// The side of the sprite that was hit, pointing back along the
+	//	ray; zero if the ray starts inside.
+	float2 normal;
+};
+
+// Line and area queries over the sprites of the broad phase, for
+//	sword reach, line of sight, explosions and the like. The still
+//	sprites are found through the broad phase's spatial hash and the
+//	moving ones through its tree. Like the narrow phase, every sprite
+//	is taken to fill one grid space.
+//
+//	Results go into buffers owned by the caller; nothing here
+//	allocates once the moving sprite buffer has grown.
+class CollisionQuery
+{
+public:
+	CollisionQuery(BroadCollisionStrategy * broad);
+
+	// Where the grid of the spatial hash is on screen, in pixels.
+	//	Call whenever the window changes size.
+	void SetLayout(float fLeft, float fTop, float fColumnWidth, float fRowHeight);
+
+	// Walks the grid spaces along the ray (Amanatides-Woo DDA) and
+	//	writes the nearest nMaxHits sprites hit within fMaxDistance,
+	//	nearest first. direction need not be unit length. Stops as
+	//	soon as nothing further along can be nearer, so nMaxHits = 1
+	//	is a line of sight test. Returns the number of hits written.
+	int Raycast(
+		float2 origin,
+		float2 direction,
+		float fMaxDistance,
+		unsigned int layerMask,
+		RaycastHit * hits,
+		int nMaxHits);
+
+	// Sprites whose box overlaps box. Returns the number written;
+	//	once the buffer is full the rest are dropped.
+	int QueryBox(
+		const BoundingBox & box,
+		unsigned int layerMask,
+		BaseSpriteData ** results,
+		int nMaxResults);
+
+	// Sprites whose box comes within fRadius of center.
+	int QueryCircle(
+		float2 center,
+		float fRadius,
+		unsigned int layerMask,
+		BaseSpriteData ** results,
+		int nMaxResults);
+
+	// The sprite whose box is closest to point, searching outwards
+	//	one ring of grid spaces at a time. NULL if nothing is within
+	//	fMaxDistance. pfDistance, if not NULL, gets the distance.
+	BaseSpriteData * QueryNearest(
+		float2 point,
+		float fMaxDistance,
+		unsigned int layerMask,
+		float * pfDistance);
+
+protected:
+
+private:
+	// QueryBox and QueryCircle: every sprite in the grid spaces
+	//	under bounds that passes the box or circle test.
+	int QueryArea(
+		const BoundingBox & bounds,
+		bool bCircle,
+		float2 center,
+		float fRadius,
+		unsigned int layerMask,
+		BaseSpriteData ** results,
+		int nMaxResults);
+
+	bool IsInArea(
+		BaseSpriteData * sprite,
+		const BoundingBox & bounds,
+		bool bCircle,
+		float2 center,
+		float fRadius);
+
+	// Keeps sprite if it is closer to point than the best so far.
+	void TestNearest(
+		BaseSpriteData * sprite,
+		float2 point,
+		float * pfBestSquared,
+		BaseSpriteData ** ppBest);
+
+	// Moving sprites that may overlap box, into m_moving.
+	void QueryMoving(const BoundingBox & box, unsigned int layerMask);
+
+	bool IsWanted(BaseSpriteData * sprite, unsigned int layerMask);
+
+	BoundingBox GetBox(BaseSpriteData * sprite);
+
+	int GetColumn(float x);
+	int GetRow(float y);
+
+	// Tests one sprite against the ray and keeps it if it is among
+	//	the nearest nMaxHits so far.
+	void TestRay(
+		BaseSpriteData * sprite,
+		float2 origin,
+		float2 direction,
+		float fMaxDistance,
+		RaycastHit * hits,
+		int * pnHits,
+		int nMaxHits);
+
+	static float DistanceSquared(float2 point, const BoundingBox & box);
+
+	BroadCollisionStrategy * m_pBroad;
+
+	float m_fLeft;
+	float m_fTop;
+	float m_fColumnWidth;
+	float m_fRowHeight;
+
+	// Kept between queries so that it stops allocating.
+	CollisionCandidates m_moving;
+};
@@ -0,0 +1,595 @@
+#include "pch.h"
+#include "CollisionShape.h"
+#include "Constants.h"
+#include <algorithm>
+#include <map>
+#include <float.h>
+#include <math.h>
+
+namespace
+{
+	// Marching squares puts every outline point in the middle of an
+	//	edge between two texel centres, so doubled coordinates are
+	//	always whole numbers and can be matched exactly.
+	typedef std::pair<int, int> OutlinePoint;
+
+	float Cross(float2 a, float2 b, float2 c)
+	{
+		return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	}
+
+	float SignedArea(const std::vector<float2> & polygon)
+	{
+		float retVal = 0.0f;
+
+		for (size_t i = 0; i < polygon.size(); i++)
+		{
+			const float2 & a = polygon[i];
+			const float2 & b = polygon[(i + 1) % polygon.size()];
+
+			retVal += a.x * b.y - b.x * a.y;
+		}
+
+		return retVal * 0.5f;
+	}
+
+	bool IsOpaque(CollisionMask * mask, int column, int row)
+	{
+		if (column < 0 || column >= mask->GetWidth() || row < 0 || row >= mask->GetHeight())
+		{
+			return false;
+		}
+
+		return mask->IsOpaque(column, row);
+	}
+
+	// Closed outlines of the opaque regions, in texels. Cells run
+	//	between texel centres, with a transparent border all round so
+	//	that every outline closes.
+	void TraceOutlines(CollisionMask * mask, std::vector<std::vector<float2>> * retVal)
+	{
+		std::map<OutlinePoint, OutlinePoint> next;
+
+		for (int row = -1; row < mask->GetHeight(); row++)
+		{
+			for (int column = -1; column < mask->GetWidth(); column++)
+			{
+				// Corners clockwise from the top left, and the point in
+				//	the middle of each edge: top, right, bottom, left.
+				bool corners[4] =
+				{
+					IsOpaque(mask, column, row),
+					IsOpaque(mask, column + 1, row),
+					IsOpaque(mask, column + 1, row + 1),
+					IsOpaque(mask, column, row + 1)
+				};
+
+				OutlinePoint points[4] =
+				{
+					OutlinePoint(2 * column + 2, 2 * row + 1),
+					OutlinePoint(2 * column + 3, 2 * row + 2),
+					OutlinePoint(2 * column + 2, 2 * row + 3),
+					OutlinePoint(2 * column + 1, 2 * row + 2)
+				};
+
+				// Going clockwise, an edge enters the region if it runs
+				//	from transparent to opaque and leaves it if it runs
+				//	the other way. Joining each entry to the next exit
+				//	gives every segment the region on the same side, and
+				//	keeps the diagonal corners of a saddle apart.
+				for (int edge = 0; edge < 4; edge++)
+				{
+					if (corners[edge] || !corners[(edge + 1) % 4])
+					{
+						continue;
+					}
+
+					for (int step = 1; step < 4; step++)
+					{
+						int exit = (edge + step) % 4;
+
+						if (corners[exit] && !corners[(exit + 1) % 4])
+						{
+							next[points[edge]] = points[exit];
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		std::vector<std::vector<float2>> outlines;
+
+		while (!next.empty())
+		{
+			std::vector<float2> outline;
+			OutlinePoint start = next.begin()->first;
+			OutlinePoint point = start;
+
+			do
+			{
+				outline.push_back(float2(point.first * 0.5f, point.second * 0.5f));
+
+				std::map<OutlinePoint, OutlinePoint>::iterator iterator = next.find(point);
+				point = iterator->second;
+				next.erase(iterator);
+			} while (point != start && next.find(point) != next.end());
+
+			if (outline.size() >= 3)
+			{
+				outlines.push_back(outline);
+			}
+		}
+
+		// Holes wind the other way from the outer outlines; the
+		//	largest outline is always an outer one.
+		float fLargest = 0.0f;
+
+		for (size_t i = 0; i < outlines.size(); i++)
+		{
+			float fArea = SignedArea(outlines[i]);
+
+			if (fabsf(fArea) > fabsf(fLargest))
+			{
+				fLargest = fArea;
+			}
+		}
+
+		for (size_t i = 0; i < outlines.size(); i++)
+		{
+			if ((SignedArea(outlines[i]) > 0.0f) == (fLargest > 0.0f))
+			{
+				retVal->push_back(outlines[i]);
+			}
+		}
+	}
+
+	float DistanceToSegment(float2 point, float2 a, float2 b)
+	{
+		float2 ab(b.x - a.x, b.y - a.y);
+		float fLengthSquared = ab.x * ab.x + ab.y * ab.y;
+
+		if (fLengthSquared == 0.0f)
+		{
+			return sqrtf((point.x - a.x) * (point.x - a.x) + (point.y - a.y) * (point.y - a.y));
+		}
+
+		return fabsf(Cross(a, b, point)) / sqrtf(fLengthSquared);
+	}
+
+	// Douglas-Peucker over outline[first..last]; marks the points kept.
+	void SimplifyRange(
+		const std::vector<float2> & outline,
+		int first,
+		int last,
+		float fTolerance,
+		std::vector<bool> * keep)
+	{
+		if (last - first < 2)
+		{
+			return;
+		}
+
+		float fFarthest = -1.0f;
+		int nFarthest = first;
+		size_t nPoints = outline.size();
+
+		for (int i = first + 1; i < last; i++)
+		{
+			float fDistance = DistanceToSegment(
+				outline[i % nPoints],
+				outline[first % nPoints],
+				outline[last % nPoints]);
+
+			if (fDistance > fFarthest)
+			{
+				fFarthest = fDistance;
+				nFarthest = i;
+			}
+		}
+
+		if (fFarthest <= fTolerance)
+		{
+			return;
+		}
+
+		(*keep)[nFarthest % nPoints] = true;
+
+		SimplifyRange(outline, first, nFarthest, fTolerance, keep);
+		SimplifyRange(outline, nFarthest, last, fTolerance, keep);
+	}
+
+	// A closed outline is split at its first point and the point
+	//	farthest from it, and each half simplified on its own.
+	std::vector<float2> Simplify(const std::vector<float2> & outline, float fTolerance)
+	{
+		int nPoints = (int)outline.size();
+		int nFarthest = 0;
+		float fFarthest = -1.0f;
+
+		for (int i = 1; i < nPoints; i++)
+		{
+			float dx = outline[i].x - outline[0].x;
+			float dy = outline[i].y - outline[0].y;
+
+			if (dx * dx + dy * dy > fFarthest)
+			{
+				fFarthest = dx * dx + dy * dy;
+				nFarthest = i;
+			}
+		}
+
+		std::vector<bool> keep(nPoints, false);
+		keep[0] = true;
+		keep[nFarthest] = true;
+
+		SimplifyRange(outline, 0, nFarthest, fTolerance, &keep);
+		SimplifyRange(outline, nFarthest, nPoints, fTolerance, &keep);
+
+		std::vector<float2> retVal;
+
+		for (int i = 0; i < nPoints; i++)
+		{
+			if (keep[i])
+			{
+				retVal.push_back(outline[i]);
+			}
+		}
+
+		return retVal;
+	}
+
+	// Drops points that lie on the line through their neighbours.
+	void RemoveCollinear(std::vector<float2> * polygon)
+	{
+		bool bRemoved = true;
+
+		while (bRemoved && polygon->size() >= 3)
+		{
+			bRemoved = false;
+
+			for (size_t i = 0; i < polygon->size(); i++)
+			{
+				size_t n = polygon->size();
+
+				if (fabsf(Cross((*polygon)[(i + n - 1) % n], (*polygon)[i], (*polygon)[(i + 1) % n])) < 1.0e-4f)
+				{
+					polygon->erase(polygon->begin() + i);
+					bRemoved = true;
+					break;
+				}
+			}
+		}
+	}
+
+	bool InTriangle(float2 point, float2 a, float2 b, float2 c)
+	{
+		return Cross(a, b, point) >= 0.0f && Cross(b, c, point) >= 0.0f && Cross(c, a, point) >= 0.0f;
+	}
+
+	// Ear clipping of a counter-clockwise polygon into triangles of
+	//	vertex indices. Stops early if the outline crosses itself.
+	void Triangulate(const std::vector<float2> & polygon, std::vector<std::vector<int>> * retVal)
+	{
+		std::vector<int> remaining;
+
+		for (int i = 0; i < (int)polygon.size(); i++)
+		{
+			remaining.push_back(i);
+		}
+
+		while (remaining.size() > 3)
+		{
+			bool bClipped = false;
+			size_t n = remaining.size();
+
+			for (size_t i = 0; i < n && !bClipped; i++)
+			{
+				int previous = remaining[(i + n - 1) % n];
+				int current = remaining[i];
+				int following = remaining[(i + 1) % n];
+
+				if (Cross(polygon[previous], polygon[current], polygon[following]) <= 0.0f)
+				{
+					continue;
+				}
+
+				bool bEar = true;
+
+				for (size_t j = 0; j < n && bEar; j++)
+				{
+					int other = remaining[j];
+
+					if (other != previous && other != current && other != following &&
+						InTriangle(polygon[other], polygon[previous], polygon[current], polygon[following]))
+					{
+						bEar = false;
+					}
+				}
+
+				if (bEar)
+				{
+					std::vector<int> triangle;
+					triangle.push_back(previous);
+					triangle.push_back(current);
+					triangle.push_back(following);
+					retVal->push_back(triangle);
+
+					remaining.erase(remaining.begin() + i);
+					bClipped = true;
+				}
+			}
+
+			if (!bClipped)
+			{
+				return;
+			}
+		}
+
+		if (remaining.size() == 3 &&
+			Cross(polygon[remaining[0]], polygon[remaining[1]], polygon[remaining[2]]) > 0.0f)
+		{
+			retVal->push_back(remaining);
+		}
+	}
+
+	bool IsConvex(const std::vector<float2> & polygon, const std::vector<int> & piece)
+	{
+		size_t n = piece.size();
+
+		for (size_t i = 0; i < n; i++)
+		{
+			if (Cross(polygon[piece[i]], polygon[piece[(i + 1) % n]], polygon[piece[(i + 2) % n]]) < -1.0e-4f)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Hertel-Mehlhorn: joins pieces across a shared edge for as long
+	//	as the result stays convex.
+	void MergeConvex(const std::vector<float2> & polygon, std::vector<std::vector<int>> * pieces)
+	{
+		bool bMerged = true;
+
+		while (bMerged)
+		{
+			bMerged = false;
+
+			for (size_t i = 0; i < pieces->size() && !bMerged; i++)
+			{
+				for (size_t j = i + 1; j < pieces->size() && !bMerged; j++)
+				{
+					std::vector<int> & a = (*pieces)[i];
+					std::vector<int> & b = (*pieces)[j];
+
+					for (size_t edge = 0; edge < a.size() && !bMerged; edge++)
+					{
+						int u = a[edge];
+						int v = a[(edge + 1) % a.size()];
+
+						for (size_t other = 0; other < b.size(); other++)
+						{
+							if (b[other] != v || b[(other + 1) % b.size()] != u)
+							{
+								continue;
+							}
+
+							// v around a to u, then b's vertices between u and v.
+							std::vector<int> merged;
+
+							for (size_t k = 0; k < a.size(); k++)
+							{
+								merged.push_back(a[(edge + 1 + k) % a.size()]);
+							}
+
+							for (size_t k = 2; k < b.size(); k++)
+							{
+								merged.push_back(b[(other + k) % b.size()]);
+							}
+
+							if (IsConvex(polygon, merged))
+							{
+								a = merged;
+								pieces->erase(pieces->begin() + j);
+								bMerged = true;
+							}
+
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	BoundingBox CalculateBounds(const std::vector<float2> & vertices)
+	{
+		BoundingBox retVal;
+		retVal.lowerBound = vertices[0];
+		retVal.upperBound = vertices[0];
+
+		for (size_t i = 1; i < vertices.size(); i++)
+		{
+			retVal = BoundingBox::Combine(retVal, BoundingBox::FromCenter(vertices[i], float2(0.0f, 0.0f)));
+		}
+
+		return retVal;
+	}
+}
+
+CollisionShape::CollisionShape()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+CollisionShape CollisionShape::FromMask(CollisionMask * mask, float fTolerance)
+{
+	CollisionShape retVal;
+	retVal.m_nWidth = mask->GetWidth();
+	retVal.m_nHeight = mask->GetHeight();
+
+	std::vector<std::vector<float2>> outlines;
+	TraceOutlines(mask, &outlines);
+
+	for (size_t outline = 0; outline < outlines.size(); outline++)
+	{
+		std::vector<float2> polygon = Simplify(outlines[outline], fTolerance);
+		RemoveCollinear(&polygon);
+
+		if (polygon.size() < 3)
+		{
+			continue;
+		}
+
+		if (SignedArea(polygon) < 0.0f)
+		{
+			std::reverse(polygon.begin(), polygon.end());
+		}
+
+		std::vector<std::vector<int>> pieces;
+		Triangulate(polygon, &pieces);
+		MergeConvex(polygon, &pieces);
+
+		for (size_t piece = 0; piece < pieces.size(); piece++)
+		{
+			ConvexPolygon convex;
+
+			for (size_t vertex = 0; vertex < pieces[piece].size(); vertex++)
+			{
+				convex.vertices.push_back(polygon[pieces[piece][vertex]]);
+			}
+
+			convex.bounds = CalculateBounds(convex.vertices);
+			retVal.m_pieces.push_back(convex);
+		}
+	}
+
+	return retVal;
+}
+
+CollisionShape CollisionShape::Scale(int width, int height)
+{
+	CollisionShape retVal;
+	retVal.m_nWidth = width;
+	retVal.m_nHeight = height;
+	retVal.m_pieces = m_pieces;
+
+	if (m_nWidth == 0 || m_nHeight == 0)
+	{
+		return retVal;
+	}
+
+	float fScaleX = (float)width / (float)m_nWidth;
+	float fScaleY = (float)height / (float)m_nHeight;
+
+	for (size_t piece = 0; piece < retVal.m_pieces.size(); piece++)
+	{
+		ConvexPolygon & convex = retVal.m_pieces[piece];
+
+		for (size_t vertex = 0; vertex < convex.vertices.size(); vertex++)
+		{
+			convex.vertices[vertex].x *= fScaleX;
+			convex.vertices[vertex].y *= fScaleY;
+		}
+
+		convex.bounds = CalculateBounds(convex.vertices);
+	}
+
+	return retVal;
+}
+
+bool CollisionShape::Overlap(
+	CollisionShape * a,
+	int * aTopLeft,
+	CollisionShape * b,
+	int * bTopLeft)
+{
+	// b relative to a.
+	float2 offset(
+		(float)(bTopLeft[HORIZONTAL_AXIS] - aTopLeft[HORIZONTAL_AXIS]),
+		(float)(bTopLeft[VERTICAL_AXIS] - aTopLeft[VERTICAL_AXIS]));
+
+	for (size_t i = 0; i < a->m_pieces.size(); i++)
+	{
+		ConvexPolygon * aPiece = &a->m_pieces[i];
+
+		for (size_t j = 0; j < b->m_pieces.size(); j++)
+		{
+			ConvexPolygon * bPiece = &b->m_pieces[j];
+
+			if (aPiece->bounds.upperBound.x <= bPiece->bounds.lowerBound.x + offset.x ||
+				bPiece->bounds.upperBound.x + offset.x <= aPiece->bounds.lowerBound.x ||
+				aPiece->bounds.upperBound.y <= bPiece->bounds.lowerBound.y + offset.y ||
+				bPiece->bounds.upperBound.y + offset.y <= aPiece->bounds.lowerBound.y)
+			{
+				continue;
+			}
+
+			if (!Separated(aPiece, bPiece, offset))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Looks for an edge of either piece with the other piece entirely
+//	on its outer side. For two convex pieces that is enough: if they
+//	do not overlap, one such edge always exists.
+bool CollisionShape::Separated(
+	ConvexPolygon * a,
+	ConvexPolygon * b,
+	float2 offset)
+{
+	ConvexPolygon * polygons[2] = { a, b };
+	ConvexPolygon * others[2] = { b, a };
+
+	// Where the other piece sits relative to each one.
+	float2 offsets[2] = { offset, float2(-offset.x, -offset.y) };
+
+	for (int side = 0; side < 2; side++)
+	{
+		std::vector<float2> & vertices = polygons[side]->vertices;
+		std::vector<float2> & otherVertices = others[side]->vertices;
+
+		for (size_t edge = 0; edge < vertices.size(); edge++)
+		{
+			float2 start = vertices[edge];
+			float2 end = vertices[(edge + 1) % vertices.size()];
+
+			// Counter-clockwise, so this points out of the piece.
+			float2 normal(end.y - start.y, start.x - end.x);
+
+			float fEdge =
+				(start.x - offsets[side].x) * normal.x +
+				(start.y - offsets[side].y) * normal.y;
+
+			float fNearest = FLT_MAX;
+
+			for (size_t i = 0; i < otherVertices.size(); i++)
+			{
+				float fProjection = otherVertices[i].x * normal.x + otherVertices[i].y * normal.y;
+
+				if (fProjection < fNearest)
+				{
+					fNearest = fProjection;
+				}
+			}
+
+			// Touching is not overlapping; the slack stays well below
+			//	a pixel.
+			if (fNearest >= fEdge - 1.0e-4f)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
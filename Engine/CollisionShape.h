@@ -0,0 +1,74 @@
+#pragma once
+#include "pch.h"
+#include "CollisionMask.h"
+#include "BoundingBox.h"
+#include <vector>
+
+// One convex piece of an outline, counter-clockwise.
+struct ConvexPolygon
+{
+	std::vector<float2> vertices;
+	BoundingBox bounds;
+};
+
+// The opaque part of a texture as a few convex polygons, so that
+//	two sprites can be tested with the separating axis theorem
+//	instead of pixel by pixel. Built once per texture at load from
+//	the alpha mask, then scaled to the rendered size like the
+//	packed masks.
+class CollisionShape
+{
+public:
+	CollisionShape();
+
+	// Traces the outline of every opaque region with marching
+	//	squares, simplifies it with Douglas-Peucker so that no point
+	//	of the outline moves more than fTolerance texels, and splits
+	//	it into convex pieces. Holes are filled in.
+	static CollisionShape FromMask(CollisionMask * mask, float fTolerance);
+
+	// The same shape stretched from the mask's size to width x height.
+	CollisionShape Scale(int width, int height);
+
+	int GetWidth()
+	{
+		return m_nWidth;
+	}
+
+	int GetHeight()
+	{
+		return m_nHeight;
+	}
+
+	int GetNumPieces()
+	{
+		return (int)m_pieces.size();
+	}
+
+	ConvexPolygon * GetPiece(int index)
+	{
+		return &m_pieces[index];
+	}
+
+	// Whether any piece of a overlaps any piece of b. Both shapes
+	//	must be at the same scale; the top-left corners are in
+	//	screen pixels. Shapes that only touch do not overlap.
+	static bool Overlap(
+		CollisionShape * a,
+		int * aTopLeft,
+		CollisionShape * b,
+		int * bTopLeft);
+
+protected:
+
+private:
+	static bool Separated(
+		ConvexPolygon * a,
+		ConvexPolygon * b,
+		float2 offset);
+
+	int m_nWidth;
+	int m_nHeight;
+
+	std::vector<ConvexPolygon> m_pieces;
+};
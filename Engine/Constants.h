@@ -196,6 +196,365 @@
 #define INTERSECTION_BOTTOM 3
 #endif // INTERSECTION_BOTTOM
 
+#ifndef NARROW_PHASE_PER_PIXEL
+#define NARROW_PHASE_PER_PIXEL 0
+#endif // NARROW_PHASE_PER_PIXEL
+
+#ifndef NARROW_PHASE_PACKED
+#define NARROW_PHASE_PACKED 1
+#endif // NARROW_PHASE_PACKED
+
+#ifndef NARROW_PHASE_ALPHA
+#define NARROW_PHASE_ALPHA 2
+#endif // NARROW_PHASE_ALPHA
+
+#ifndef NARROW_PHASE_HIERARCHY
+#define NARROW_PHASE_HIERARCHY 3
+#endif // NARROW_PHASE_HIERARCHY
+
+// Convex outlines traced from the alpha, tested with the separating
+//	axis theorem. Close to, but not exactly, the pixel paths.
+#ifndef NARROW_PHASE_POLYGON
+#define NARROW_PHASE_POLYGON 4
+#endif // NARROW_PHASE_POLYGON
+
+// Signed distance fields sampled at the outline points of each
+//	sprite; also gives the depth and direction to push the player out.
+#ifndef NARROW_PHASE_DISTANCE_FIELD
+#define NARROW_PHASE_DISTANCE_FIELD 5
+#endif // NARROW_PHASE_DISTANCE_FIELD
+
+// Cells along the longer side of a texture's distance field.
+#ifndef DISTANCE_FIELD_RESOLUTION
+#define DISTANCE_FIELD_RESOLUTION 32
+#endif // DISTANCE_FIELD_RESOLUTION
+
+// Pairs tested by one job of ParallelNarrowPhase.
+#ifndef PARALLEL_NARROW_PHASE_CHUNK
+#define PARALLEL_NARROW_PHASE_CHUNK 64
+#endif // PARALLEL_NARROW_PHASE_CHUNK
+
+// How far, in texels, a traced outline may stray from the alpha.
+#ifndef POLYGON_TOLERANCE
+#define POLYGON_TOLERANCE 1.0f
+#endif // POLYGON_TOLERANCE
+
+// Texels per side of the finest coverage block.
+#ifndef COVERAGE_BLOCK_SIZE
+#define COVERAGE_BLOCK_SIZE 8
+#endif // COVERAGE_BLOCK_SIZE
+
+// Regions with this many rows or fewer are compared bit by bit.
+#ifndef COVERAGE_DIRECT_ROWS
+#define COVERAGE_DIRECT_ROWS 64
+#endif // COVERAGE_DIRECT_ROWS
+
+#ifndef COVERAGE_ANY
+#define COVERAGE_ANY 1
+#endif // COVERAGE_ANY
+
+#ifndef COVERAGE_ALL
+#define COVERAGE_ALL 2
+#endif // COVERAGE_ALL
+
+#ifndef COVERAGE_NONE
+#define COVERAGE_NONE 4
+#endif // COVERAGE_NONE
+
+#ifndef COLLISION_KERNEL_SCALAR
+#define COLLISION_KERNEL_SCALAR 0
+#endif // COLLISION_KERNEL_SCALAR
+
+#ifndef COLLISION_KERNEL_SSE2
+#define COLLISION_KERNEL_SSE2 1
+#endif // COLLISION_KERNEL_SSE2
+
+#ifndef COLLISION_KERNEL_AVX2
+#define COLLISION_KERNEL_AVX2 2
+#endif // COLLISION_KERNEL_AVX2
+
+#ifndef AABB_TREE_NULL_NODE
+#define AABB_TREE_NULL_NODE -1
+#endif // AABB_TREE_NULL_NODE
+
+// Pixels added on every side of a proxy's box.
+#ifndef AABB_TREE_MARGIN
+#define AABB_TREE_MARGIN 4.0f
+#endif // AABB_TREE_MARGIN
+
+// How many frames of movement the fat box is stretched by.
+#ifndef AABB_TREE_DISPLACEMENT_MULTIPLIER
+#define AABB_TREE_DISPLACEMENT_MULTIPLIER 4.0f
+#endif // AABB_TREE_DISPLACEMENT_MULTIPLIER
+
+// Moved proxies paired up by one job of the threaded QueryPairs.
+#ifndef AABB_TREE_PAIR_CHUNK
+#define AABB_TREE_PAIR_CHUNK 64
+#endif // AABB_TREE_PAIR_CHUNK
+
+// Collision layers. Each sprite is on one layer; the matrix in
+//	CollisionLayers says which layers are tested against each other.
+#ifndef COLLISION_LAYER_PLAYER
+#define COLLISION_LAYER_PLAYER 0
+#endif // COLLISION_LAYER_PLAYER
+
+#ifndef COLLISION_LAYER_OBSTACLE
+#define COLLISION_LAYER_OBSTACLE 1
+#endif // COLLISION_LAYER_OBSTACLE
+
+#ifndef COLLISION_LAYER_DECORATION
+#define COLLISION_LAYER_DECORATION 2
+#endif // COLLISION_LAYER_DECORATION
+
+#ifndef COLLISION_LAYER_WATER
+#define COLLISION_LAYER_WATER 3
+#endif // COLLISION_LAYER_WATER
+
+#ifndef COLLISION_LAYER_PICKUP
+#define COLLISION_LAYER_PICKUP 4
+#endif // COLLISION_LAYER_PICKUP
+
+#ifndef COLLISION_LAYER_TRIGGER
+#define COLLISION_LAYER_TRIGGER 5
+#endif // COLLISION_LAYER_TRIGGER
+
+#ifndef COLLISION_LAYER_ENEMY
+#define COLLISION_LAYER_ENEMY 6
+#endif // COLLISION_LAYER_ENEMY
+
+#ifndef NUM_COLLISION_LAYERS
+#define NUM_COLLISION_LAYERS 8
+#endif // NUM_COLLISION_LAYERS
+
+#ifndef COLLISION_MASK_ALL
+#define COLLISION_MASK_ALL 0xFFFFFFFFu
+#endif // COLLISION_MASK_ALL
+
+// Kinds of TriggerIndex region. A removed region is TRIGGER_NONE.
+#ifndef TRIGGER_NONE
+#define TRIGGER_NONE -1
+#endif // TRIGGER_NONE
+
+#ifndef TRIGGER_EXIT
+#define TRIGGER_EXIT 0
+#endif // TRIGGER_EXIT
+
+#ifndef TRIGGER_DOOR
+#define TRIGGER_DOOR 1
+#endif // TRIGGER_DOOR
+
+#ifndef TRIGGER_PICKUP
+#define TRIGGER_PICKUP 2
+#endif // TRIGGER_PICKUP
+
+#ifndef NUM_TRIGGER_TYPES
+#define NUM_TRIGGER_TYPES 3
+#endif // NUM_TRIGGER_TYPES
+
+// How far from the edge, as a ratio of the screen, the player
+//	starts on the next screen. Off the edge, so that the exit
+//	behind them does not take them straight back.
+#ifndef SCREEN_ENTRY_INSET
+#define SCREEN_ENTRY_INSET 0.01f
+#endif // SCREEN_ENTRY_INSET
+
+// Tile ids of a TileMap; TileMap.cpp has what each one does.
+#ifndef TILE_NONE
+#define TILE_NONE 0
+#endif // TILE_NONE
+
+#ifndef TILE_TREE
+#define TILE_TREE 1
+#endif // TILE_TREE
+
+#ifndef NUM_TILE_TYPES
+#define NUM_TILE_TYPES 2
+#endif // NUM_TILE_TYPES
+
+// Layers of a TileMap, bottom first.
+#ifndef TILE_LAYER_GROUND
+#define TILE_LAYER_GROUND 0
+#endif // TILE_LAYER_GROUND
+
+#ifndef TILE_LAYER_OBJECT
+#define TILE_LAYER_OBJECT 1
+#endif // TILE_LAYER_OBJECT
+
+#ifndef NUM_TILE_LAYERS
+#define NUM_TILE_LAYERS 2
+#endif // NUM_TILE_LAYERS
+
+// The size of the overworld, in screens, and where the player starts.
+#ifndef WORLD_NUM_COLUMNS
+#define WORLD_NUM_COLUMNS 64
+#endif // WORLD_NUM_COLUMNS
+
+#ifndef WORLD_NUM_ROWS
+#define WORLD_NUM_ROWS 64
+#endif // WORLD_NUM_ROWS
+
+#ifndef WORLD_START_COLUMN
+#define WORLD_START_COLUMN 32
+#endif // WORLD_START_COLUMN
+
+#ifndef WORLD_START_ROW
+#define WORLD_START_ROW 32
+#endif // WORLD_START_ROW
+
+// Bytes of screens World keeps cached.
+#ifndef WORLD_CACHE_BUDGET
+#define WORLD_CACHE_BUDGET (64 * 1024)
+#endif // WORLD_CACHE_BUDGET
+
+// How close to an edge, as a ratio of the screen, the player gets
+//	before the screen past it is prefetched.
+#ifndef WORLD_PREFETCH_RATIO
+#define WORLD_PREFETCH_RATIO 0.25f
+#endif // WORLD_PREFETCH_RATIO
+
+// "MAP1", the first bytes of a MapFile.
+#ifndef MAP_FILE_MAGIC
+#define MAP_FILE_MAGIC 0x3150414Du
+#endif // MAP_FILE_MAGIC
+
+// Goes up whenever the layout of a MapFile changes.
+#ifndef MAP_FILE_VERSION
+#define MAP_FILE_VERSION 1
+#endif // MAP_FILE_VERSION
+
+// Kinds of object record in a MapFile.
+#ifndef MAP_OBJECT_DOOR
+#define MAP_OBJECT_DOOR 0
+#endif // MAP_OBJECT_DOOR
+
+#ifndef MAP_OBJECT_PICKUP
+#define MAP_OBJECT_PICKUP 1
+#endif // MAP_OBJECT_PICKUP
+
+#ifndef NUM_MAP_OBJECT_TYPES
+#define NUM_MAP_OBJECT_TYPES 2
+#endif // NUM_MAP_OBJECT_TYPES
+
+// 64-bit words of an OccupancyBitboard; enough for
+//	NUM_GRID_COLUMNS x NUM_GRID_ROWS bits.
+#ifndef OCCUPANCY_WORDS
+#define OCCUPANCY_WORDS ((NUM_GRID_COLUMNS * NUM_GRID_ROWS + 63) / 64)
+#endif // OCCUPANCY_WORDS
+
+#ifndef NEIGHBOUR_NORTH
+#define NEIGHBOUR_NORTH 0x01
+#endif // NEIGHBOUR_NORTH
+
+#ifndef NEIGHBOUR_NORTH_EAST
+#define NEIGHBOUR_NORTH_EAST 0x02
+#endif // NEIGHBOUR_NORTH_EAST
+
+#ifndef NEIGHBOUR_EAST
+#define NEIGHBOUR_EAST 0x04
+#endif // NEIGHBOUR_EAST
+
+#ifndef NEIGHBOUR_SOUTH_EAST
+#define NEIGHBOUR_SOUTH_EAST 0x08
+#endif // NEIGHBOUR_SOUTH_EAST
+
+#ifndef NEIGHBOUR_SOUTH
+#define NEIGHBOUR_SOUTH 0x10
+#endif // NEIGHBOUR_SOUTH
+
+#ifndef NEIGHBOUR_SOUTH_WEST
+#define NEIGHBOUR_SOUTH_WEST 0x20
+#endif // NEIGHBOUR_SOUTH_WEST
+
+#ifndef NEIGHBOUR_WEST
+#define NEIGHBOUR_WEST 0x40
+#endif // NEIGHBOUR_WEST
+
+#ifndef NEIGHBOUR_NORTH_WEST
+#define NEIGHBOUR_NORTH_WEST 0x80
+#endif // NEIGHBOUR_NORTH_WEST
+
+// Entries in a CollisionPairCache; must be a power of two.
+#ifndef COLLISION_PAIR_CACHE_SIZE
+#define COLLISION_PAIR_CACHE_SIZE 1024
+#endif // COLLISION_PAIR_CACHE_SIZE
+
+// Slots looked at before a CollisionPairCache gives up or evicts.
+#ifndef COLLISION_PAIR_CACHE_PROBES
+#define COLLISION_PAIR_CACHE_PROBES 8
+#endif // COLLISION_PAIR_CACHE_PROBES
+
+// Candidates held inside a CollisionCandidates before it spills.
+#ifndef COLLISION_CANDIDATES_INLINE
+#define COLLISION_CANDIDATES_INLINE 16
+#endif // COLLISION_CANDIDATES_INLINE
+
+// Contact normals held inside a DirectionalCollsionDetectionInfo
+//	before it spills.
+#ifndef DIRECTIONAL_CONTACTS_INLINE
+#define DIRECTIONAL_CONTACTS_INLINE 8
+#endif // DIRECTIONAL_CONTACTS_INLINE
+
+// Broad phases a RuntimeCollisionPipeline can switch between.
+#ifndef BROAD_PHASE_GRID
+#define BROAD_PHASE_GRID 0
+#endif // BROAD_PHASE_GRID
+
+#ifndef BROAD_PHASE_CORNER
+#define BROAD_PHASE_CORNER 1
+#endif // BROAD_PHASE_CORNER
+
+#ifndef BROAD_PHASE_MIDPOINT
+#define BROAD_PHASE_MIDPOINT 2
+#endif // BROAD_PHASE_MIDPOINT
+
+#ifndef BROAD_PHASE_CIRCULAR_ZONE
+#define BROAD_PHASE_CIRCULAR_ZONE 3
+#endif // BROAD_PHASE_CIRCULAR_ZONE
+
+#ifndef BROAD_PHASE_SPRITE_OVERLAP
+#define BROAD_PHASE_SPRITE_OVERLAP 4
+#endif // BROAD_PHASE_SPRITE_OVERLAP
+
+#ifndef NUM_BROAD_PHASES
+#define NUM_BROAD_PHASES 5
+#endif // NUM_BROAD_PHASES
+
+#ifndef COLLISION_EVENT_ENTER
+#define COLLISION_EVENT_ENTER 0
+#endif // COLLISION_EVENT_ENTER
+
+#ifndef COLLISION_EVENT_STAY
+#define COLLISION_EVENT_STAY 1
+#endif // COLLISION_EVENT_STAY
+
+#ifndef COLLISION_EVENT_EXIT
+#define COLLISION_EVENT_EXIT 2
+#endif // COLLISION_EVENT_EXIT
+
+// Sprites CollisionQuery takes from one grid space at a time.
+#ifndef COLLISION_QUERY_BATCH
+#define COLLISION_QUERY_BATCH 16
+#endif // COLLISION_QUERY_BATCH
+
+// Scratch memory for one frame of collision detection.
+#ifndef FRAME_ARENA_SIZE
+#define FRAME_ARENA_SIZE (64 * 1024)
+#endif // FRAME_ARENA_SIZE
+
+//#ifndef LOG_COLLISION_EVENTS
+//#define LOG_COLLISION_EVENTS
+//#endif // LOG_COLLISION_EVENTS
+
+//#ifndef BENCHMARK_COLLISION
+//#define BENCHMARK_COLLISION
+//#endif // BENCHMARK_COLLISION
+
+// Writes the built-in overworld to overworld.map in the local folder
+//	at startup, to be copied over the one in the project.
+//#ifndef WRITE_MAP_FILE
+//#define WRITE_MAP_FILE
+//#endif // WRITE_MAP_FILE
+
 #ifndef RENDER_DIAGNOSTICS
 #define RENDER_DIAGNOSTICS
 #endif // RENDER_DIAGNOSTICS
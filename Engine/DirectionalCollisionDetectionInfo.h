@@ -1,10 +1,139 @@
 #pragma once
 #include "pch.h"
 #include "CollisionDetectionInfo.h"
+#include "Constants.h"
+#include "SmallVector.h"
 
+// Contacts between the player and every obstacle it collides with,
+//	gathered in one pass over the broad phase candidates.
 class DirectionalCollsionDetectionInfo : public CollisionDetectionInfo
 {
 public:
+	DirectionalCollsionDetectionInfo()
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		nContacts = 0;
+		normals.clear();
+
+		for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+		{
+			penetration[axis] = 0.0f;
+		}
+	}
+
+	// depth is in screen pixels along the axis (HORIZONTAL_AXIS or
+	//	VERTICAL_AXIS) of least overlap; direction is +1 or -1 and
+	//	points from the obstacle towards the player.
+	void AddContact(int axis, float depth, float direction)
+	{
+		if (depth > fabs(penetration[axis]))
+		{
+			penetration[axis] = depth * direction;
+		}
+
+		float2 contactNormal(0.0f, 0.0f);
+
+		if (axis == HORIZONTAL_AXIS)
+		{
+			contactNormal.x = direction;
+		}
+		else
+		{
+			contactNormal.y = direction;
+		}
+
+		normals.push_back(contactNormal);
+		nContacts++;
+	}
+
+	// A contact along any direction, such as the push-out of a
+	//	distance field. direction is unit length and points from the
+	//	obstacle towards the player; depth is in screen pixels.
+	void AddContact(float2 direction, float depth)
+	{
+		float components[NUM_DIMENSIONS] = { direction.x, direction.y };
+
+		for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+		{
+			float axisDepth = depth * components[axis];
+
+			if (fabs(axisDepth) > fabs(penetration[axis]))
+			{
+				penetration[axis] = axisDepth;
+			}
+		}
+
+		normals.push_back(direction);
+		nContacts++;
+	}
+
+	// True if moving by (dx, dy) would push further into any one of
+	//	the contacts. Each is tested on its own, as the normals of
+	//	walls on opposite sides would cancel out in a sum. Movement
+	//	along a wall is allowed, so the player slides.
+	bool IsBlocked(float dx, float dy)
+	{
+		SmallVector<float2, DIRECTIONAL_CONTACTS_INLINE>::const_iterator iterator;
+
+		for (iterator = normals.begin(); iterator != normals.end(); iterator++)
+		{
+			if (dx * iterator->x + dy * iterator->y < 0.0f)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// The move (dx, dy), in pixels, with the part that heads into
+	//	each contact taken out. What is left runs along the walls,
+	//	slanted ones included, so the player slides instead of stopping.
+	float2 Slide(float2 move)
+	{
+		SmallVector<float2, DIRECTIONAL_CONTACTS_INLINE>::const_iterator iterator;
+
+		for (iterator = normals.begin(); iterator != normals.end(); iterator++)
+		{
+			float into = dot(move, *iterator);
+
+			if (into < 0.0f)
+			{
+				move = move - *iterator * into;
+			}
+		}
+
+		// Wedged between contacts, nothing is left of the move. The
+		//	tolerance is for the rounding of the slides above.
+		for (iterator = normals.begin(); iterator != normals.end(); iterator++)
+		{
+			if (dot(move, *iterator) < -0.001f)
+			{
+				return float2(0.0f, 0.0f);
+			}
+		}
+
+		return move;
+	}
+
+	// How far, in pixels, to move the player so that it no longer
+	//	overlaps the deepest contact on either axis.
+	float2 GetSeparation()
+	{
+		return float2(penetration[HORIZONTAL_AXIS], penetration[VERTICAL_AXIS]);
+	}
+
+	// Deepest penetration on each axis, signed like the normals.
+	float penetration[NUM_DIMENSIONS];
+
+	// The normal of every contact, pointing towards the player.
+	SmallVector<float2, DIRECTIONAL_CONTACTS_INLINE> normals;
+
+	int nContacts;
 
 protected:
 
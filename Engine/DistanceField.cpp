@@ -0,0 +1,386 @@
+#include "pch.h"
+#include "DistanceField.h"
+#include "Constants.h"
+#include <algorithm>
+#include <math.h>
+
+// Stands in for "no such cell" in the squared distances.
+#define DISTANCE_FIELD_INFINITY 1e20f
+
+DistanceField::DistanceField()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_fCellsAcross = 0.0f;
+	m_fCellsDown = 0.0f;
+}
+
+DistanceField DistanceField::FromMask(CollisionMask * mask, int nResolution)
+{
+	DistanceField retVal;
+
+	int maskWidth = mask->GetWidth();
+	int maskHeight = mask->GetHeight();
+
+	if (maskWidth <= 0 || maskHeight <= 0 || nResolution <= 0)
+	{
+		return retVal;
+	}
+
+	int cellSize = ((std::max)(maskWidth, maskHeight) + nResolution - 1) / nResolution;
+
+	retVal.m_fCellsAcross = (float)maskWidth / (float)cellSize;
+	retVal.m_fCellsDown = (float)maskHeight / (float)cellSize;
+
+	// One empty cell all round, so that every opaque region has an
+	//	outline even where it touches the edge of the texture.
+	int width = (maskWidth + cellSize - 1) / cellSize + 2;
+	int height = (maskHeight + cellSize - 1) / cellSize + 2;
+
+	retVal.m_nWidth = width;
+	retVal.m_nHeight = height;
+
+	std::vector<bool> inside(width * height, false);
+
+	for (int row = 1; row < height - 1; row++)
+	{
+		for (int column = 1; column < width - 1; column++)
+		{
+			int left = (column - 1) * cellSize;
+			int top = (row - 1) * cellSize;
+			int right = (std::min)(left + cellSize, maskWidth);
+			int bottom = (std::min)(top + cellSize, maskHeight);
+
+			int nOpaque = 0;
+
+			for (int y = top; y < bottom; y++)
+			{
+				for (int x = left; x < right; x++)
+				{
+					if (mask->IsOpaque(x, y))
+					{
+						nOpaque++;
+					}
+				}
+			}
+
+			inside[row * width + column] = 2 * nOpaque >= (right - left) * (bottom - top);
+		}
+	}
+
+	std::vector<float> toInside;
+	std::vector<float> toOutside;
+
+	SquaredDistances(inside, width, height, true, &toInside);
+	SquaredDistances(inside, width, height, false, &toOutside);
+
+	// The outline runs half a cell from the centres on either side of it.
+	retVal.m_distances.resize(width * height);
+
+	for (int i = 0; i < width * height; i++)
+	{
+		if (inside[i])
+		{
+			retVal.m_distances[i] = 0.5f - sqrtf(toOutside[i]);
+		}
+		else
+		{
+			retVal.m_distances[i] = sqrtf(toInside[i]) - 0.5f;
+		}
+	}
+
+	for (int row = 1; row < height - 1; row++)
+	{
+		for (int column = 1; column < width - 1; column++)
+		{
+			int index = row * width + column;
+
+			if (inside[index] &&
+				(!inside[index - 1] || !inside[index + 1] || !inside[index - width] || !inside[index + width]))
+			{
+				retVal.m_boundary.push_back(float2(
+					(column - 0.5f) / retVal.m_fCellsAcross,
+					(row - 0.5f) / retVal.m_fCellsDown));
+			}
+		}
+	}
+
+	return retVal;
+}
+
+float DistanceField::Sample(float u, float v, float2 * gradient)
+{
+	// Cell centres sit at whole cells plus a half, one cell in
+	//	from the edge of the field because of the border.
+	float x = u * m_fCellsAcross + 0.5f;
+	float y = v * m_fCellsDown + 0.5f;
+
+	x = (std::max)(0.0f, (std::min)(x, (float)(m_nWidth - 1)));
+	y = (std::max)(0.0f, (std::min)(y, (float)(m_nHeight - 1)));
+
+	int column = (std::min)((int)x, m_nWidth - 2);
+	int row = (std::min)((int)y, m_nHeight - 2);
+
+	float tx = x - column;
+	float ty = y - row;
+
+	const float * top = &m_distances[row * m_nWidth + column];
+	const float * bottom = top + m_nWidth;
+
+	if (gradient != NULL)
+	{
+		gradient->x = (1.0f - ty) * (top[1] - top[0]) + ty * (bottom[1] - bottom[0]);
+		gradient->y = (1.0f - tx) * (bottom[0] - top[0]) + tx * (bottom[1] - top[1]);
+	}
+
+	return
+		(1.0f - ty) * ((1.0f - tx) * top[0] + tx * top[1]) +
+		ty * ((1.0f - tx) * bottom[0] + tx * bottom[1]);
+}
+
+bool DistanceField::Overlap(
+	DistanceField * a,
+	int * aTopLeft,
+	DistanceField * b,
+	int * bTopLeft,
+	int width,
+	int height,
+	DistanceFieldContact * contact)
+{
+	float2 aNormal;
+	float2 bNormal;
+
+	// Without a contact to fill in, any point inside will do.
+	bool bFirst = contact == NULL;
+
+	float aDepth = Penetration(a, aTopLeft, b, bTopLeft, width, height, bFirst, &aNormal);
+
+	if (bFirst && aDepth > 0.0f)
+	{
+		return true;
+	}
+
+	float bDepth = Penetration(b, bTopLeft, a, aTopLeft, width, height, bFirst, &bNormal);
+
+	if (aDepth <= 0.0f && bDepth <= 0.0f)
+	{
+		return false;
+	}
+
+	if (contact != NULL)
+	{
+		// A point of b inside a pushes a the other way.
+		if (aDepth >= bDepth)
+		{
+			contact->depth = aDepth;
+			contact->normal = aNormal;
+		}
+		else
+		{
+			contact->depth = bDepth;
+			contact->normal = float2(-bNormal.x, -bNormal.y);
+		}
+	}
+
+	return true;
+}
+
+float DistanceField::Penetration(
+	DistanceField * a,
+	int * aTopLeft,
+	DistanceField * b,
+	int * bTopLeft,
+	int width,
+	int height,
+	bool bFirst,
+	float2 * normal)
+{
+	float retVal = 0.0f;
+
+	*normal = float2(0.0f, 0.0f);
+
+	if (a->IsEmpty() || b->IsEmpty())
+	{
+		return retVal;
+	}
+
+	// Screen pixels per cell of b.
+	float scaleX = (float)width / b->m_fCellsAcross;
+	float scaleY = (float)height / b->m_fCellsDown;
+
+	// The outline points of a are cell centres, half a cell of a
+	//	inside its true outline.
+	float inset = 0.5f * (std::min)(
+		(float)width / a->m_fCellsAcross,
+		(float)height / a->m_fCellsDown);
+
+	float offsetU = (float)(aTopLeft[HORIZONTAL_AXIS] - bTopLeft[HORIZONTAL_AXIS]) / (float)width;
+	float offsetV = (float)(aTopLeft[VERTICAL_AXIS] - bTopLeft[VERTICAL_AXIS]) / (float)height;
+
+	// The points are in rows from the top, so the ones above b can
+	//	be skipped in one go, and the loop can stop below it.
+	std::vector<float2>::const_iterator iterator = std::upper_bound(
+		a->m_boundary.begin(),
+		a->m_boundary.end(),
+		-offsetV,
+		[](float v, const float2 & point) { return v < point.y; });
+
+	for (; iterator != a->m_boundary.end(); iterator++)
+	{
+		float u = iterator->x + offsetU;
+		float v = iterator->y + offsetV;
+
+		if (v >= 1.0f)
+		{
+			break;
+		}
+
+		if (u <= 0.0f || u >= 1.0f)
+		{
+			continue;
+		}
+
+		float2 gradient;
+		float distance = b->Sample(u, v, &gradient);
+
+		// Cheap test first: nothing can be inside that is further out
+		//	than the inset at the coarser of the two scales.
+		if (distance * (std::min)(scaleX, scaleY) >= inset)
+		{
+			continue;
+		}
+
+		// The field is in cells, which are not square on screen unless
+		//	the sprite is drawn at its own aspect ratio, so take the
+		//	cell size along the gradient.
+		float length = sqrtf(gradient.x * gradient.x + gradient.y * gradient.y);
+
+		float depth;
+		float2 direction;
+
+		if (length > 0.0f)
+		{
+			float nx = gradient.x / length;
+			float ny = gradient.y / length;
+
+			depth = inset - distance * sqrtf(nx * scaleX * nx * scaleX + ny * scaleY * ny * scaleY);
+
+			// Normals go the other way to points under scaling.
+			direction = float2(nx / scaleX, ny / scaleY);
+			float directionLength = sqrtf(direction.x * direction.x + direction.y * direction.y);
+			direction = float2(direction.x / directionLength, direction.y / directionLength);
+		}
+		else
+		{
+			depth = inset - distance * (std::min)(scaleX, scaleY);
+			direction = float2(0.0f, 0.0f);
+		}
+
+		if (depth > retVal)
+		{
+			retVal = depth;
+			*normal = direction;
+
+			if (bFirst)
+			{
+				break;
+			}
+		}
+	}
+
+	return retVal;
+}
+
+void DistanceField::SquaredDistances(
+	const std::vector<bool> & inside,
+	int width,
+	int height,
+	bool bInside,
+	std::vector<float> * retVal)
+{
+	retVal->resize(width * height);
+
+	for (int i = 0; i < width * height; i++)
+	{
+		(*retVal)[i] = inside[i] == bInside ? 0.0f : DISTANCE_FIELD_INFINITY;
+	}
+
+	int n = (std::max)(width, height);
+
+	std::vector<float> scratch(n);
+	std::vector<float> envelope(n + 1);
+	std::vector<int> locations(n);
+
+	// The 2D transform is the 1D one down every column, then
+	//	along every row of the result.
+	for (int column = 0; column < width; column++)
+	{
+		Transform(&(*retVal)[column], height, width, &scratch[0], &envelope[0], &locations[0]);
+	}
+
+	for (int row = 0; row < height; row++)
+	{
+		Transform(&(*retVal)[row * width], width, 1, &scratch[0], &envelope[0], &locations[0]);
+	}
+}
+
+namespace
+{
+	// Where the parabolas rooted at p and q cross.
+	float Intersection(const float * values, int p, int q)
+	{
+		return ((values[q] + q * q) - (values[p] + p * p)) / (2.0f * (q - p));
+	}
+}
+
+// Lower envelope of the parabolas rooted at each value.
+// @see http://cs.brown.edu/people/pfelzens/papers/dt-final.pdf
+void DistanceField::Transform(
+	float * values,
+	int n,
+	int stride,
+	float * scratch,
+	float * envelope,
+	int * locations)
+{
+	for (int q = 0; q < n; q++)
+	{
+		scratch[q] = values[q * stride];
+	}
+
+	int k = 0;
+
+	locations[0] = 0;
+	envelope[0] = -DISTANCE_FIELD_INFINITY;
+	envelope[1] = DISTANCE_FIELD_INFINITY;
+
+	for (int q = 1; q < n; q++)
+	{
+		float s = Intersection(scratch, locations[k], q);
+
+		while (s <= envelope[k])
+		{
+			k--;
+			s = Intersection(scratch, locations[k], q);
+		}
+
+		k++;
+		locations[k] = q;
+		envelope[k] = s;
+		envelope[k + 1] = DISTANCE_FIELD_INFINITY;
+	}
+
+	k = 0;
+
+	for (int q = 0; q < n; q++)
+	{
+		while (envelope[k + 1] < q)
+		{
+			k++;
+		}
+
+		int p = locations[k];
+
+		values[q * stride] = (float)((q - p) * (q - p)) + scratch[p];
+	}
+}
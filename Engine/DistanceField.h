@@ -0,0 +1,114 @@
+#pragma once
+#include "pch.h"
+#include "CollisionMask.h"
+#include <vector>
+
+// Deepest point where two sprites overlap, in screen pixels.
+//	normal points from the obstacle towards the player, so moving
+//	the player by depth along it separates the two.
+struct DistanceFieldContact
+{
+	float depth;
+	float2 normal;
+};
+
+// Coarse signed distance to the outline of a texture's opaque
+//	texels, negative inside. Built once per texture at load, at a
+//	few cells per side, and sampled at any rendered size, so unlike
+//	the packed masks it never has to be rebuilt on a resize.
+//	Also keeps the centres of the cells on the outline, which are
+//	the only points a pair test has to look at.
+class DistanceField
+{
+public:
+	DistanceField();
+
+	// Splits the mask into cells no more than nResolution to a side;
+	//	a cell is inside if at least half of its texels are opaque.
+	//	The distances come from the exact Euclidean distance
+	//	transform of Felzenszwalb and Huttenlocher, which is linear
+	//	in the number of cells.
+	static DistanceField FromMask(CollisionMask * mask, int nResolution);
+
+	int GetWidth()
+	{
+		return m_nWidth;
+	}
+
+	int GetHeight()
+	{
+		return m_nHeight;
+	}
+
+	bool IsEmpty()
+	{
+		return m_boundary.empty();
+	}
+
+	// Bilinear distance at (u, v), both 0 to 1 across the texture,
+	//	in cells. gradient, if not NULL, gets the direction of
+	//	increasing distance, in cells, not normalised.
+	float Sample(float u, float v, float2 * gradient);
+
+	// Tests the outline points of each sprite against the field of
+	//	the other. Both sprites are rendered at width x height with
+	//	their top-left corners in screen pixels. Fills contact, if
+	//	not NULL, with the deepest point found.
+	static bool Overlap(
+		DistanceField * a,
+		int * aTopLeft,
+		DistanceField * b,
+		int * bTopLeft,
+		int width,
+		int height,
+		DistanceFieldContact * contact);
+
+protected:
+
+private:
+	// One pass of the 1D transform over n values spaced stride
+	//	apart; squared distances in, squared distances out.
+	static void Transform(
+		float * values,
+		int n,
+		int stride,
+		float * scratch,
+		float * envelope,
+		int * locations);
+
+	// Squared distance from every cell to the nearest cell whose
+	//	inside flag equals bInside.
+	static void SquaredDistances(
+		const std::vector<bool> & inside,
+		int width,
+		int height,
+		bool bInside,
+		std::vector<float> * retVal);
+
+	// Deepest point of a's outline inside b, in screen pixels, or
+	//	the first one found if bFirst. Returns the depth; 0 means
+	//	nothing of a is inside b.
+	static float Penetration(
+		DistanceField * a,
+		int * aTopLeft,
+		DistanceField * b,
+		int * bTopLeft,
+		int width,
+		int height,
+		bool bFirst,
+		float2 * normal);
+
+	// Cells per side, including the empty border all round.
+	int m_nWidth;
+	int m_nHeight;
+
+	// Cells across and down the texture itself, not counting the
+	//	border; the last cell on each side may be cut short.
+	float m_fCellsAcross;
+	float m_fCellsDown;
+
+	std::vector<float> m_distances;
+
+	// Outline cell centres, 0 to 1 across the texture.
+	std::vector<float2> m_boundary;
+};
@@ -0,0 +1,583 @@
+#include "pch.h"
+#include "DynamicAabbTree.h"
+#include <algorithm>
+
+DynamicAabbTree::DynamicAabbTree()
+{
+	m_nRoot = AABB_TREE_NULL_NODE;
+	m_nFreeList = AABB_TREE_NULL_NODE;
+	m_nProxyCount = 0;
+}
+
+void DynamicAabbTree::Clear()
+{
+	m_nodes.clear();
+	m_moved.clear();
+
+	m_nRoot = AABB_TREE_NULL_NODE;
+	m_nFreeList = AABB_TREE_NULL_NODE;
+	m_nProxyCount = 0;
+}
+
+int DynamicAabbTree::CreateProxy(const BoundingBox & box, void * userData)
+{
+	int proxyId = AllocateNode();
+	Node & node = m_nodes[proxyId];
+
+	node.box = box;
+	node.box.lowerBound.x -= AABB_TREE_MARGIN;
+	node.box.lowerBound.y -= AABB_TREE_MARGIN;
+	node.box.upperBound.x += AABB_TREE_MARGIN;
+	node.box.upperBound.y += AABB_TREE_MARGIN;
+	node.userData = userData;
+	node.height = 0;
+
+	InsertLeaf(proxyId);
+
+	m_nProxyCount++;
+	MarkMoved(proxyId);
+
+	return proxyId;
+}
+
+void DynamicAabbTree::DestroyProxy(int proxyId)
+{
+	// Listed at most once, so this takes it out of the pairs.
+	if (m_nodes[proxyId].bMoved)
+	{
+		m_moved.erase(std::find(m_moved.begin(), m_moved.end(), proxyId));
+	}
+
+	RemoveLeaf(proxyId);
+	FreeNode(proxyId);
+
+	m_nProxyCount--;
+}
+
+bool DynamicAabbTree::MoveProxy(int proxyId, const BoundingBox & box, float2 displacement)
+{
+	if (m_nodes[proxyId].box.Contains(box))
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxyId);
+
+	// Fatten the box, then stretch it in the direction of travel.
+	BoundingBox fatBox = box;
+	fatBox.lowerBound.x -= AABB_TREE_MARGIN;
+	fatBox.lowerBound.y -= AABB_TREE_MARGIN;
+	fatBox.upperBound.x += AABB_TREE_MARGIN;
+	fatBox.upperBound.y += AABB_TREE_MARGIN;
+
+	float dx = AABB_TREE_DISPLACEMENT_MULTIPLIER * displacement.x;
+	float dy = AABB_TREE_DISPLACEMENT_MULTIPLIER * displacement.y;
+
+	if (dx < 0.0f)
+	{
+		fatBox.lowerBound.x += dx;
+	}
+	else
+	{
+		fatBox.upperBound.x += dx;
+	}
+
+	if (dy < 0.0f)
+	{
+		fatBox.lowerBound.y += dy;
+	}
+	else
+	{
+		fatBox.upperBound.y += dy;
+	}
+
+	m_nodes[proxyId].box = fatBox;
+
+	InsertLeaf(proxyId);
+
+	MarkMoved(proxyId);
+
+	return true;
+}
+
+void DynamicAabbTree::Query(const BoundingBox & box, std::vector<int> * retVal)
+{
+	Query(box, &m_stack, retVal);
+}
+
+void DynamicAabbTree::Query(const BoundingBox & box, std::vector<int> * stack, std::vector<int> * retVal)
+{
+	if (m_nRoot == AABB_TREE_NULL_NODE)
+	{
+		return;
+	}
+
+	stack->clear();
+	stack->push_back(m_nRoot);
+
+	while (!stack->empty())
+	{
+		int nodeId = stack->back();
+		stack->pop_back();
+
+		const Node & node = m_nodes[nodeId];
+
+		if (!node.box.Overlaps(box))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			retVal->push_back(nodeId);
+		}
+		else
+		{
+			stack->push_back(node.child1);
+			stack->push_back(node.child2);
+		}
+	}
+}
+
+void DynamicAabbTree::QueryPairs(std::vector<std::pair<int, int>> * retVal)
+{
+	size_t nFirst = retVal->size();
+
+	for (size_t i = 0; i < m_moved.size(); i++)
+	{
+		AddPairs(m_moved[i], &m_stack, &m_overlapping, retVal);
+	}
+
+	ClearMoved();
+
+	SortPairs(retVal, nFirst);
+}
+
+void DynamicAabbTree::QueryPairs(std::vector<std::pair<int, int>> * retVal, WorkerPool * pool)
+{
+	size_t nFirst = retVal->size();
+
+	int nMoved = (int)m_moved.size();
+	int nChunks = (nMoved + AABB_TREE_PAIR_CHUNK - 1) / AABB_TREE_PAIR_CHUNK;
+
+	if ((int)m_chunkPairs.size() < nChunks)
+	{
+		m_chunkPairs.resize(nChunks);
+	}
+
+	if ((int)m_workerStacks.size() < pool->GetNumWorkers())
+	{
+		m_workerStacks.resize(pool->GetNumWorkers());
+		m_workerOverlapping.resize(pool->GetNumWorkers());
+	}
+
+	// Only reads the tree, so the chunks can run side by side.
+	pool->ParallelFor(nChunks, [this, nMoved](int nChunk, int nWorker)
+	{
+		std::vector<std::pair<int, int>> & pairs = m_chunkPairs[nChunk];
+		pairs.clear();
+
+		int nEnd = (std::min)((nChunk + 1) * AABB_TREE_PAIR_CHUNK, nMoved);
+
+		for (int i = nChunk * AABB_TREE_PAIR_CHUNK; i < nEnd; i++)
+		{
+			AddPairs(m_moved[i], &m_workerStacks[nWorker], &m_workerOverlapping[nWorker], &pairs);
+		}
+	});
+
+	for (int i = 0; i < nChunks; i++)
+	{
+		retVal->insert(retVal->end(), m_chunkPairs[i].begin(), m_chunkPairs[i].end());
+	}
+
+	ClearMoved();
+
+	SortPairs(retVal, nFirst);
+}
+
+void DynamicAabbTree::AddPairs(
+	int proxyId,
+	std::vector<int> * stack,
+	std::vector<int> * overlapping,
+	std::vector<std::pair<int, int>> * retVal)
+{
+	overlapping->clear();
+	Query(m_nodes[proxyId].box, stack, overlapping);
+
+	for (size_t j = 0; j < overlapping->size(); j++)
+	{
+		int otherId = (*overlapping)[j];
+
+		if (otherId == proxyId)
+		{
+			continue;
+		}
+
+		retVal->push_back(std::make_pair(
+			(std::min)(proxyId, otherId),
+			(std::max)(proxyId, otherId)));
+	}
+}
+
+// Two proxies that both moved find each other twice.
+void DynamicAabbTree::SortPairs(std::vector<std::pair<int, int>> * retVal, size_t nFirst)
+{
+	std::sort(retVal->begin() + nFirst, retVal->end());
+	retVal->erase(
+		std::unique(retVal->begin() + nFirst, retVal->end()),
+		retVal->end());
+}
+
+int DynamicAabbTree::GetHeight()
+{
+	if (m_nRoot == AABB_TREE_NULL_NODE)
+	{
+		return 0;
+	}
+
+	return m_nodes[m_nRoot].height;
+}
+
+int DynamicAabbTree::AllocateNode()
+{
+	if (m_nFreeList == AABB_TREE_NULL_NODE)
+	{
+		Node node;
+		node.parent = AABB_TREE_NULL_NODE;
+		node.height = -1;
+
+		m_nodes.push_back(node);
+		m_nFreeList = (int)m_nodes.size() - 1;
+	}
+
+	int nodeId = m_nFreeList;
+	Node & node = m_nodes[nodeId];
+
+	m_nFreeList = node.parent;
+
+	node.parent = AABB_TREE_NULL_NODE;
+	node.child1 = AABB_TREE_NULL_NODE;
+	node.child2 = AABB_TREE_NULL_NODE;
+	node.userData = NULL;
+	node.height = 0;
+	node.bMoved = false;
+
+	return nodeId;
+}
+
+void DynamicAabbTree::FreeNode(int nodeId)
+{
+	m_nodes[nodeId].parent = m_nFreeList;
+	m_nodes[nodeId].height = -1;
+	m_nodes[nodeId].bMoved = false;
+
+	m_nFreeList = nodeId;
+}
+
+void DynamicAabbTree::MarkMoved(int proxyId)
+{
+	if (!m_nodes[proxyId].bMoved)
+	{
+		m_nodes[proxyId].bMoved = true;
+		m_moved.push_back(proxyId);
+	}
+}
+
+void DynamicAabbTree::ClearMoved()
+{
+	for (size_t i = 0; i < m_moved.size(); i++)
+	{
+		m_nodes[m_moved[i]].bMoved = false;
+	}
+
+	m_moved.clear();
+}
+
+void DynamicAabbTree::InsertLeaf(int leaf)
+{
+	if (m_nRoot == AABB_TREE_NULL_NODE)
+	{
+		m_nRoot = leaf;
+		m_nodes[leaf].parent = AABB_TREE_NULL_NODE;
+
+		return;
+	}
+
+	// Find the best sibling by descending towards the child whose
+	//	perimeter grows least.
+	BoundingBox leafBox = m_nodes[leaf].box;
+	int index = m_nRoot;
+
+	while (!m_nodes[index].IsLeaf())
+	{
+		int child1 = m_nodes[index].child1;
+		int child2 = m_nodes[index].child2;
+
+		float area = m_nodes[index].box.GetPerimeter();
+		float combinedArea = BoundingBox::Combine(m_nodes[index].box, leafBox).GetPerimeter();
+
+		// Cost of making a new parent for this node and the leaf.
+		float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree.
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float cost1 = BoundingBox::Combine(leafBox, m_nodes[child1].box).GetPerimeter() + inheritanceCost;
+
+		if (!m_nodes[child1].IsLeaf())
+		{
+			cost1 -= m_nodes[child1].box.GetPerimeter();
+		}
+
+		float cost2 = BoundingBox::Combine(leafBox, m_nodes[child2].box).GetPerimeter() + inheritanceCost;
+
+		if (!m_nodes[child2].IsLeaf())
+		{
+			cost2 -= m_nodes[child2].box.GetPerimeter();
+		}
+
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	int sibling = index;
+
+	// Create a new parent for the sibling and the leaf. The node
+	//	vector may grow, so no references are held across this.
+	int oldParent = m_nodes[sibling].parent;
+	int newParent = AllocateNode();
+
+	m_nodes[newParent].parent = oldParent;
+	m_nodes[newParent].box = BoundingBox::Combine(leafBox, m_nodes[sibling].box);
+	m_nodes[newParent].height = m_nodes[sibling].height + 1;
+	m_nodes[newParent].child1 = sibling;
+	m_nodes[newParent].child2 = leaf;
+
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	if (oldParent != AABB_TREE_NULL_NODE)
+	{
+		if (m_nodes[oldParent].child1 == sibling)
+		{
+			m_nodes[oldParent].child1 = newParent;
+		}
+		else
+		{
+			m_nodes[oldParent].child2 = newParent;
+		}
+	}
+	else
+	{
+		m_nRoot = newParent;
+	}
+
+	// Walk back up fixing heights and boxes.
+	index = m_nodes[leaf].parent;
+
+	while (index != AABB_TREE_NULL_NODE)
+	{
+		index = Balance(index);
+
+		int child1 = m_nodes[index].child1;
+		int child2 = m_nodes[index].child2;
+
+		m_nodes[index].height = 1 + (std::max)(m_nodes[child1].height, m_nodes[child2].height);
+		m_nodes[index].box = BoundingBox::Combine(m_nodes[child1].box, m_nodes[child2].box);
+
+		index = m_nodes[index].parent;
+	}
+}
+
+void DynamicAabbTree::RemoveLeaf(int leaf)
+{
+	if (leaf == m_nRoot)
+	{
+		m_nRoot = AABB_TREE_NULL_NODE;
+
+		return;
+	}
+
+	int parent = m_nodes[leaf].parent;
+	int grandParent = m_nodes[parent].parent;
+	int sibling = m_nodes[parent].child1 == leaf ?
+		m_nodes[parent].child2 :
+		m_nodes[parent].child1;
+
+	if (grandParent == AABB_TREE_NULL_NODE)
+	{
+		m_nRoot = sibling;
+		m_nodes[sibling].parent = AABB_TREE_NULL_NODE;
+		FreeNode(parent);
+
+		return;
+	}
+
+	// Replace the parent with the sibling.
+	if (m_nodes[grandParent].child1 == parent)
+	{
+		m_nodes[grandParent].child1 = sibling;
+	}
+	else
+	{
+		m_nodes[grandParent].child2 = sibling;
+	}
+
+	m_nodes[sibling].parent = grandParent;
+	FreeNode(parent);
+
+	int index = grandParent;
+
+	while (index != AABB_TREE_NULL_NODE)
+	{
+		index = Balance(index);
+
+		int child1 = m_nodes[index].child1;
+		int child2 = m_nodes[index].child2;
+
+		m_nodes[index].box = BoundingBox::Combine(m_nodes[child1].box, m_nodes[child2].box);
+		m_nodes[index].height = 1 + (std::max)(m_nodes[child1].height, m_nodes[child2].height);
+
+		index = m_nodes[index].parent;
+	}
+}
+
+// Rotates a or one of its children up if a is imbalanced.
+//	Returns the node now at a's position.
+int DynamicAabbTree::Balance(int a)
+{
+	Node * nodeA = &m_nodes[a];
+
+	if (nodeA->IsLeaf() || nodeA->height < 2)
+	{
+		return a;
+	}
+
+	int b = nodeA->child1;
+	int c = nodeA->child2;
+
+	Node * nodeB = &m_nodes[b];
+	Node * nodeC = &m_nodes[c];
+
+	int balance = nodeC->height - nodeB->height;
+
+	if (balance > 1)
+	{
+		// Rotate c up.
+		int f = nodeC->child1;
+		int g = nodeC->child2;
+
+		Node * nodeF = &m_nodes[f];
+		Node * nodeG = &m_nodes[g];
+
+		nodeC->child1 = a;
+		nodeC->parent = nodeA->parent;
+		nodeA->parent = c;
+
+		if (nodeC->parent != AABB_TREE_NULL_NODE)
+		{
+			if (m_nodes[nodeC->parent].child1 == a)
+			{
+				m_nodes[nodeC->parent].child1 = c;
+			}
+			else
+			{
+				m_nodes[nodeC->parent].child2 = c;
+			}
+		}
+		else
+		{
+			m_nRoot = c;
+		}
+
+		if (nodeF->height > nodeG->height)
+		{
+			nodeC->child2 = f;
+			nodeA->child2 = g;
+			nodeG->parent = a;
+
+			nodeA->box = BoundingBox::Combine(nodeB->box, nodeG->box);
+			nodeC->box = BoundingBox::Combine(nodeA->box, nodeF->box);
+
+			nodeA->height = 1 + (std::max)(nodeB->height, nodeG->height);
+			nodeC->height = 1 + (std::max)(nodeA->height, nodeF->height);
+		}
+		else
+		{
+			nodeC->child2 = g;
+			nodeA->child2 = f;
+			nodeF->parent = a;
+
+			nodeA->box = BoundingBox::Combine(nodeB->box, nodeF->box);
+			nodeC->box = BoundingBox::Combine(nodeA->box, nodeG->box);
+
+			nodeA->height = 1 + (std::max)(nodeB->height, nodeF->height);
+			nodeC->height = 1 + (std::max)(nodeA->height, nodeG->height);
+		}
+
+		return c;
+	}
+
+	if (balance < -1)
+	{
+		// Rotate b up.
+		int d = nodeB->child1;
+		int e = nodeB->child2;
+
+		Node * nodeD = &m_nodes[d];
+		Node * nodeE = &m_nodes[e];
+
+		nodeB->child1 = a;
+		nodeB->parent = nodeA->parent;
+		nodeA->parent = b;
+
+		if (nodeB->parent != AABB_TREE_NULL_NODE)
+		{
+			if (m_nodes[nodeB->parent].child1 == a)
+			{
+				m_nodes[nodeB->parent].child1 = b;
+			}
+			else
+			{
+				m_nodes[nodeB->parent].child2 = b;
+			}
+		}
+		else
+		{
+			m_nRoot = b;
+		}
+
+		if (nodeD->height > nodeE->height)
+		{
+			nodeB->child2 = d;
+			nodeA->child1 = e;
+			nodeE->parent = a;
+
+			nodeA->box = BoundingBox::Combine(nodeC->box, nodeE->box);
+			nodeB->box = BoundingBox::Combine(nodeA->box, nodeD->box);
+
+			nodeA->height = 1 + (std::max)(nodeC->height, nodeE->height);
+			nodeB->height = 1 + (std::max)(nodeA->height, nodeD->height);
+		}
+		else
+		{
+			nodeB->child2 = e;
+			nodeA->child1 = d;
+			nodeD->parent = a;
+
+			nodeA->box = BoundingBox::Combine(nodeC->box, nodeD->box);
+			nodeB->box = BoundingBox::Combine(nodeA->box, nodeE->box);
+
+			nodeA->height = 1 + (std::max)(nodeC->height, nodeD->height);
+			nodeB->height = 1 + (std::max)(nodeA->height, nodeE->height);
+		}
+
+		return b;
+	}
+
+	return a;
+}
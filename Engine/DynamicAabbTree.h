@@ -0,0 +1,128 @@
+#pragma once
+#include "pch.h"
+#include "BoundingBox.h"
+#include "Constants.h"
+#include "WorkerPool.h"
+#include <vector>
+#include <utility>
+
+// Incremental bounding volume hierarchy for moving sprites.
+//	Each proxy is stored with a fattened box so that small movements
+//	do not touch the tree; a proxy is only reinserted once it leaves
+//	its fat box. Leaves are inserted where they grow the perimeter of
+//	the tree least and the tree is kept balanced with rotations.
+//	@see Erin Catto, Box2D b2DynamicTree
+class DynamicAabbTree
+{
+public:
+	DynamicAabbTree();
+
+	// Returns the id of the new proxy.
+	int CreateProxy(const BoundingBox & box, void * userData);
+	void DestroyProxy(int proxyId);
+
+	// displacement is the movement expected over the next frame and
+	//	stretches the fat box in that direction. Returns true if the
+	//	proxy had to be reinserted.
+	bool MoveProxy(int proxyId, const BoundingBox & box, float2 displacement);
+
+	void * GetUserData(int proxyId)
+	{
+		return m_nodes[proxyId].userData;
+	}
+
+	const BoundingBox & GetFatBox(int proxyId)
+	{
+		return m_nodes[proxyId].box;
+	}
+
+	// Appends the id of every proxy whose fat box overlaps box.
+	void Query(const BoundingBox & box, std::vector<int> * retVal);
+
+	// Appends every overlapping pair that involves a proxy created or
+	//	reinserted since the last call, each pair once, lowest id first.
+	void QueryPairs(std::vector<std::pair<int, int>> * retVal);
+
+	// The same pairs, in the same order, with the moved proxies split
+	//	into chunks of AABB_TREE_PAIR_CHUNK over the workers of pool.
+	void QueryPairs(std::vector<std::pair<int, int>> * retVal, WorkerPool * pool);
+
+	void Clear();
+
+	int GetProxyCount()
+	{
+		return m_nProxyCount;
+	}
+
+	int GetHeight();
+
+protected:
+
+private:
+	struct Node
+	{
+		BoundingBox box;
+		void * userData;
+
+		// Parent while in the tree, next free node otherwise.
+		int parent;
+		int child1;
+		int child2;
+
+		// Leaf = 0, free = -1.
+		int height;
+
+		// In m_moved, so that a proxy is listed once however often
+		//	it moves between calls to QueryPairs.
+		bool bMoved;
+
+		bool IsLeaf() const
+		{
+			return child1 == AABB_TREE_NULL_NODE;
+		}
+	};
+
+	int AllocateNode();
+	void FreeNode(int node);
+
+	void MarkMoved(int proxyId);
+
+	// Empties m_moved once its proxies have been paired up.
+	void ClearMoved();
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+
+	// Query with the caller's traversal stack, so that several
+	//	threads can query at once.
+	void Query(const BoundingBox & box, std::vector<int> * stack, std::vector<int> * retVal);
+
+	// Appends the pairs of proxyId with every proxy it overlaps.
+	void AddPairs(
+		int proxyId,
+		std::vector<int> * stack,
+		std::vector<int> * overlapping,
+		std::vector<std::pair<int, int>> * retVal);
+
+	// Sorts the pairs from nFirst on and drops the duplicates.
+	static void SortPairs(std::vector<std::pair<int, int>> * retVal, size_t nFirst);
+
+	std::vector<Node> m_nodes;
+	int m_nRoot;
+	int m_nFreeList;
+	int m_nProxyCount;
+
+	// Proxies to pair up on the next call to QueryPairs.
+	std::vector<int> m_moved;
+
+	// Traversal stack, kept to avoid allocating on every query.
+	std::vector<int> m_stack;
+	std::vector<int> m_overlapping;
+
+	// Scratch for the threaded QueryPairs: stacks and query results
+	//	per worker, pairs per chunk.
+	std::vector<std::vector<int>> m_workerStacks;
+	std::vector<std::vector<int>> m_workerOverlapping;
+	std::vector<std::vector<std::pair<int, int>>> m_chunkPairs;
+};
@@ -31,6 +31,9 @@
 #include "MathHelper.h"
 #include "Effects.h"
 #include "RenderStates.h"
+#include "CollisionBenchmark.h"
+#include "CollisionKernels.h"
+#include "CollisionLayers.h"
 
 using namespace Microsoft::WRL;
 using namespace Windows::ApplicationModel;
@@ -58,6 +61,8 @@ namespace
 
 	const char16    APPLICATION_TITLE[] = L"XInput game controller sample";
 
+	const char16    MAP_FILE_NAME[] = L"overworld.map";
+
 	const float     CLEAR_COLOR[4] = { 0.071f, 0.040f, 0.561f, 1.0f };
 
 	const char16    FONT_LOCAL[] = L"en-US";
@@ -97,6 +102,128 @@ namespace
 	const char16    VALUE_CAPS_WIRED[] = L"Wired";
 	const char16    VALUE_CAPS_WIRELESS[] = L"Wireless";
 	const char16    VALUE_CAPS_VOICE_SUPPORT[] = L"Voice Support";
+
+	// The start screen if the world has one there, or else its first
+	//	screen row by row. Returns false if it has no screens at all.
+	bool FindStartScreen(BaseWorldBuilder * builder, int * column, int * row)
+	{
+		*column = WORLD_START_COLUMN;
+		*row = WORLD_START_ROW;
+
+		if (builder->HasScreen(*column, *row))
+		{
+			return true;
+		}
+
+		for (*row = 0; *row < builder->GetNumRows(); (*row)++)
+		{
+			for (*column = 0; *column < builder->GetNumColumns(); (*column)++)
+			{
+				if (builder->HasScreen(*column, *row))
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	// The screen next to (column, row) in nDirection, which is NORTH,
+	//	EAST, SOUTH or WEST.
+	void GetNextScreen(int nDirection, int * column, int * row)
+	{
+		switch (nDirection)
+		{
+		case NORTH:
+			(*row)--;
+			break;
+		case SOUTH:
+			(*row)++;
+			break;
+		case WEST:
+			(*column)--;
+			break;
+		case EAST:
+			(*column)++;
+			break;
+		}
+	}
+
+	// The blocking of the screen next to (column, row), or NULL if
+	//	there is no screen there.
+	OccupancyBitboard * GetNextBlocking(
+		World * world,
+		int column,
+		int row,
+		int nDirection,
+		OccupancyBitboard * blocking)
+	{
+		GetNextScreen(nDirection, &column, &row);
+
+		TileMap tiles;
+
+		if (!world->HasScreen(column, row) || !world->GetScreen(column, row, &tiles))
+		{
+			return NULL;
+		}
+
+		tiles.BuildBlocking(blocking);
+
+		return blocking;
+	}
+
+	// The open grid space along the edge the player came in by that
+	//	is nearest the one at (*column, *row). Returns false if the
+	//	whole edge is blocked.
+	bool FindOpenEntry(OccupancyBitboard * blocking, int nDirection, int * column, int * row)
+	{
+		bool bAlongRow = nDirection == NORTH || nDirection == SOUTH;
+		int count = bAlongRow ? NUM_GRID_COLUMNS : NUM_GRID_ROWS;
+		int start = bAlongRow ? *column : *row;
+
+		for (int distance = 0; distance < count; distance++)
+		{
+			for (int side = -1; side <= 1; side += 2)
+			{
+				int i = start + side * distance;
+
+				if (i < 0 || i >= count)
+				{
+					continue;
+				}
+
+				int entryColumn = bAlongRow ? i : *column;
+				int entryRow = bAlongRow ? *row : i;
+
+				if (!blocking->IsOccupied(entryColumn, entryRow))
+				{
+					*column = entryColumn;
+					*row = entryRow;
+
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+#ifdef WRITE_MAP_FILE
+	void WriteMapFile(BaseWorldBuilder * builder)
+	{
+		std::vector<uint8_t> image;
+		MapFile::Write(builder, &image);
+
+		Windows::Storage::StorageFolder^ folder = Windows::Storage::ApplicationData::Current->LocalFolder;
+		Platform::String^ filename = folder->Path + L"\\" + ref new Platform::String(MAP_FILE_NAME);
+
+		BasicReaderWriter writer(folder);
+		writer.WriteData(filename, ref new Platform::Array<byte>(&image[0], (unsigned int)image.size()));
+
+		OutputDebugStringW((L"Map file written to " + filename + L"\n")->Data());
+	}
+#endif // WRITE_MAP_FILE
 };
 
 Engine::Engine() :
@@ -108,18 +235,68 @@ Engine::Engine() :
 	m_nCollidedSpriteColumn(0),
 	m_nCollidedSpriteRow(0)
 {
+	// The other broad phases can be tried through a
+	//	RuntimeCollisionPipeline, or by changing m_pCollisionPipeline.
 	m_broadCollisionDetectionStrategy =
-		//		new BoundingBoxCornerCollisionStrategy();
-		//new SpriteOverlapCollisionStrategy();
 		new BroadCollisionStrategy();
 
 	m_pNarrowCollisionDetectionStrategy =
 		new NarrowCollisionStrategy();
+
+	// The distance fields give each contact a depth and direction,
+	//	rather than the shorter side of the boxes' overlap.
+	m_pNarrowCollisionDetectionStrategy->SetMode(NARROW_PHASE_DISTANCE_FIELD);
+
+	m_pCollisionPipeline = new CollisionPipeline<BroadCollisionStrategy, NarrowCollisionStrategy>(
+		m_broadCollisionDetectionStrategy,
+		m_pNarrowCollisionDetectionStrategy);
+
+	m_pCollisionQuery = new CollisionQuery(m_broadCollisionDetectionStrategy);
+
+	m_pNarrowCollisionDetectionStrategy->SetEventStream(&m_collisionEvents, &m_orchiData);
+
+	m_nExits = 0;
+	m_screenBuilder = new ScreenBuilder();
+
+#ifdef WRITE_MAP_FILE
+	OverworldBuilder builtIn(WORLD_NUM_COLUMNS, WORLD_NUM_ROWS);
+	WriteMapFile(&builtIn);
+#endif // WRITE_MAP_FILE
+
+	// A map file, if there is one with a screen in it, takes the
+	//	place of the built-in overworld.
+	std::shared_ptr<MapFileWorldBuilder> mapFile = std::make_shared<MapFileWorldBuilder>();
+
+	if (mapFile->Open(MAP_FILE_NAME) &&
+		FindStartScreen(mapFile.get(), &m_nScreenColumn, &m_nScreenRow))
+	{
+		m_pWorld = new World(mapFile, WORLD_CACHE_BUDGET);
+	}
+	else
+	{
+		std::shared_ptr<OverworldBuilder> overworld =
+			std::make_shared<OverworldBuilder>(WORLD_NUM_COLUMNS, WORLD_NUM_ROWS);
+
+		FindStartScreen(overworld.get(), &m_nScreenColumn, &m_nScreenRow);
+
+		m_pWorld = new World(overworld, WORLD_CACHE_BUDGET);
+	}
+
+	SetTriggerCallbacks();
+
+	m_pCollisionMaskCache = new CollisionMaskCache();
+	m_nMaskGeneration = m_pCollisionMaskCache->GetVersion();
+
+	CollisionKernels::Initialize();
 		
 
 	m_pKeyboardController = new KeyboardControllerInput();
 
-	m_pCollided = new list<BaseSpriteData *>;
+	m_pFrameArena = new FrameArena(FRAME_ARENA_SIZE);
+
+	m_pCollided = new CollisionCandidates();
+	m_pCollided->SetArena(m_pFrameArena);
+	m_sweptCandidates.SetArena(m_pFrameArena);
 	m_pTreeData = new std::vector<BaseSpriteData *>;
 
 	XMMATRIX boxScale = XMMatrixScaling(15.0f, 15.0f, 15.0f);
@@ -224,12 +401,17 @@ void Engine::CreateDeviceResources()
 
 	BasicLoader ^ loader = ref new BasicLoader(m_d3dDevice.Get(), m_wicFactory.Get());
 
+	// The textures are about to be recreated, so any masks
+	//	keyed on the old ones are stale.
+	m_pCollisionMaskCache->Clear();
+
 	loader->LoadTexture(
 		"tree.dds",
 		&m_tree,
 		nullptr);
 	
 	m_spriteBatch->AddTexture(m_tree.Get());
+	m_pCollisionMaskCache->AddTexture(m_d3dDevice.Get(), m_tree.Get());
 
 	loader->LoadTexture(
 		"rock.dds",
@@ -237,6 +419,7 @@ void Engine::CreateDeviceResources()
 		nullptr);
 
 	m_spriteBatch->AddTexture(m_rock.Get());
+	m_pCollisionMaskCache->AddTexture(m_d3dDevice.Get(), m_rock.Get());
 
 	loader->LoadTexture(
 		"water.dds",
@@ -244,6 +427,7 @@ void Engine::CreateDeviceResources()
 		nullptr);
 
 	m_spriteBatch->AddTexture(m_water.Get());
+	m_pCollisionMaskCache->AddTexture(m_d3dDevice.Get(), m_water.Get());
 
 	loader->LoadTexture(
 		"grass.dds",
@@ -258,6 +442,7 @@ void Engine::CreateDeviceResources()
 		nullptr);
 
 	m_spriteBatch->AddTexture(m_stoneWall.Get());
+	m_pCollisionMaskCache->AddTexture(m_d3dDevice.Get(), m_stoneWall.Get());
 
 	loader->LoadTexture(
 		"link.dds",
@@ -266,6 +451,7 @@ void Engine::CreateDeviceResources()
 		nullptr);
 
 	m_spriteBatch->AddTexture(m_orchi.Get());
+	m_pCollisionMaskCache->AddTexture(m_d3dDevice.Get(), m_orchi.Get());
 
 	loader->LoadTexture(
 		"heart.dds",
@@ -274,6 +460,36 @@ void Engine::CreateDeviceResources()
 
 	m_spriteBatch->AddTexture(m_heart.Get());
 
+#ifdef BENCHMARK_COLLISION
+	CollisionBenchmark::NarrowPhase(
+		m_pCollisionMaskCache->GetMaskSet(m_orchi.Get()),
+		m_pCollisionMaskCache->GetMaskSet(m_tree.Get()),
+		64,
+		64);
+
+	CollisionBenchmark::BroadPhase(1000, 100);
+	CollisionBenchmark::BroadPhase(10000, 100);
+	CollisionBenchmark::BroadPhase(100000, 100);
+
+	CollisionBenchmark::SteadyState(
+		m_pCollisionMaskCache->GetMaskSet(m_orchi.Get()),
+		m_pCollisionMaskCache->GetMaskSet(m_tree.Get()),
+		1000);
+
+	CollisionBenchmark::Strategies(
+		m_pCollisionMaskCache->GetMaskSet(m_orchi.Get()),
+		m_pCollisionMaskCache->GetMaskSet(m_tree.Get()),
+		1000);
+
+	CollisionBenchmark::Parallel(
+		m_pCollisionMaskCache->GetMaskSet(m_orchi.Get()),
+		m_pCollisionMaskCache->GetMaskSet(m_tree.Get()),
+		5000,
+		100);
+
+	CollisionBenchmark::Circles(100000, 100);
+#endif // BENCHMARK_COLLISION
+
 	//
 	// Setup the local graphics objects
 	//
@@ -371,15 +587,45 @@ void Engine::Uninitialize()
 
 void Engine::BuildScreen()
 {
-	delete m_screenBuilder;
+	// Comes from the world's cache when the player got here through
+	//	a prefetch, or is coming back. The screen was checked with
+	//	HasScreen, so only a builder that fails leaves it missing,
+	//	and then an empty screen beats the last one's tiles.
+	if (!m_pWorld->GetScreen(m_nScreenColumn, m_nScreenRow, &m_tileMap))
+	{
+		OutputDebugStringA("Screen could not be built\n");
 
-	m_screenBuilder =
-		new ScreenBuilder(
-			m_window->Bounds.Width,
-			m_window->Bounds.Height);
+		m_tileMap.Clear();
+	}
+	m_tileMap.BuildBlocking(&m_blocking);
+
+	m_tileMap.BuildSprites(
+		m_window->Bounds.Width,
+		m_window->Bounds.Height,
+		&m_tileSprites,
+		m_pTreeData);
+
+	AddTriggers();
+
+	m_broadCollisionDetectionStrategy->Build(
+		m_pTreeData,
+		grid.GetNumColumns(),
+		grid.GetNumRows());
 
-	// Use chain-of-responsibility?
-	m_screenBuilder->BuildScreen1(m_pTreeData);
+	// m_pTreeData is the same vector on every screen.
+	m_pCollisionPipeline->Invalidate();
+
+	m_pCollisionQuery->SetLayout(
+		m_window->Bounds.Width * LEFT_MARGIN_RATIO + MARGIN,
+		MARGIN,
+		grid.GetColumnWidth(),
+		grid.GetRowHeight());
+
+	m_pNarrowCollisionDetectionStrategy->GetPairCache()->Clear();
+
+	// The sprites of the old screen are gone, so there is nothing
+	//	to send exit events for.
+	m_collisionEvents.Clear();
 
 	LifePanel lifePanel(
 		m_window->Bounds.Width - m_window->Bounds.Width * RIGHT_MARGIN_RATIO,
@@ -497,6 +743,15 @@ void Engine::CreateWindowSizeDependentResources()
 {
 	DirectXBase::CreateWindowSizeDependentResources();
 
+	// The grid is normally updated after this, in OnWindowSizeChanged,
+	//	but the masks need the new cell size now.
+	grid.SetWindowWidth(m_window->Bounds.Width);
+	grid.SetWindowHeight(m_window->Bounds.Height);
+
+	m_pCollisionMaskCache->RequestResolution(
+		(int)grid.GetColumnWidth(),
+		(int)grid.GetRowHeight());
+
 	// TODO: Create panels for each of these.
 	CreateLifeText();
 	CreateButtonsText();
@@ -887,19 +1142,19 @@ void Engine::MovePlayer(uint16 buttons, short horizontal, short vertical)
 {
 	if (buttons & XINPUT_GAMEPAD_DPAD_UP)
 	{
-		m_pPlayer->MoveNorth(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveNorth(&m_contacts, SweepVelocity(0.0f, -1.0f, PLAYER_MOVE_VELOCITY));
 	}
 	else if (buttons & XINPUT_GAMEPAD_DPAD_DOWN)
 	{
-		m_pPlayer->MoveSouth(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveSouth(&m_contacts, SweepVelocity(0.0f, 1.0f, PLAYER_MOVE_VELOCITY));
 	}
 	else if (buttons & XINPUT_GAMEPAD_DPAD_LEFT)
 	{
-		m_pPlayer->MoveWest(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveWest(&m_contacts, SweepVelocity(-1.0f, 0.0f, PLAYER_MOVE_VELOCITY));
 	}
 	else if (buttons & XINPUT_GAMEPAD_DPAD_RIGHT)
 	{
-		m_pPlayer->MoveEast(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveEast(&m_contacts, SweepVelocity(1.0f, 0.0f, PLAYER_MOVE_VELOCITY));
 	}
 	else
 	{
@@ -1014,7 +1269,7 @@ void Engine::Render()
 	int column = 0;
 	int row = 0;
 
-	std::list<BaseSpriteData *>::const_iterator iterator;
+	CollisionCandidates::const_iterator iterator;
 
 #ifdef RENDER_DIAGNOSTICS
 
@@ -1226,7 +1481,26 @@ void Engine::Run()
 
 			playerLocation[1] = m_pPlayer->GetVerticalRatio() * m_window->Bounds.Height;
 
-			m_broadCollisionDetectionStrategy->Detect(
+			m_broadCollisionDetectionStrategy->UpdateMovingSprites(timer->Delta);
+
+			// Taken every frame, whether or not anything responds to
+			//	them yet, so that the moved proxies do not pile up.
+			m_movingPairs.clear();
+			m_broadCollisionDetectionStrategy->QueryMovingPairs(&m_movingPairs);
+
+			// Picks up the masks rebuilt after a resize, if they are ready.
+			m_pCollisionMaskCache->Update();
+
+			// Results cached against the old masks no longer hold.
+			if (m_nMaskGeneration != m_pCollisionMaskCache->GetVersion())
+			{
+				m_nMaskGeneration = m_pCollisionMaskCache->GetVersion();
+				m_pNarrowCollisionDetectionStrategy->GetPairCache()->Clear();
+			}
+
+			m_collisionEvents.BeginFrame();
+
+			m_nCollisionState = m_pCollisionPipeline->Detect(
 				m_pCollided,
 				playerSize,
 				spriteSize,
@@ -1234,18 +1508,22 @@ void Engine::Run()
 				m_pTreeData,
 				m_window->Bounds.Width,
 				m_window->Bounds.Height,
-				playerLocation);
-
-			m_nCollisionState = m_pNarrowCollisionDetectionStrategy->Detect(
-				m_d3dContext.Get(),
-				m_d3dDevice.Get(),
-				m_orchi.Get(),
-				m_tree.Get(),
-				m_pPlayer,
-				m_pCollided,
 				playerLocation,
+				m_pCollisionMaskCache->GetMaskSet(m_orchi.Get()),
+				m_pCollisionMaskCache->GetMaskSet(m_tree.Get()),
 				&grid,
-				intersectRect);
+				intersectRect,
+				&m_contacts);
+
+			m_collisionEvents.EndFrame();
+
+			// Out of anything the player already overlaps, such as a
+			//	tree at the entry of a new screen, before it moves.
+			m_pPlayer->Resolve(&m_contacts);
+
+#ifdef LOG_COLLISION_EVENTS
+			LogCollisionEvents();
+#endif // LOG_COLLISION_EVENTS
 
 
 
@@ -1253,15 +1531,10 @@ void Engine::Run()
 			// if the gamepad is not connected, check the keyboard.
 			if (m_isControllerConnected)
 			{
-				// This would actually, detect a collision one interation
-				//	too late.  Consider detection earlier since
-				//	this could lead to weird behavior, depending
-				//	on how fast the sprites are moving.
-				//	For example, if sprites are moving very quickly,
-				//	collision would occur when the sprites 
-				//	have deeply intersected each other.
-				//  For slow moving sprites, this would not be 
-				//	much of a problem.
+				// Detect reports what the player already touches, one
+				//	iteration late. Each move is also swept against
+				//	the screen (SweepVelocity), so fast moves stop at
+				//	the obstacle instead of passing through it.
 				MovePlayer(
 					m_xinputState.Gamepad.wButtons,
 					m_xinputState.Gamepad.sThumbLX,
@@ -1270,10 +1543,21 @@ void Engine::Run()
 
 			// OnKeyDown callback will check if the keyboard is used.
 
+			// After every move, keyboard or gamepad.
+			UpdateTriggers();
+
+			m_pWorld->Update(
+				m_nScreenColumn,
+				m_nScreenRow,
+				m_pPlayer->GetHorizontalRatio(),
+				m_pPlayer->GetVerticalRatio());
+
 			Render();
 //			Present();
 
 			m_pCollided->clear();
+			m_sweptCandidates.clear();
+			m_pFrameArena->Reset();
 		}
 		else
 		{
@@ -1598,19 +1882,19 @@ void Engine::OnKeyDown(Windows::UI::Core::CoreWindow^ sender, Windows::UI::Core:
 
 	if (args->VirtualKey == Windows::System::VirtualKey::Left)
 	{
-		m_pPlayer->MoveWest(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveWest(&m_contacts, SweepVelocity(-1.0f, 0.0f, PLAYER_MOVE_VELOCITY));
 	}
 	else if (args->VirtualKey == Windows::System::VirtualKey::Down)
 	{
-		m_pPlayer->MoveSouth(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveSouth(&m_contacts, SweepVelocity(0.0f, 1.0f, PLAYER_MOVE_VELOCITY));
 	}
 	else if (args->VirtualKey == Windows::System::VirtualKey::Right)
 	{
-		m_pPlayer->MoveEast(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveEast(&m_contacts, SweepVelocity(1.0f, 0.0f, PLAYER_MOVE_VELOCITY));
 	}
 	else if (args->VirtualKey == Windows::System::VirtualKey::Up)
 	{
-		m_pPlayer->MoveNorth(m_nCollisionState, PLAYER_MOVE_VELOCITY);
+		m_pPlayer->MoveNorth(&m_contacts, SweepVelocity(0.0f, -1.0f, PLAYER_MOVE_VELOCITY));
 	}
 }
 
@@ -1630,22 +1914,22 @@ void Engine::HandleLeftThumbStick(short horizontal, short vertical)
 	{
 		if (vertical > 0)
 		{
-			m_pPlayer->MoveNorth(m_nCollisionState, velocity);
+			m_pPlayer->MoveNorth(&m_contacts, SweepVelocity(0.0f, -1.0f, velocity));
 		}
 		else if (vertical < 0)
 		{
-			m_pPlayer->MoveSouth(m_nCollisionState, velocity);
+			m_pPlayer->MoveSouth(&m_contacts, SweepVelocity(0.0f, 1.0f, velocity));
 		}
 	}
 	else if (vertical == 0)
 	{
 		if (horizontal > 0)
 		{
-			m_pPlayer->MoveEast(m_nCollisionState, velocity);
+			m_pPlayer->MoveEast(&m_contacts, SweepVelocity(1.0f, 0.0f, velocity));
 		}
 		else if (horizontal < 0)
 		{
-			m_pPlayer->MoveWest(m_nCollisionState, velocity);
+			m_pPlayer->MoveWest(&m_contacts, SweepVelocity(-1.0f, 0.0f, velocity));
 		}
 	}
 	else
@@ -1657,35 +1941,281 @@ void Engine::HandleLeftThumbStick(short horizontal, short vertical)
 		{
 			// Upper-right quadrant.
 			if (theta <= 45.f)
-				m_pPlayer->MoveEast(m_nCollisionState, velocity);
+				m_pPlayer->MoveEast(&m_contacts, SweepVelocity(1.0f, 0.0f, velocity));
 			else
-				m_pPlayer->MoveNorth(m_nCollisionState, velocity);
+				m_pPlayer->MoveNorth(&m_contacts, SweepVelocity(0.0f, -1.0f, velocity));
 		}
 		else if (horizontal > 0 && vertical < 0)
 		{
 			// Lower-right quadrant.
 			if (theta >= -45.f)
-				m_pPlayer->MoveEast(m_nCollisionState, velocity);
+				m_pPlayer->MoveEast(&m_contacts, SweepVelocity(1.0f, 0.0f, velocity));
 			else
-				m_pPlayer->MoveSouth(m_nCollisionState, velocity);
+				m_pPlayer->MoveSouth(&m_contacts, SweepVelocity(0.0f, 1.0f, velocity));
 		}
 		else if (horizontal < 0 && vertical > 0)
 		{
 			// Upper-left quadrant.
 			if (theta >= -45.f)
-				m_pPlayer->MoveWest(m_nCollisionState, velocity);
+				m_pPlayer->MoveWest(&m_contacts, SweepVelocity(-1.0f, 0.0f, velocity));
 			else
-				m_pPlayer->MoveNorth(m_nCollisionState, velocity);
+				m_pPlayer->MoveNorth(&m_contacts, SweepVelocity(0.0f, -1.0f, velocity));
 		}
 		else // (horizontal < 0 && vertical < 0)
 		{
 			// Lower-left quadrant.
 			if (theta <= 45.f)
-				m_pPlayer->MoveWest(m_nCollisionState, velocity);
+				m_pPlayer->MoveWest(&m_contacts, SweepVelocity(-1.0f, 0.0f, velocity));
 			else
-				m_pPlayer->MoveSouth(m_nCollisionState, velocity);
+				m_pPlayer->MoveSouth(&m_contacts, SweepVelocity(0.0f, 1.0f, velocity));
+		}
+	}
+}
+
+// Shortens a move of fVelocity along (dx, dy) to the time of
+//	impact, so a fast move stops at the first obstacle on its
+//	path instead of passing through it between two frames.
+float Engine::SweepVelocity(float dx, float dy, float fVelocity)
+{
+	float gameAreaWidth =
+		m_window->Bounds.Width -
+		(m_window->Bounds.Width * LEFT_MARGIN_RATIO) -
+		(m_window->Bounds.Width * RIGHT_MARGIN_RATIO);
+
+	float playerLocation[2];
+	playerLocation[HORIZONTAL_AXIS] = gameAreaWidth * m_pPlayer->GetHorizontalRatio() +
+		(m_window->Bounds.Width * LEFT_MARGIN_RATIO);
+	playerLocation[VERTICAL_AXIS] = m_pPlayer->GetVerticalRatio() * m_window->Bounds.Height;
+
+	// The ratios are of the game area, so this is the move in pixels.
+	float2 displacement(
+		dx * fVelocity * gameAreaWidth,
+		dy * fVelocity * m_window->Bounds.Height);
+
+	float2 halfSize(grid.GetColumnWidth() / 2.0f, grid.GetRowHeight() / 2.0f);
+	float2 start(playerLocation[HORIZONTAL_AXIS], playerLocation[VERTICAL_AXIS]);
+
+	BoundingBox swept = BoundingBox::Combine(
+		BoundingBox::FromCenter(start, halfSize),
+		BoundingBox::FromCenter(start + displacement, halfSize));
+
+	// Nothing blocks the spaces the move passes through.
+	float fLeft = m_window->Bounds.Width * LEFT_MARGIN_RATIO;
+
+	if (!m_blocking.AnyOccupied(
+		(int)floorf((swept.lowerBound.x - fLeft) / grid.GetColumnWidth()),
+		(int)floorf(swept.lowerBound.y / grid.GetRowHeight()),
+		(int)floorf((swept.upperBound.x - fLeft) / grid.GetColumnWidth()),
+		(int)floorf(swept.upperBound.y / grid.GetRowHeight())))
+	{
+		return fVelocity;
+	}
+
+	m_sweptCandidates.clear();
+
+	BaseSpriteData * found[COLLISION_CANDIDATES_INLINE];
+
+	int nFound = m_pCollisionQuery->QueryBox(
+		swept,
+		CollisionLayers::GetInteractionMask(COLLISION_LAYER_PLAYER),
+		found,
+		COLLISION_CANDIDATES_INLINE);
+
+	for (int i = 0; i < nFound; i++)
+	{
+		if (CollisionLayers::ShouldTest(COLLISION_LAYER_PLAYER, COLLISION_MASK_ALL, found[i]))
+		{
+			m_sweptCandidates.push_back(found[i]);
 		}
 	}
+
+	if (m_sweptCandidates.empty())
+	{
+		return fVelocity;
+	}
+
+	return fVelocity * m_pNarrowCollisionDetectionStrategy->TimeOfImpact(
+		m_pCollisionMaskCache->GetMaskSet(m_orchi.Get()),
+		m_pCollisionMaskCache->GetMaskSet(m_tree.Get()),
+		&m_sweptCandidates,
+		playerLocation,
+		displacement,
+		&grid);
+}
+
+// Enter and exit events go to the debugger output; stays would
+//	flood it.
+void Engine::LogCollisionEvents()
+{
+	for (int i = 0; i < m_collisionEvents.GetNumEvents(); i++)
+	{
+		const CollisionEvent & collisionEvent = m_collisionEvents.GetEvent(i);
+
+		if (collisionEvent.nType == COLLISION_EVENT_STAY)
+		{
+			continue;
+		}
+
+		char buf[96];
+		sprintf_s(
+			buf,
+			"%s %u (%d, %d) - %u (%d, %d)\n",
+			collisionEvent.nType == COLLISION_EVENT_ENTER ? "enter" : "exit",
+			collisionEvent.a->nId,
+			collisionEvent.a->column,
+			collisionEvent.a->row,
+			collisionEvent.b->nId,
+			collisionEvent.b->column,
+			collisionEvent.b->row);
+
+		OutputDebugStringA(buf);
+	}
+}
+
+// Every kind of region reacts to the one TriggerIndex query in
+//	UpdateTriggers. Screens only have exits for now.
+void Engine::SetTriggerCallbacks()
+{
+	m_triggers.SetCallbacks(
+		TRIGGER_EXIT,
+		[this](const TriggerRegion & region) { m_nExits |= 1 << region.nDirection; },
+		[this](const TriggerRegion & region) { m_nExits &= ~(1 << region.nDirection); });
+}
+
+// The sprites of the old screen are gone, so the player leaves
+//	their regions without leave callbacks.
+void Engine::AddTriggers()
+{
+	m_triggers.Clear();
+	m_nExits = 0;
+
+	// The screens around this one, from the world's cache, so the
+	//	exits line up with open spaces on them.
+	OccupancyBitboard next[4];
+
+	m_screenBuilder->AddExits(
+		&m_blocking,
+		GetNextBlocking(m_pWorld, m_nScreenColumn, m_nScreenRow, NORTH, &next[0]),
+		GetNextBlocking(m_pWorld, m_nScreenColumn, m_nScreenRow, EAST, &next[1]),
+		GetNextBlocking(m_pWorld, m_nScreenColumn, m_nScreenRow, SOUTH, &next[2]),
+		GetNextBlocking(m_pWorld, m_nScreenColumn, m_nScreenRow, WEST, &next[3]),
+		&m_triggers);
+}
+
+void Engine::UpdateTriggers()
+{
+	int * location = m_pPlayer->GetGridLocation();
+
+	m_triggers.Update(location[HORIZONTAL_AXIS], location[VERTICAL_AXIS]);
+
+	// The player stops at the edge of the screen, and moves on from
+	//	there only inside an exit.
+	if ((m_nExits & (1 << NORTH)) && m_pPlayer->GetVerticalRatio() <= 0.0f)
+	{
+		ChangeScreen(NORTH);
+	}
+	else if ((m_nExits & (1 << SOUTH)) && m_pPlayer->GetVerticalRatio() >= 1.0f)
+	{
+		ChangeScreen(SOUTH);
+	}
+	else if ((m_nExits & (1 << WEST)) && m_pPlayer->GetHorizontalRatio() <= 0.0f)
+	{
+		ChangeScreen(WEST);
+	}
+	else if ((m_nExits & (1 << EAST)) && m_pPlayer->GetHorizontalRatio() >= 1.0f)
+	{
+		ChangeScreen(EAST);
+	}
+}
+
+// The player comes in at the opposite edge of the next screen.
+void Engine::ChangeScreen(int nDirection)
+{
+	int column = m_nScreenColumn;
+	int row = m_nScreenRow;
+	float horizontalRatio = m_pPlayer->GetHorizontalRatio();
+	float verticalRatio = m_pPlayer->GetVerticalRatio();
+
+	GetNextScreen(nDirection, &column, &row);
+
+	switch (nDirection)
+	{
+	case NORTH:
+		verticalRatio = 1.0f - SCREEN_ENTRY_INSET;
+		break;
+	case SOUTH:
+		verticalRatio = SCREEN_ENTRY_INSET;
+		break;
+	case WEST:
+		horizontalRatio = 1.0f - SCREEN_ENTRY_INSET;
+		break;
+	case EAST:
+		horizontalRatio = SCREEN_ENTRY_INSET;
+		break;
+	}
+
+	// The edge of the world.
+	if (!m_pWorld->HasScreen(column, row))
+	{
+		return;
+	}
+
+	float previousHorizontalRatio = m_pPlayer->GetHorizontalRatio();
+	float previousVerticalRatio = m_pPlayer->GetVerticalRatio();
+
+	m_pPlayer->SetLocation(horizontalRatio, verticalRatio);
+
+	// Exits only cover spaces that are open on the next screen, but
+	//	the player may be over the edge of the exit, or the screen
+	//	may not have been there when the exits were added. Moves
+	//	the player along the edge to the nearest open space, or
+	//	stays on this screen if there is none.
+	OccupancyBitboard nextBlocking;
+
+	if (GetNextBlocking(m_pWorld, m_nScreenColumn, m_nScreenRow, nDirection, &nextBlocking) == NULL)
+	{
+		m_pPlayer->SetLocation(previousHorizontalRatio, previousVerticalRatio);
+
+		return;
+	}
+
+	int entryColumn = m_pPlayer->GetGridLocation()[HORIZONTAL_AXIS];
+	int entryRow = m_pPlayer->GetGridLocation()[VERTICAL_AXIS];
+
+	if (nextBlocking.IsOccupied(entryColumn, entryRow))
+	{
+		if (!FindOpenEntry(&nextBlocking, nDirection, &entryColumn, &entryRow))
+		{
+			m_pPlayer->SetLocation(previousHorizontalRatio, previousVerticalRatio);
+
+			return;
+		}
+
+		// The middle of the space, along the edge.
+		if (nDirection == NORTH || nDirection == SOUTH)
+		{
+			horizontalRatio = (entryColumn + 0.5f) / NUM_GRID_COLUMNS;
+		}
+		else
+		{
+			verticalRatio = (entryRow + 0.5f) / NUM_GRID_ROWS;
+		}
+
+		m_pPlayer->SetLocation(horizontalRatio, verticalRatio);
+	}
+
+	m_nScreenColumn = column;
+	m_nScreenRow = row;
+
+	BuildScreen();
+
+	// What the player touched was on the old screen.
+	m_pCollided->clear();
+	m_contacts.Clear();
+
+	int * location = m_pPlayer->GetGridLocation();
+
+	m_triggers.Update(location[HORIZONTAL_AXIS], location[VERTICAL_AXIS]);
 }
 
 Array<byte>^ Engine::LoadShaderFile(std::string File)
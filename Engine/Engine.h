@@ -13,13 +13,19 @@
 #include "Grid.h"
 #include "NarrowCollisionStrategy.h"
 #include "BroadCollisionStrategy.h"
+#include "CollisionMaskCache.h"
+#include "CollisionQuery.h"
+#include "CollisionPipeline.h"
+#include "TriggerIndex.h"
+#include "TileMap.h"
+#include "World.h"
+#include "MapFile.h"
 #include <fstream>
 #include <DirectXMath.h>
 
 using namespace Microsoft::WRL;
 using namespace DirectX;
 
-
 ref class Engine : public DirectXBase , public Windows::ApplicationModel::Core::IFrameworkView
 {
 internal:
@@ -125,6 +131,10 @@ private:
 	ComPtr<ID3D11Texture2D> m_grass;
 	ComPtr<ID3D11Texture2D> m_orchi;
 
+	// The current screen, and the sprites made from its tiles for
+	//	the collision code. m_pTreeData points into m_tileSprites.
+	TileMap m_tileMap;
+	std::vector<BaseSpriteData> m_tileSprites;
 	std::vector<BaseSpriteData *> * m_pTreeData;
 	std::vector<BaseSpriteData> m_rockData;
 	std::vector<BaseSpriteData> m_waterData;
@@ -154,10 +164,38 @@ private:
 	BroadCollisionStrategy * m_broadCollisionDetectionStrategy;
 	NarrowCollisionStrategy * m_pNarrowCollisionDetectionStrategy;
 
-	list<BaseSpriteData *> * m_pCollided;
+	// The two strategies above, run one after the other every frame.
+	CollisionPipeline<BroadCollisionStrategy, NarrowCollisionStrategy> * m_pCollisionPipeline;
+
+	// Rays and areas over the broad phase's sprites.
+	CollisionQuery * m_pCollisionQuery;
+
+	CollisionMaskCache * m_pCollisionMaskCache;
+
+	// The mask generation the narrow phase's pair cache was filled with.
+	int m_nMaskGeneration;
+
+	// Broad phase candidates, refilled every frame. Spills into
+	//	m_pFrameArena, which is reset at the end of the frame.
+	CollisionCandidates * m_pCollided;
+	FrameArena * m_pFrameArena;
 
 	ScreenBuilder * m_screenBuilder;
 
+	// Grid spaces of the current screen that block movement.
+	OccupancyBitboard m_blocking;
+
+	// The trigger regions of the current screen; only exits so far.
+	TriggerIndex m_triggers;
+
+	// The exits the player is in, as bits (1 << NORTH, etc.).
+	int m_nExits;
+
+	// The screens around the player, and where the current one is.
+	World * m_pWorld;
+	int m_nScreenColumn;
+	int m_nScreenRow;
+
 
 
 	void SetupScreen();
@@ -179,6 +217,13 @@ private:
 
 	void MovePlayer(uint16 buttons, short horizontal, short vertical);
 	void HandleLeftThumbStick(short horizontal, short vertical);
+	float SweepVelocity(float dx, float dy, float fVelocity);
+	void LogCollisionEvents();
+
+	void SetTriggerCallbacks();
+	void AddTriggers();
+	void UpdateTriggers();
+	void ChangeScreen(int nDirection);
 
 	void HighlightSprite(int column, int row, ComPtr<ID2D1SolidColorBrush> brush);
 	void HighlightSprite(int * pLocation, ComPtr<ID2D1SolidColorBrush> brush);
@@ -206,6 +251,18 @@ private:
 	void DrawSpriteIntersection();
 	int m_nCollisionState;
 
+	// Every contact found by the narrow phase this frame.
+	DirectionalCollsionDetectionInfo m_contacts;
+
+	// What the player started, kept on and stopped touching this frame.
+	CollisionEventStream m_collisionEvents;
+
+	// Sprites along the path of the current move.
+	CollisionCandidates m_sweptCandidates;
+
+	// Moving sprites that may have started touching this frame.
+	std::vector<std::pair<BaseSpriteData *, BaseSpriteData *>> m_movingPairs;
+
 	int count;
 
 	Platform::Array<byte> ^ LoadShaderFile(std::string File);
@@ -0,0 +1,40 @@
+#include "pch.h"
+#include "FrameArena.h"
+
+FrameArena::FrameArena(size_t nBytes)
+{
+	m_block.resize(nBytes);
+	m_nUsed = 0;
+	m_nHighWater = 0;
+}
+
+void * FrameArena::Allocate(size_t nBytes, size_t nAlignment)
+{
+	if (m_block.empty())
+	{
+		return NULL;
+	}
+
+	uintptr_t base = (uintptr_t)&m_block[0];
+	uintptr_t address = (base + m_nUsed + nAlignment - 1) & ~(uintptr_t)(nAlignment - 1);
+	size_t nEnd = (size_t)(address - base) + nBytes;
+
+	if (nEnd > m_block.size())
+	{
+		return NULL;
+	}
+
+	m_nUsed = nEnd;
+
+	if (m_nUsed > m_nHighWater)
+	{
+		m_nHighWater = m_nUsed;
+	}
+
+	return (void *)address;
+}
+
+void FrameArena::Reset()
+{
+	m_nUsed = 0;
+}
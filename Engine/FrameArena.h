@@ -0,0 +1,43 @@
+#pragma once
+#include "pch.h"
+#include <vector>
+
+// Bump allocator for scratch memory that only lives for one frame.
+//	The block is allocated once; Reset at the end of the frame hands
+//	all of it back at once. Nothing is destroyed, so it only holds
+//	plain data.
+class FrameArena
+{
+public:
+	FrameArena(size_t nBytes);
+
+	// Returns NULL when the block is used up, so callers can fall
+	//	back to the heap.
+	void * Allocate(size_t nBytes, size_t nAlignment);
+
+	// Everything allocated since the last Reset becomes invalid.
+	void Reset();
+
+	size_t GetCapacity()
+	{
+		return m_block.size();
+	}
+
+	size_t GetUsed()
+	{
+		return m_nUsed;
+	}
+
+	// Most ever used in one frame, to size the block.
+	size_t GetHighWater()
+	{
+		return m_nHighWater;
+	}
+
+protected:
+
+private:
+	std::vector<uint8_t> m_block;
+	size_t m_nUsed;
+	size_t m_nHighWater;
+};
@@ -8,7 +8,9 @@ class GrassData : public BaseSpriteData
 public:
 	GrassData(int column, int row, float x, float y) : BaseSpriteData(column, row, x, y)
 	{
-
+		SetLayer(COLLISION_LAYER_DECORATION);
+		SetBlockable(false);
+		SetCollidable(false);
 	}
 
 protected:
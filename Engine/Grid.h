@@ -35,6 +35,16 @@ public:
 		return m_nNumColumns;
 	}
 
+	float GetWindowWidth()
+	{
+		return m_fWindowWidth;
+	}
+
+	float GetWindowHeight()
+	{
+		return m_fWindowHeight;
+	}
+
 protected:
 
 private:
@@ -8,6 +8,7 @@ class HeartData : public BaseSpriteData
 public:
 	HeartData(int column, int row, float x, float y) : BaseSpriteData(column, row, x, y)
 	{
-
+		SetLayer(COLLISION_LAYER_PICKUP);
+		SetBlockable(false);
 	}
 };
\ No newline at end of file
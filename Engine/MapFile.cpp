@@ -0,0 +1,390 @@
+#include "pch.h"
+#include "MapFile.h"
+#include <map>
+
+namespace
+{
+	const size_t SCREEN_TILE_BYTES = sizeof(uint16_t) * NUM_TILE_LAYERS * NUM_GRID_ROWS * NUM_GRID_COLUMNS;
+
+	// Whether count items of itemSize bytes, aligned to alignment,
+	//	fit in the file at offset. 64-bit, so nothing overflows.
+	bool IsInFile(uint64_t offset, uint64_t count, uint64_t itemSize, uint64_t alignment, size_t size)
+	{
+		return offset % alignment == 0 && offset + count * itemSize <= size;
+	}
+
+	// FNV-1a, to find screens with the same tiles.
+	unsigned int HashTiles(const uint8_t * bytes)
+	{
+		unsigned int hash = 2166136261u;
+
+		for (size_t i = 0; i < SCREEN_TILE_BYTES; i++)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+
+		return hash;
+	}
+}
+
+MapFile::MapFile()
+{
+	m_pData = NULL;
+	m_pHeader = NULL;
+	m_pScreens = NULL;
+
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+	m_pView = NULL;
+}
+
+MapFile::~MapFile()
+{
+	Close();
+}
+
+bool MapFile::Open(const wchar_t * filename)
+{
+	Close();
+
+	CREATEFILE2_EXTENDED_PARAMETERS extendedParams = {0};
+	extendedParams.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS);
+	extendedParams.dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+	extendedParams.dwFileFlags = FILE_FLAG_RANDOM_ACCESS;
+	extendedParams.dwSecurityQosFlags = SECURITY_ANONYMOUS;
+	extendedParams.lpSecurityAttributes = NULL;
+	extendedParams.hTemplateFile = NULL;
+
+	m_hFile = CreateFile2(
+		filename,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		OPEN_EXISTING,
+		&extendedParams);
+
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	FILE_STANDARD_INFO fileInfo = {0};
+
+	// Offsets are 32-bit, so a bigger file cannot be a map.
+	if (!GetFileInformationByHandleEx(m_hFile, FileStandardInfo, &fileInfo, sizeof(fileInfo)) ||
+		fileInfo.EndOfFile.HighPart != 0 ||
+		fileInfo.EndOfFile.LowPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	size_t size = fileInfo.EndOfFile.LowPart;
+
+	m_hMapping = CreateFileMappingFromApp(m_hFile, NULL, PAGE_READONLY, 0, NULL);
+
+	if (m_hMapping == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	m_pView = MapViewOfFileFromApp(m_hMapping, FILE_MAP_READ, 0, 0);
+
+	if (m_pView == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	const char * error = Validate(m_pView, size, false);
+
+	if (error != NULL)
+	{
+		char buf[128];
+		sprintf_s(buf, "Map file not loaded: %s\n", error);
+		OutputDebugStringA(buf);
+
+		Close();
+		return false;
+	}
+
+	Attach(m_pView);
+
+	return true;
+}
+
+bool MapFile::Open(const void * data, size_t size)
+{
+	Close();
+
+	if (Validate(data, size, false) != NULL)
+	{
+		return false;
+	}
+
+	Attach(data);
+
+	return true;
+}
+
+void MapFile::Close()
+{
+	if (m_pView != NULL)
+	{
+		UnmapViewOfFile(m_pView);
+	}
+
+	if (m_hMapping != NULL)
+	{
+		CloseHandle(m_hMapping);
+	}
+
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_hFile);
+	}
+
+	m_pData = NULL;
+	m_pHeader = NULL;
+	m_pScreens = NULL;
+
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+	m_pView = NULL;
+}
+
+const char * MapFile::Validate(const void * data, size_t size, bool bDeep)
+{
+	const uint8_t * bytes = (const uint8_t *)data;
+
+	if (((uintptr_t)bytes & 3) != 0)
+	{
+		return "not aligned";
+	}
+
+	if (size < sizeof(MapFileHeader))
+	{
+		return "too small for the header";
+	}
+
+	const MapFileHeader * header = (const MapFileHeader *)bytes;
+
+	if (header->nMagic != MAP_FILE_MAGIC)
+	{
+		return "not a map file";
+	}
+
+	if (header->nVersion != MAP_FILE_VERSION)
+	{
+		return "unknown version";
+	}
+
+	if (header->nHeaderSize < sizeof(MapFileHeader) || header->nHeaderSize > size)
+	{
+		return "bad header size";
+	}
+
+	if (header->nFileSize != size)
+	{
+		return "truncated";
+	}
+
+	if (header->nGridColumns != NUM_GRID_COLUMNS ||
+		header->nGridRows != NUM_GRID_ROWS ||
+		header->nLayers != NUM_TILE_LAYERS)
+	{
+		return "screens are the wrong size";
+	}
+
+	uint64_t nScreens = (uint64_t)header->nColumns * header->nRows;
+
+	if (header->nScreenTableOffset < header->nHeaderSize ||
+		!IsInFile(header->nScreenTableOffset, nScreens, sizeof(MapScreenRecord), 4, size))
+	{
+		return "screen table out of the file";
+	}
+
+	const MapScreenRecord * screens = (const MapScreenRecord *)(bytes + header->nScreenTableOffset);
+
+	for (uint64_t i = 0; i < nScreens; i++)
+	{
+		const MapScreenRecord & screen = screens[i];
+
+		if (screen.nTilesOffset == 0)
+		{
+			continue;
+		}
+
+		if (screen.nTilesOffset < header->nHeaderSize ||
+			!IsInFile(screen.nTilesOffset, 1, SCREEN_TILE_BYTES, sizeof(uint16_t), size))
+		{
+			return "tiles out of the file";
+		}
+
+		if (screen.nNumObjects > 0 &&
+			(screen.nObjectsOffset < header->nHeaderSize ||
+			!IsInFile(screen.nObjectsOffset, screen.nNumObjects, sizeof(MapObjectRecord), 4, size)))
+		{
+			return "objects out of the file";
+		}
+
+		if (!bDeep)
+		{
+			continue;
+		}
+
+		const uint16_t * tiles = (const uint16_t *)(bytes + screen.nTilesOffset);
+
+		for (size_t j = 0; j < SCREEN_TILE_BYTES / sizeof(uint16_t); j++)
+		{
+			if (tiles[j] >= NUM_TILE_TYPES)
+			{
+				return "unknown tile";
+			}
+		}
+
+		const MapObjectRecord * objects = (const MapObjectRecord *)(bytes + screen.nObjectsOffset);
+
+		for (uint32_t j = 0; j < screen.nNumObjects; j++)
+		{
+			if (objects[j].nType >= NUM_MAP_OBJECT_TYPES)
+			{
+				return "unknown object";
+			}
+
+			if (objects[j].column >= NUM_GRID_COLUMNS || objects[j].row >= NUM_GRID_ROWS)
+			{
+				return "object off the screen";
+			}
+		}
+	}
+
+	return NULL;
+}
+
+int MapFile::GetNumColumns()
+{
+	return m_pHeader != NULL ? m_pHeader->nColumns : 0;
+}
+
+int MapFile::GetNumRows()
+{
+	return m_pHeader != NULL ? m_pHeader->nRows : 0;
+}
+
+bool MapFile::HasScreen(int column, int row)
+{
+	if (column < 0 || column >= GetNumColumns() || row < 0 || row >= GetNumRows())
+	{
+		return false;
+	}
+
+	return m_pScreens[row * GetNumColumns() + column].nTilesOffset != 0;
+}
+
+bool MapFile::GetScreen(int column, int row, MapScreenView * view)
+{
+	if (!HasScreen(column, row))
+	{
+		return false;
+	}
+
+	const MapScreenRecord & screen = m_pScreens[row * GetNumColumns() + column];
+
+	view->tiles = (const uint16_t *)(m_pData + screen.nTilesOffset);
+	view->objects = screen.nNumObjects > 0 ? (const MapObjectRecord *)(m_pData + screen.nObjectsOffset) : NULL;
+	view->nNumObjects = (int)screen.nNumObjects;
+
+	return true;
+}
+
+void MapFile::Write(BaseWorldBuilder * builder, std::vector<uint8_t> * image)
+{
+	int nColumns = builder->GetNumColumns();
+	int nRows = builder->GetNumRows();
+
+	MapFileHeader header = {0};
+	header.nMagic = MAP_FILE_MAGIC;
+	header.nVersion = MAP_FILE_VERSION;
+	header.nHeaderSize = sizeof(MapFileHeader);
+	header.nColumns = (uint16_t)nColumns;
+	header.nRows = (uint16_t)nRows;
+	header.nGridColumns = NUM_GRID_COLUMNS;
+	header.nGridRows = NUM_GRID_ROWS;
+	header.nLayers = NUM_TILE_LAYERS;
+	header.nScreenTableOffset = sizeof(MapFileHeader);
+
+	image->assign(sizeof(MapFileHeader) + nColumns * nRows * sizeof(MapScreenRecord), 0);
+
+	TileMap tiles;
+
+	// Offsets of the tile arrays written so far, by hash.
+	std::multimap<unsigned int, uint32_t> written;
+
+	for (int row = 0; row < nRows; row++)
+	{
+		for (int column = 0; column < nColumns; column++)
+		{
+			if (!builder->BuildScreen(column, row, &tiles))
+			{
+				continue;
+			}
+
+			const uint8_t * tileBytes = (const uint8_t *)tiles.GetTiles();
+			unsigned int hash = HashTiles(tileBytes);
+
+			MapScreenRecord screen = {0};
+
+			auto range = written.equal_range(hash);
+
+			for (auto iterator = range.first; iterator != range.second; iterator++)
+			{
+				if (memcmp(&(*image)[iterator->second], tileBytes, SCREEN_TILE_BYTES) == 0)
+				{
+					screen.nTilesOffset = iterator->second;
+					break;
+				}
+			}
+
+			// The screen table is already in place, so every tile
+			//	array starts on a multiple of 4.
+			if (screen.nTilesOffset == 0)
+			{
+				screen.nTilesOffset = (uint32_t)image->size();
+				image->insert(image->end(), tileBytes, tileBytes + SCREEN_TILE_BYTES);
+
+				written.insert(std::make_pair(hash, screen.nTilesOffset));
+			}
+
+			memcpy(
+				&(*image)[header.nScreenTableOffset + (row * nColumns + column) * sizeof(MapScreenRecord)],
+				&screen,
+				sizeof(screen));
+		}
+	}
+
+	header.nFileSize = (uint32_t)image->size();
+
+	memcpy(&(*image)[0], &header, sizeof(header));
+}
+
+void MapFile::Attach(const void * data)
+{
+	m_pData = (const uint8_t *)data;
+	m_pHeader = (const MapFileHeader *)m_pData;
+	m_pScreens = (const MapScreenRecord *)(m_pData + m_pHeader->nScreenTableOffset);
+}
+
+bool MapFileWorldBuilder::BuildScreen(int column, int row, TileMap * tiles)
+{
+	MapScreenView view;
+
+	if (!m_map.GetScreen(column, row, &view))
+	{
+		return false;
+	}
+
+	tiles->SetTiles(view.tiles);
+
+	return true;
+}
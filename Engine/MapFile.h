@@ -0,0 +1,170 @@
+#pragma once
+#include "pch.h"
+#include "TileMap.h"
+#include "WorldBuilder.h"
+#include "Constants.h"
+#include <vector>
+
+// A map file is read in place, straight out of a read-only mapping,
+//	so every structure in it has a fixed size and natural alignment,
+//	little-endian like everything Windows runs on. Offsets are from
+//	the start of the file. The layout is the header, the screen
+//	table (a MapScreenRecord per screen, row by row), then the tile
+//	arrays and object records the table points to. Screens with the
+//	same tiles may share one array.
+struct MapFileHeader
+{
+	// MAP_FILE_MAGIC and MAP_FILE_VERSION.
+	uint32_t nMagic;
+	uint16_t nVersion;
+
+	// At least sizeof(MapFileHeader); later versions may add fields.
+	uint16_t nHeaderSize;
+
+	uint32_t nFileSize;
+
+	// The world, in screens.
+	uint16_t nColumns;
+	uint16_t nRows;
+
+	// NUM_GRID_COLUMNS, NUM_GRID_ROWS and NUM_TILE_LAYERS.
+	uint16_t nGridColumns;
+	uint16_t nGridRows;
+	uint16_t nLayers;
+	uint16_t nReserved;
+
+	uint32_t nScreenTableOffset;
+};
+
+struct MapScreenRecord
+{
+	// A TileMap's tile ids, in the same order. 0 if there is no
+	//	screen here.
+	uint32_t nTilesOffset;
+
+	uint32_t nObjectsOffset;
+	uint32_t nNumObjects;
+};
+
+struct MapObjectRecord
+{
+	// MAP_OBJECT_*.
+	uint16_t nType;
+	uint8_t column;
+	uint8_t row;
+
+	// What it means depends on the type.
+	uint32_t nData;
+};
+
+static_assert(sizeof(MapFileHeader) == 28, "MapFileHeader is part of the file format");
+static_assert(sizeof(MapScreenRecord) == 12, "MapScreenRecord is part of the file format");
+static_assert(sizeof(MapObjectRecord) == 8, "MapObjectRecord is part of the file format");
+
+// One screen of a map file, pointing into the mapping.
+struct MapScreenView
+{
+	const uint16_t * tiles;
+	const MapObjectRecord * objects;
+	int nNumObjects;
+};
+
+// A map file, mapped and checked once when it is opened. Screens are
+//	handed out as views into the mapping, so getting one costs the
+//	page faults of reading it rather than a parse. Nothing changes
+//	after Open, so screens may be read from several threads at once.
+class MapFile
+{
+public:
+	MapFile();
+	~MapFile();
+
+	// Maps the file read-only and validates it. Returns false, with
+	//	nothing open, if the file cannot be mapped or is not valid.
+	bool Open(const wchar_t * filename);
+
+	// A map already in memory, used in place; data has to outlive
+	//	the MapFile and be aligned to 4 bytes.
+	bool Open(const void * data, size_t size);
+
+	void Close();
+
+	bool IsOpen()
+	{
+		return m_pHeader != NULL;
+	}
+
+	// NULL if data holds a valid map, or what is wrong with it. Every
+	//	offset and count is checked, so reading the screens can never
+	//	go past the end. bDeep also checks every tile id and object,
+	//	which reads the whole file; without it only the header and the
+	//	screen table are read. Tile ids need no check to be safe, as
+	//	TileMap treats unknown ids as TILE_NONE.
+	static const char * Validate(const void * data, size_t size, bool bDeep);
+
+	int GetNumColumns();
+	int GetNumRows();
+
+	// A map need not fill its grid; the screen table says which
+	//	screens are there.
+	bool HasScreen(int column, int row);
+
+	// Returns false if there is no screen there.
+	bool GetScreen(int column, int row, MapScreenView * view);
+
+	// Every screen of builder, as a map file with no objects. Screens
+	//	that come out the same are written once.
+	static void Write(BaseWorldBuilder * builder, std::vector<uint8_t> * image);
+
+protected:
+
+private:
+	void Attach(const void * data);
+
+	const uint8_t * m_pData;
+	const MapFileHeader * m_pHeader;
+	const MapScreenRecord * m_pScreens;
+
+	// Only set by Open(filename).
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+	void * m_pView;
+};
+
+// The screens of a map file. Building one only copies its tiles out
+//	of the mapping.
+class MapFileWorldBuilder : public BaseWorldBuilder
+{
+public:
+	bool Open(const wchar_t * filename)
+	{
+		return m_map.Open(filename);
+	}
+
+	MapFile * GetMapFile()
+	{
+		return &m_map;
+	}
+
+	virtual bool BuildScreen(int column, int row, TileMap * tiles);
+
+	virtual int GetNumColumns()
+	{
+		return m_map.GetNumColumns();
+	}
+
+	virtual int GetNumRows()
+	{
+		return m_map.GetNumRows();
+	}
+
+	virtual bool HasScreen(int column, int row)
+	{
+		return m_map.HasScreen(column, row);
+	}
+
+protected:
+
+private:
+	MapFile m_map;
+};
@@ -13,4 +13,16 @@ float MathUtils::CalculateDistance(
 
 	return
 		sqrt((deltaX * deltaX) + (deltaY * deltaY));
+}
+
+float MathUtils::CalculateDistanceSquared(
+	float x1,
+	float y1,
+	float x2,
+	float y2)
+{
+	float deltaX = x2 - x1;
+	float deltaY = y2 - y1;
+
+	return (deltaX * deltaX) + (deltaY * deltaY);
 }
\ No newline at end of file
@@ -8,4 +8,11 @@ public:
 		float y1,
 		float x2,
 		float y2);
+
+	// Avoids the square root when only comparing distances.
+	static float CalculateDistanceSquared(
+		float x1,
+		float y1,
+		float x2,
+		float y2);
 };
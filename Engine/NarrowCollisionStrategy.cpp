@@ -2,8 +2,8 @@
 #include "NarrowCollisionStrategy.h"
 #include "Player.h"
 #include "MathUtils.h"
+#include "SweptCollision.h"
 #include <iostream>
-#include "BasicSprites.h"
 #include <Windows.h>
 
 // @see http://www.gamedev.net/page/resources/_/technical/directx-and-xna/pixel-perfect-collision-detection-in-directx-r2939
@@ -12,7 +12,10 @@
 // @see http://www.cleoag.ru/2013/05/12/directx-texture-hbitmap/
 NarrowCollisionStrategy::NarrowCollisionStrategy()
 {
+	m_nMode = NARROW_PHASE_HIERARCHY;
 
+	m_pEvents = NULL;
+	m_pPlayerSprite = NULL;
 }
 
 NarrowCollisionStrategy::~NarrowCollisionStrategy()
@@ -21,42 +24,30 @@ NarrowCollisionStrategy::~NarrowCollisionStrategy()
 }
 
 int NarrowCollisionStrategy::Detect(
-	ID3D11DeviceContext2 * context,
-	ID3D11Device2 * device,
-	ID3D11Texture2D * texturePlayer,
-	ID3D11Texture2D * textureTree,	// Just checking for trees, for now.
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,	// Just checking for trees, for now.
 	Player * pPlayer,
-	std::list<BaseSpriteData *> * collided,
+	CollisionCandidates * collided,
 	float * playerLocation,
 	Grid * grid, // Player location is the coordinates of the center of the sprite.
-	int * intersectRect)
+	int * intersectRect,
+	DirectionalCollsionDetectionInfo * contacts)
 {
-	bool bIntersection = false;
-
-	int rawPlayerDimensions[2];
-	int rawObstacleDimensions[2];
-
-	uint8_t * playerPixels = NULL;
-	uint8_t * obstaclePixels = NULL;
+	int retVal = NO_INTERSECTION;
 
-	playerPixels = readPixels(
-		context,
-		device,
-		texturePlayer,
-		rawPlayerDimensions);	// These are the dimensions of the raw sprite.
+	contacts->Clear();
 
-	obstaclePixels = readPixels(
-		context,
-		device,
-		textureTree,
-		rawObstacleDimensions);	// These are the dimensions of the raw sprite.
+	if (playerMasks == NULL || obstacleMasks == NULL)
+	{
+		return NO_INTERSECTION;
+	}
 
 #ifdef DUMP_PIXELS
-	DumpPixels(rawPlayerDimensions[0], rawPlayerDimensions[1], playerPixels);
-	DumpPixels(rawObstacleDimensions[0], rawObstacleDimensions[1], obstaclePixels);
+	DumpPixels(&playerMasks->mask);
+	DumpPixels(&obstacleMasks->mask);
 #endif // DUMP_PIXELS
 
-	std::list<BaseSpriteData *>::const_iterator iterator;
+	CollisionCandidates::const_iterator iterator;
 
 	int playerTopLeft[2];
 
@@ -65,19 +56,19 @@ int NarrowCollisionStrategy::Detect(
 	playerTopLeft[HORIZONTAL_AXIS] = (int)playerLocation[HORIZONTAL_AXIS] - grid->GetColumnWidth() / 2;
 	playerTopLeft[VERTICAL_AXIS] = (int)playerLocation[VERTICAL_AXIS] - grid->GetRowHeight() / 2;
 
+	// These are relative to the rendered sprite.
+	//	Take into consideration the actual screen dimensions.
+	int renderedSpriteDimensions[2];
+	renderedSpriteDimensions[WIDTH_INDEX] = (int)grid->GetColumnWidth();
+	renderedSpriteDimensions[HEIGHT_INDEX] = (int)grid->GetRowHeight();
+
 	for (iterator = collided->begin(); iterator != collided->end(); iterator++)
 	{
-		int renderedSpriteDimensions[2];
 		float obstacleCenterLocation[2];
 
 		obstacleCenterLocation[HORIZONTAL_AXIS] = (*iterator)->pos.x;
 		obstacleCenterLocation[VERTICAL_AXIS] = (*iterator)->pos.y;
 
-		// These are relative to the rendered sprite.
-		//	Take into consideration the actual screen dimensions.
-		renderedSpriteDimensions[WIDTH_INDEX] = (int)grid->GetColumnWidth();
-		renderedSpriteDimensions[HEIGHT_INDEX] = (int)grid->GetRowHeight();
-
 		// Right now, all obstacles are assumed to occupy exactly one grid space.
 		int obstacleTopLeft[2];
 		obstacleTopLeft[HORIZONTAL_AXIS] = 
@@ -88,205 +79,498 @@ int NarrowCollisionStrategy::Detect(
 			(int)obstacleCenterLocation[VERTICAL_AXIS] -
 			renderedSpriteDimensions[HEIGHT_INDEX] / 2;
 
-		bIntersection = IntersectRect(
+		int candidateRect[4];
+
+		if (!IntersectRect(
 			playerTopLeft,
 			obstacleTopLeft,
 			renderedSpriteDimensions[WIDTH_INDEX],
 			renderedSpriteDimensions[HEIGHT_INDEX],
-			intersectRect);
+			candidateRect))
+		{
+			continue;
+		}
+
+		// Skip the pixel test if neither side moved since last time.
+		int dx = obstacleTopLeft[HORIZONTAL_AXIS] - playerTopLeft[HORIZONTAL_AXIS];
+		int dy = obstacleTopLeft[VERTICAL_AXIS] - playerTopLeft[VERTICAL_AXIS];
+
+		bool bCollision;
+		DistanceFieldContact contact;
 
-		if (bIntersection == true)
+		if (!m_pairCache.Lookup(
+			pPlayer,
+			*iterator,
+			dx,
+			dy,
+			renderedSpriteDimensions[WIDTH_INDEX],
+			renderedSpriteDimensions[HEIGHT_INDEX],
+			&bCollision,
+			&contact))
 		{
-			int intersectionWidth = abs(intersectRect[INTERSECTION_LEFT] - intersectRect[INTERSECTION_RIGHT]);
-			int intersectionHeight = abs(intersectRect[INTERSECTION_TOP] - intersectRect[INTERSECTION_BOTTOM]);
+			contact.depth = 0.0f;
+			contact.normal = float2(0.0f, 0.0f);
 
-			for (int row = 0; row < intersectionHeight; row++)
+			// The distance fields give the push-out as well.
+			if (UseDistanceFields(playerMasks, obstacleMasks))
+			{
+				bCollision = DistanceField::Overlap(
+					&playerMasks->field,
+					playerTopLeft,
+					&obstacleMasks->field,
+					obstacleTopLeft,
+					renderedSpriteDimensions[WIDTH_INDEX],
+					renderedSpriteDimensions[HEIGHT_INDEX],
+					&contact);
+			}
+			else
 			{
-				for (int column = 0; column < intersectionWidth; column++)
-				{
+				bCollision = TestPixels(
+					playerMasks,
+					obstacleMasks,
+					playerTopLeft,
+					obstacleTopLeft,
+					renderedSpriteDimensions,
+					candidateRect);
+			}
 
-					// These coordinates are relative to the whole screen.
-					int playerIntersectionHorizontalOffset = intersectRect[0] - playerTopLeft[0] + column;
-					int playerIntersectionVerticalOffset = intersectRect[2] - playerTopLeft[1] + row;
+			m_pairCache.Store(
+				pPlayer,
+				*iterator,
+				dx,
+				dy,
+				renderedSpriteDimensions[WIDTH_INDEX],
+				renderedSpriteDimensions[HEIGHT_INDEX],
+				bCollision,
+				contact);
+		}
 
-					// These coordinates are relative to the whole screen.
-					int obstacleIntersectionHorizontalOffset = intersectRect[0] - obstacleTopLeft[0] + column;
-					int obstacleIntersectionVerticalOffset = intersectRect[2] - obstacleTopLeft[1] + row;
+		// Pickups and the like collide, but do not block.
+		if (bCollision && (*iterator)->bBlockable)
+		{
+			if (contact.normal.x != 0.0f || contact.normal.y != 0.0f)
+			{
+				contacts->AddContact(contact.normal, contact.depth);
+			}
+			else
+			{
+				AddContact(playerTopLeft, obstacleTopLeft, candidateRect, contacts);
+			}
+		}
 
+		UpdateResult(*iterator, bCollision, candidateRect, intersectRect, &retVal);
+	}
 
-					float playerPixelNormalizedLocation[2];
-					int playerPixelRawCoordinate[2];
-					float obstaclePixelNormalizedLocation[2];
-					int obstaclePixelRawCoordinate[2];
+	return retVal;
+}
 
-					// Relative to the raw sprite dimensions (0, 1.0f)
-					playerPixelNormalizedLocation[HORIZONTAL_AXIS] =
-						(float)playerIntersectionHorizontalOffset / (float)renderedSpriteDimensions[HORIZONTAL_AXIS];
+float NarrowCollisionStrategy::TimeOfImpact(
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,
+	CollisionCandidates * candidates,
+	float * playerLocation,
+	float2 displacement,
+	Grid * grid)
+{
+	float retVal = 1.0f;
 
-					// Relative to the raw sprite dimensions (0, 1.0f)
-					playerPixelNormalizedLocation[VERTICAL_AXIS] =
-						(float)playerIntersectionVerticalOffset / (float)renderedSpriteDimensions[VERTICAL_AXIS];
+	if (playerMasks == NULL || obstacleMasks == NULL)
+	{
+		return retVal;
+	}
 
-					// Relative to the raw sprite dimensions (0, 1.0f)
-					obstaclePixelNormalizedLocation[HORIZONTAL_AXIS] =
-						(float)obstacleIntersectionHorizontalOffset / (float)renderedSpriteDimensions[HORIZONTAL_AXIS];
+	int width = (int)grid->GetColumnWidth();
+	int height = (int)grid->GetRowHeight();
 
-					// Relative to the raw sprite dimensions (0, 1.0f)
-					obstaclePixelNormalizedLocation[VERTICAL_AXIS] =
-						(float)obstacleIntersectionVerticalOffset / (float)renderedSpriteDimensions[VERTICAL_AXIS];
+	bool bMasksReady =
+		playerMasks->packed.GetWidth() == width &&
+		playerMasks->packed.GetHeight() == height &&
+		obstacleMasks->packed.GetWidth() == width &&
+		obstacleMasks->packed.GetHeight() == height;
 
-					playerPixelRawCoordinate[HORIZONTAL_AXIS] =
-						playerPixelNormalizedLocation[HORIZONTAL_AXIS] * rawPlayerDimensions[HORIZONTAL_AXIS];
+	bool bFieldsReady = UseDistanceFields(playerMasks, obstacleMasks);
 
-					playerPixelRawCoordinate[VERTICAL_AXIS] =
-						playerPixelNormalizedLocation[VERTICAL_AXIS] * rawPlayerDimensions[VERTICAL_AXIS];
+	// Same layout as Detect: every sprite fills one grid space.
+	int playerTopLeft[2];
+	playerTopLeft[HORIZONTAL_AXIS] = (int)playerLocation[HORIZONTAL_AXIS] - width / 2;
+	playerTopLeft[VERTICAL_AXIS] = (int)playerLocation[VERTICAL_AXIS] - height / 2;
 
-					obstaclePixelRawCoordinate[HORIZONTAL_AXIS] =
-						obstaclePixelNormalizedLocation[HORIZONTAL_AXIS] * rawObstacleDimensions[HORIZONTAL_AXIS];
+	BoundingBox playerBox;
+	playerBox.lowerBound = float2((float)playerTopLeft[HORIZONTAL_AXIS], (float)playerTopLeft[VERTICAL_AXIS]);
+	playerBox.upperBound = float2(playerBox.lowerBound.x + width, playerBox.lowerBound.y + height);
 
-					obstaclePixelRawCoordinate[VERTICAL_AXIS] =
-						obstaclePixelNormalizedLocation[VERTICAL_AXIS] * rawObstacleDimensions[VERTICAL_AXIS];
-			
-					int rawPlayerPixelIndex =
-						(playerPixelRawCoordinate[VERTICAL_AXIS] * rawPlayerDimensions[HORIZONTAL_AXIS]) +
-						playerPixelRawCoordinate[HORIZONTAL_AXIS];
+	CollisionCandidates::const_iterator iterator;
 
-					int rawObstaclePixelIndex =
-						(obstaclePixelRawCoordinate[VERTICAL_AXIS] * rawObstacleDimensions[HORIZONTAL_AXIS]) +
-						obstaclePixelRawCoordinate[HORIZONTAL_AXIS];
+	for (iterator = candidates->begin(); iterator != candidates->end(); iterator++)
+	{
+		if (!(*iterator)->bBlockable)
+		{
+			continue;
+		}
 
-					uint32_t * dPtrPlayer = reinterpret_cast<uint32_t*>(playerPixels);
-					uint32_t * dPtrObstacle = reinterpret_cast<uint32_t*>(obstaclePixels);
+		int obstacleTopLeft[2];
+		obstacleTopLeft[HORIZONTAL_AXIS] = (int)(*iterator)->pos.x - width / 2;
+		obstacleTopLeft[VERTICAL_AXIS] = (int)(*iterator)->pos.y - height / 2;
 
-					int playerResult =
-						(dPtrPlayer[rawPlayerPixelIndex] & 0xff000000) >> 24;
+		float timeOfImpact;
 
-					int obstacleResult =
-						(dPtrObstacle[rawObstaclePixelIndex] & 0xff000000) >> 24;
+		// The same test Detect uses, so a move stops where Detect
+		//	would first find the two touching.
+		if (bFieldsReady)
+		{
+			if (!SweptCollision::SweptField(
+				&playerMasks->field,
+				playerTopLeft,
+				displacement,
+				&obstacleMasks->field,
+				obstacleTopLeft,
+				width,
+				height,
+				&timeOfImpact))
+			{
+				continue;
+			}
+		}
+		else if (bMasksReady)
+		{
+			if (!SweptCollision::SweptMask(
+				&playerMasks->packed,
+				playerTopLeft,
+				displacement,
+				&obstacleMasks->packed,
+				obstacleTopLeft,
+				&timeOfImpact))
+			{
+				continue;
+			}
+		}
+		else
+		{
+			BoundingBox obstacleBox;
+			obstacleBox.lowerBound = float2((float)obstacleTopLeft[HORIZONTAL_AXIS], (float)obstacleTopLeft[VERTICAL_AXIS]);
+			obstacleBox.upperBound = float2(obstacleBox.lowerBound.x + width, obstacleBox.lowerBound.y + height);
 
-					if (playerResult > 0 && obstacleResult > 0)
-					{
-						delete[] playerPixels;
-						delete[] obstaclePixels;
+			float exit;
+			int axis;
 
-						return COLLISION;
-					}
-				}
+			if (!SweptCollision::SweptBox(playerBox, displacement, obstacleBox, &timeOfImpact, &exit, &axis) ||
+				timeOfImpact < 0.0f)
+			{
+				continue;
 			}
 		}
 
-		delete[] playerPixels;
-		delete[] obstaclePixels;
-		return INTERSECTION;
+		if (timeOfImpact < retVal)
+		{
+			retVal = timeOfImpact;
+		}
 	}
 
-	delete [] playerPixels;
-	delete [] obstaclePixels;
-
-	return NO_INTERSECTION;
+	return retVal;
 }
 
+bool NarrowCollisionStrategy::TestPair(
+	CollisionMaskSet * aMasks,
+	int * aTopLeft,
+	CollisionMaskSet * bMasks,
+	int * bTopLeft,
+	int * renderedSpriteDimensions,
+	DistanceFieldContact * contact)
+{
+	int intersectRect[4];
+
+	if (!IntersectRect(
+		aTopLeft,
+		bTopLeft,
+		renderedSpriteDimensions[WIDTH_INDEX],
+		renderedSpriteDimensions[HEIGHT_INDEX],
+		intersectRect))
+	{
+		return false;
+	}
+
+	contact->normal = float2(0.0f, 0.0f);
 
-uint8_t * NarrowCollisionStrategy::readPixels(
-	ID3D11DeviceContext2 * context,
-	ID3D11Device2 * device,
-	ID3D11Texture2D * texture,
-	int * dimensions)
+	if (UseDistanceFields(aMasks, bMasks))
+	{
+		if (!DistanceField::Overlap(
+			&aMasks->field,
+			aTopLeft,
+			&bMasks->field,
+			bTopLeft,
+			renderedSpriteDimensions[WIDTH_INDEX],
+			renderedSpriteDimensions[HEIGHT_INDEX],
+			contact))
+		{
+			return false;
+		}
+	}
+	else if (!TestPixels(
+		aMasks,
+		bMasks,
+		aTopLeft,
+		bTopLeft,
+		renderedSpriteDimensions,
+		intersectRect))
+	{
+		return false;
+	}
+
+	if (contact->normal.x != 0.0f || contact->normal.y != 0.0f)
+	{
+		return true;
+	}
+
+	// Along the shorter side of the intersection, as AddContact does.
+	int overlapWidth = intersectRect[INTERSECTION_RIGHT] - intersectRect[INTERSECTION_LEFT];
+	int overlapHeight = intersectRect[INTERSECTION_BOTTOM] - intersectRect[INTERSECTION_TOP];
+
+	if (overlapWidth < overlapHeight)
+	{
+		contact->depth = (float)overlapWidth;
+		contact->normal = float2(aTopLeft[HORIZONTAL_AXIS] < bTopLeft[HORIZONTAL_AXIS] ? -1.0f : 1.0f, 0.0f);
+	}
+	else
+	{
+		contact->depth = (float)overlapHeight;
+		contact->normal = float2(0.0f, aTopLeft[VERTICAL_AXIS] < bTopLeft[VERTICAL_AXIS] ? -1.0f : 1.0f);
+	}
+
+	return true;
+}
+
+// The rectangle reported for the diagnostics is the first
+//	collision, or the first intersection if nothing collides.
+//	Collisions also go to the event stream.
+void NarrowCollisionStrategy::UpdateResult(
+	BaseSpriteData * sprite,
+	bool bCollision,
+	int * candidateRect,
+	int * intersectRect,
+	int * result)
 {
-	HBITMAP	hBitmapTexture = NULL;
-	HGDIOBJ hBitmap;
+	if (bCollision && m_pEvents != NULL)
+	{
+		m_pEvents->AddPair(m_pPlayerSprite, sprite);
+	}
 
-	ID3D11Texture2D* d3dtex = (ID3D11Texture2D*)texture;
-	D3D11_TEXTURE2D_DESC desc;
-	d3dtex->GetDesc(&desc);
+	if ((bCollision && *result != COLLISION) || *result == NO_INTERSECTION)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			intersectRect[i] = candidateRect[i];
+		}
+	}
 
-	ID3D11Texture2D* pNewTexture = NULL;
-	D3D11_TEXTURE2D_DESC description;
-	d3dtex->GetDesc(&description);
+	if (bCollision)
+	{
+		*result = COLLISION;
+	}
+	else if (*result == NO_INTERSECTION)
+	{
+		*result = INTERSECTION;
+	}
+}
 
-	description.BindFlags = 0;
+// Resolves along the axis of least overlap, like a box-box contact.
+void NarrowCollisionStrategy::AddContact(
+	int * playerTopLeft,
+	int * obstacleTopLeft,
+	int * intersectRect,
+	DirectionalCollsionDetectionInfo * contacts)
+{
+	int overlapWidth = intersectRect[INTERSECTION_RIGHT] - intersectRect[INTERSECTION_LEFT];
+	int overlapHeight = intersectRect[INTERSECTION_BOTTOM] - intersectRect[INTERSECTION_TOP];
 
-	description.CPUAccessFlags = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE;
-	description.Usage = D3D11_USAGE_STAGING;
-	HRESULT hr = device->CreateTexture2D(&description, NULL, &pNewTexture);
+	if (overlapWidth < overlapHeight)
+	{
+		contacts->AddContact(
+			HORIZONTAL_AXIS,
+			(float)overlapWidth,
+			playerTopLeft[HORIZONTAL_AXIS] < obstacleTopLeft[HORIZONTAL_AXIS] ? -1.0f : 1.0f);
+	}
+	else
+	{
+		contacts->AddContact(
+			VERTICAL_AXIS,
+			(float)overlapHeight,
+			playerTopLeft[VERTICAL_AXIS] < obstacleTopLeft[VERTICAL_AXIS] ? -1.0f : 1.0f);
+	}
+}
 
-	ID3D11DeviceContext* ctx = NULL;
-	device->GetImmediateContext(&ctx);
+bool NarrowCollisionStrategy::TestPixels(
+	CollisionMaskSet * playerMasks,
+	CollisionMaskSet * obstacleMasks,
+	int * playerTopLeft,
+	int * obstacleTopLeft,
+	int * renderedSpriteDimensions,
+	int * intersectRect)
+{
+	PackedCollisionMask * playerPacked = &playerMasks->packed;
+	PackedCollisionMask * obstaclePacked = &obstacleMasks->packed;
+
+	// The scaled masks are only usable once they have been
+	//	built at the size the sprites are rendered at.
+	bool bScaledReady =
+		playerPacked->GetWidth() == renderedSpriteDimensions[WIDTH_INDEX] &&
+		playerPacked->GetHeight() == renderedSpriteDimensions[HEIGHT_INDEX] &&
+		obstaclePacked->GetWidth() == renderedSpriteDimensions[WIDTH_INDEX] &&
+		obstaclePacked->GetHeight() == renderedSpriteDimensions[HEIGHT_INDEX];
+
+	// The fields do not depend on the rendered size.
+	if (UseDistanceFields(playerMasks, obstacleMasks))
+	{
+		return DistanceField::Overlap(
+			&playerMasks->field,
+			playerTopLeft,
+			&obstacleMasks->field,
+			obstacleTopLeft,
+			renderedSpriteDimensions[WIDTH_INDEX],
+			renderedSpriteDimensions[HEIGHT_INDEX],
+			NULL);
+	}
 
-	ctx->CopyResource(pNewTexture, d3dtex);
+	if (m_nMode == NARROW_PHASE_POLYGON &&
+		playerMasks->scaledShape.GetWidth() == renderedSpriteDimensions[WIDTH_INDEX] &&
+		playerMasks->scaledShape.GetHeight() == renderedSpriteDimensions[HEIGHT_INDEX] &&
+		obstacleMasks->scaledShape.GetWidth() == renderedSpriteDimensions[WIDTH_INDEX] &&
+		obstacleMasks->scaledShape.GetHeight() == renderedSpriteDimensions[HEIGHT_INDEX])
+	{
+		return CollisionShape::Overlap(
+			&playerMasks->scaledShape,
+			playerTopLeft,
+			&obstacleMasks->scaledShape,
+			obstacleTopLeft);
+	}
 
-	D3D11_MAPPED_SUBRESOURCE resource;
-	UINT subresource = D3D11CalcSubresource(0, 0, 0);
-	ctx->Map(pNewTexture, subresource, D3D11_MAP_READ_WRITE, 0, &resource);
+	if (m_nMode == NARROW_PHASE_HIERARCHY && bScaledReady)
+	{
+		return CollisionMaskHierarchy::Overlap(
+			&playerMasks->hierarchy,
+			playerPacked,
+			playerTopLeft,
+			&obstacleMasks->hierarchy,
+			obstaclePacked,
+			obstacleTopLeft,
+			intersectRect);
+	}
 
-	// COPY from texture to bitmap buffer
-	uint8_t* sptr = reinterpret_cast<uint8_t*>(resource.pData);
-	uint8_t* dptr = new uint8_t[desc.Width * desc.Height * 4];
+	if (m_nMode == NARROW_PHASE_PACKED && bScaledReady)
+	{
+		return PackedCollisionMask::Overlap(
+			playerPacked,
+			playerTopLeft,
+			obstaclePacked,
+			obstacleTopLeft,
+			intersectRect);
+	}
 
-	for (size_t h = 0; h < desc.Height; ++h)
+	if (m_nMode == NARROW_PHASE_ALPHA && bScaledReady)
 	{
-		size_t msize = std::min<size_t>(desc.Width * 4, resource.RowPitch);
-		memcpy_s(dptr, desc.Width * 4, sptr, msize);
-		sptr += resource.RowPitch;
-		dptr += desc.Width * 4;
+		return CollisionMask::Overlap(
+			&playerMasks->scaled,
+			playerTopLeft,
+			&obstacleMasks->scaled,
+			obstacleTopLeft,
+			intersectRect);
 	}
 
-	dptr -= desc.Width*desc.Height * 4;
+	return TestPerPixel(
+		&playerMasks->mask,
+		&obstacleMasks->mask,
+		playerTopLeft,
+		obstacleTopLeft,
+		renderedSpriteDimensions,
+		intersectRect);
+}
 
-	// SWAP BGR to RGB bitmap
-	// Notice the capital "P". dptr vs dPtr.
-	uint32_t * dPtr = reinterpret_cast<uint32_t*>(dptr);
+// Maps every screen pixel in the intersection back to raw texture space.
+bool NarrowCollisionStrategy::TestPerPixel(
+	CollisionMask * playerMask,
+	CollisionMask * obstacleMask,
+	int * playerTopLeft,
+	int * obstacleTopLeft,
+	int * renderedSpriteDimensions,
+	int * intersectRect)
+{
+	int rawPlayerDimensions[2];
+	int rawObstacleDimensions[2];
+
+	// These are the dimensions of the raw sprite.
+	rawPlayerDimensions[WIDTH_INDEX] = playerMask->GetWidth();
+	rawPlayerDimensions[HEIGHT_INDEX] = playerMask->GetHeight();
 
-//	int size = 0;
+	// These are the dimensions of the raw sprite.
+	rawObstacleDimensions[WIDTH_INDEX] = obstacleMask->GetWidth();
+	rawObstacleDimensions[HEIGHT_INDEX] = obstacleMask->GetHeight();
 
-/*
-	for (size_t count = 0; count < desc.Width * desc.Height; count++)
+	int intersectionWidth = abs(intersectRect[INTERSECTION_LEFT] - intersectRect[INTERSECTION_RIGHT]);
+	int intersectionHeight = abs(intersectRect[INTERSECTION_TOP] - intersectRect[INTERSECTION_BOTTOM]);
+
+	for (int row = 0; row < intersectionHeight; row++)
 	{
-		uint32_t t = *(dPtr);
-		uint32_t alpha = (t & 0xff000000) >> 24;
-		uint32_t red = (t & 0x00ff0000) >> 16;
-		uint32_t green = (t & 0x0000ff00) >> 8;
-		uint32_t blue = (t & 0x000000ff);
+		for (int column = 0; column < intersectionWidth; column++)
+		{
 
+			// These coordinates are relative to the whole screen.
+			int playerIntersectionHorizontalOffset = intersectRect[0] - playerTopLeft[0] + column;
+			int playerIntersectionVerticalOffset = intersectRect[2] - playerTopLeft[1] + row;
 
-				//char buf[64];
-				//sprintf_s(buf, "%02x %02x %02x %02x\n", red, green, blue, alpha);
-				//OutputDebugStringA(buf);
+			// These coordinates are relative to the whole screen.
+			int obstacleIntersectionHorizontalOffset = intersectRect[0] - obstacleTopLeft[0] + column;
+			int obstacleIntersectionVerticalOffset = intersectRect[2] - obstacleTopLeft[1] + row;
 
 
-				//if (red > 0 || green > 0 || blue > 0)
-				//{
-				//	*(dPtr++) = 0xffffffff;
-				//}
-				//else
-				//{
-				//	*(dPtr++) = 0x00000000;
-				//}
+			float playerPixelNormalizedLocation[2];
+			int playerPixelRawCoordinate[2];
+			float obstaclePixelNormalizedLocation[2];
+			int obstaclePixelRawCoordinate[2];
 
-		*(dPtr++) = red | green | blue | alpha;
+			// Relative to the raw sprite dimensions (0, 1.0f)
+			playerPixelNormalizedLocation[HORIZONTAL_AXIS] =
+				(float)playerIntersectionHorizontalOffset / (float)renderedSpriteDimensions[HORIZONTAL_AXIS];
 
-//		size++;
-	}
-*/
+			// Relative to the raw sprite dimensions (0, 1.0f)
+			playerPixelNormalizedLocation[VERTICAL_AXIS] =
+				(float)playerIntersectionVerticalOffset / (float)renderedSpriteDimensions[VERTICAL_AXIS];
 
-/*
-	char buf[128];
-	sprintf_s(buf, "num sprite pixels = %d\n", size);
-	OutputDebugStringA(buf);
-*/
+			// Relative to the raw sprite dimensions (0, 1.0f)
+			obstaclePixelNormalizedLocation[HORIZONTAL_AXIS] =
+				(float)obstacleIntersectionHorizontalOffset / (float)renderedSpriteDimensions[HORIZONTAL_AXIS];
 
-	/*
-		hBitmapTexture = CreateCompatibleBitmap(GetDC(NULL), desc.Width, desc.Height);
-		SetBitmapBits(hBitmapTexture, desc.Width*desc.Height * 4, dptr);
+			// Relative to the raw sprite dimensions (0, 1.0f)
+			obstaclePixelNormalizedLocation[VERTICAL_AXIS] =
+				(float)obstacleIntersectionVerticalOffset / (float)renderedSpriteDimensions[VERTICAL_AXIS];
 
-		hBitmap = CopyImage(hBitmapTexture, IMAGE_BITMAP, desc.Width, desc.Height, LR_CREATEDIBSECTION);
-	*/
-	*(dimensions + WIDTH_INDEX) = desc.Width;
-	*(dimensions + HEIGHT_INDEX) = desc.Height;
+			playerPixelRawCoordinate[HORIZONTAL_AXIS] =
+				playerPixelNormalizedLocation[HORIZONTAL_AXIS] * rawPlayerDimensions[HORIZONTAL_AXIS];
 
-	return dptr;
-}
+			playerPixelRawCoordinate[VERTICAL_AXIS] =
+				playerPixelNormalizedLocation[VERTICAL_AXIS] * rawPlayerDimensions[VERTICAL_AXIS];
+
+			obstaclePixelRawCoordinate[HORIZONTAL_AXIS] =
+				obstaclePixelNormalizedLocation[HORIZONTAL_AXIS] * rawObstacleDimensions[HORIZONTAL_AXIS];
+
+			obstaclePixelRawCoordinate[VERTICAL_AXIS] =
+				obstaclePixelNormalizedLocation[VERTICAL_AXIS] * rawObstacleDimensions[VERTICAL_AXIS];
+
+			int playerResult = playerMask->GetAlpha(
+				playerPixelRawCoordinate[HORIZONTAL_AXIS],
+				playerPixelRawCoordinate[VERTICAL_AXIS]);
+
+			int obstacleResult = obstacleMask->GetAlpha(
+				obstaclePixelRawCoordinate[HORIZONTAL_AXIS],
+				obstaclePixelRawCoordinate[VERTICAL_AXIS]);
+
+			if (playerResult > 0 && obstacleResult > 0)
+			{
+				return true;
+			}
+		}
+	}
 
+	return false;
+}
 
 // Project the coordinates of each rectangle to the
 //	x and y axes. The second and third values will be 
@@ -389,22 +673,15 @@ void NarrowCollisionStrategy::InsertionSort(int values [], int length)
 	}
 }
 
-void NarrowCollisionStrategy::DumpPixels(int width, int height, uint8_t * data)
+void NarrowCollisionStrategy::DumpPixels(CollisionMask * mask)
 {
-	uint32_t * dPtr = reinterpret_cast<uint32_t*>(data);
-
-	for (size_t count = 0; count < width * height; count++)
+	for (int row = 0; row < mask->GetHeight(); row++)
 	{
-		uint32_t t = *(dPtr);
-		uint32_t alpha = (t & 0xff000000) >> 24;
-		uint32_t red = (t & 0x00ff0000) >> 16;
-		uint32_t green = (t & 0x0000ff00) >> 8;
-		uint32_t blue = (t & 0x000000ff);
-
-		char buf[64];
-		sprintf_s(buf, "a=%x r=%x g=%x b=%x\n", alpha, red, green, blue);
-		OutputDebugStringA(buf);
-
-		dPtr++;
+		for (int column = 0; column < mask->GetWidth(); column++)
+		{
+			char buf[64];
+			sprintf_s(buf, "a=%x\n", mask->GetAlpha(column, row));
+			OutputDebugStringA(buf);
+		}
 	}
 }
@@ -4,8 +4,11 @@
 #include "Player.h"
 #include "BaseSpriteData.h"
 #include "GridSpace.h"
-#include "BasicSprites.h"
-#include <list>
+#include "CollisionMaskSet.h"
+#include "DirectionalCollisionDetectionInfo.h"
+#include "CollisionCandidates.h"
+#include "CollisionPairCache.h"
+#include "CollisionEventStream.h"
 
 
 class NarrowCollisionStrategy
@@ -14,25 +17,95 @@ public:
 	NarrowCollisionStrategy();
 	~NarrowCollisionStrategy();
 
+	// The masks come from the CollisionMaskCache, so no
+	//	device access is needed here. Every candidate is tested;
+	//	each one that collides adds a contact to contacts.
+	//	Returns the strongest state over all candidates.
 	int Detect(
-		ID3D11DeviceContext2 * context,
-		ID3D11Device2 * device,
-		ID3D11Texture2D * texture1,
-		ID3D11Texture2D * texture2,
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
 		Player * pPlayer,
-		std::list<BaseSpriteData *> * sprites,
+		CollisionCandidates * sprites,
 		float * playerLocation,
 		Grid * grid,
+		int * intersectRect,
+		DirectionalCollsionDetectionInfo * contacts);
+
+	// Earliest time in [0, 1] at which the player, moving by
+	//	displacement screen pixels, touches one of the candidates;
+	//	1 if nothing is hit. Candidates it already touches are left
+	//	to Detect. Uses the distance fields in that mode, else the
+	//	packed masks, or the sprite rectangles while the masks are
+	//	not built at the rendered size.
+	float TimeOfImpact(
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		CollisionCandidates * candidates,
+		float * playerLocation,
+		float2 displacement,
+		Grid * grid);
+
+	// NARROW_PHASE_PER_PIXEL, NARROW_PHASE_PACKED, NARROW_PHASE_ALPHA,
+	//	NARROW_PHASE_HIERARCHY (the default), NARROW_PHASE_POLYGON or
+	//	NARROW_PHASE_DISTANCE_FIELD. The paths do not all agree
+	//	exactly, so cached results are dropped. Only the distance
+	//	fields give contacts a true depth and direction; the others
+	//	resolve along the shorter side of the intersection.
+	void SetMode(int nMode)
+	{
+		m_nMode = nMode;
+		m_pairCache.Clear();
+	}
+
+	int GetMode()
+	{
+		return m_nMode;
+	}
+
+	// Every candidate that collides is added to events as a pair
+	//	with playerSprite, which stands for the player. NULL stops it.
+	void SetEventStream(CollisionEventStream * events, BaseSpriteData * playerSprite)
+	{
+		m_pEvents = events;
+		m_pPlayerSprite = playerSprite;
+	}
+
+	// Results of pairs that have not moved relative to each other.
+	//	Clear it whenever CollisionMaskCache::GetVersion changes.
+	CollisionPairCache * GetPairCache()
+	{
+		return &m_pairCache;
+	}
+
+	// Pixel-level test of one pair whose bounding boxes intersect.
+	//	Public so that the paths can be compared in CollisionBenchmark.
+	bool TestPixels(
+		CollisionMaskSet * playerMasks,
+		CollisionMaskSet * obstacleMasks,
+		int * playerTopLeft,
+		int * obstacleTopLeft,
+		int * renderedSpriteDimensions,
 		int * intersectRect);
 
-protected:
-private:
+	// Tests two sprites, each filling one grid space, without the
+	//	pair cache or the event stream, so that several threads can
+	//	test pairs at once. On a collision, contact gets the depth and
+	//	the direction that pushes a out of b.
+	bool TestPair(
+		CollisionMaskSet * aMasks,
+		int * aTopLeft,
+		CollisionMaskSet * bMasks,
+		int * bTopLeft,
+		int * renderedSpriteDimensions,
+		DistanceFieldContact * contact);
 
-	uint8_t * readPixels(
-		ID3D11DeviceContext2 * context,
-		ID3D11Device2 * device,
-		ID3D11Texture2D * texture,
-		int * dimensions);
+	bool TestPerPixel(
+		CollisionMask * playerMask,
+		CollisionMask * obstacleMask,
+		int * playerTopLeft,
+		int * obstacleTopLeft,
+		int * renderedSpriteDimensions,
+		int * intersectRect);
 
 	bool IntersectRect(
 		int * playerTopLeft,
@@ -41,7 +114,38 @@ private:
 		int height,
 		int * retVal);
 
+protected:
+private:
+
 	void InsertionSort(int values[], int length);
 
-	void DumpPixels(int width, int height, uint8_t * data);
+	// In NARROW_PHASE_DISTANCE_FIELD, once both fields are built.
+	bool UseDistanceFields(CollisionMaskSet * aMasks, CollisionMaskSet * bMasks)
+	{
+		return m_nMode == NARROW_PHASE_DISTANCE_FIELD &&
+			!aMasks->field.IsEmpty() &&
+			!bMasks->field.IsEmpty();
+	}
+
+	void UpdateResult(
+		BaseSpriteData * sprite,
+		bool bCollision,
+		int * candidateRect,
+		int * intersectRect,
+		int * result);
+
+	void AddContact(
+		int * playerTopLeft,
+		int * obstacleTopLeft,
+		int * intersectRect,
+		DirectionalCollsionDetectionInfo * contacts);
+
+	void DumpPixels(CollisionMask * mask);
+
+	int m_nMode;
+
+	CollisionPairCache m_pairCache;
+
+	CollisionEventStream * m_pEvents;
+	BaseSpriteData * m_pPlayerSprite;
 };
\ No newline at end of file
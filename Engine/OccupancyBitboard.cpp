@@ -0,0 +1,281 @@
+#include "pch.h"
+#include "OccupancyBitboard.h"
+
+namespace
+{
+	int CountBits(uint64_t word)
+	{
+		int retVal = 0;
+
+		while (word != 0)
+		{
+			word &= word - 1;
+			retVal++;
+		}
+
+		return retVal;
+	}
+}
+
+OccupancyBitboard::OccupancyBitboard()
+{
+	Clear();
+}
+
+void OccupancyBitboard::Clear()
+{
+	for (int word = 0; word < OCCUPANCY_WORDS; word++)
+	{
+		m_words[word] = 0;
+	}
+}
+
+void OccupancyBitboard::Set(int column, int row)
+{
+	if (column < 0 || column >= NUM_GRID_COLUMNS || row < 0 || row >= NUM_GRID_ROWS)
+	{
+		return;
+	}
+
+	int bit = GetBit(column, row);
+	m_words[bit >> 6] |= (uint64_t)1 << (bit & 63);
+}
+
+void OccupancyBitboard::Reset(int column, int row)
+{
+	if (column < 0 || column >= NUM_GRID_COLUMNS || row < 0 || row >= NUM_GRID_ROWS)
+	{
+		return;
+	}
+
+	int bit = GetBit(column, row);
+	m_words[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+}
+
+void OccupancyBitboard::Build(std::vector<BaseSpriteData *> * sprites)
+{
+	Clear();
+
+	std::vector<BaseSpriteData *>::const_iterator iterator;
+
+	for (iterator = sprites->begin(); iterator != sprites->end(); iterator++)
+	{
+		if ((*iterator)->bCollidable && (*iterator)->bBlockable)
+		{
+			Set((*iterator)->column, (*iterator)->row);
+		}
+	}
+}
+
+bool OccupancyBitboard::IsOccupied(int column, int row)
+{
+	if (column < 0 || column >= NUM_GRID_COLUMNS || row < 0 || row >= NUM_GRID_ROWS)
+	{
+		return false;
+	}
+
+	int bit = GetBit(column, row);
+
+	return (m_words[bit >> 6] & ((uint64_t)1 << (bit & 63))) != 0;
+}
+
+bool OccupancyBitboard::AnyOccupied(int minColumn, int minRow, int maxColumn, int maxRow)
+{
+	if (minColumn < 0) minColumn = 0;
+	if (minRow < 0) minRow = 0;
+	if (maxColumn > NUM_GRID_COLUMNS - 1) maxColumn = NUM_GRID_COLUMNS - 1;
+	if (maxRow > NUM_GRID_ROWS - 1) maxRow = NUM_GRID_ROWS - 1;
+
+	if (minColumn > maxColumn || minRow > maxRow)
+	{
+		return false;
+	}
+
+	// One run of bits per row of the range.
+	OccupancyBitboard range;
+
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		range.SetBits(GetBit(minColumn, row), maxColumn - minColumn + 1);
+	}
+
+	return !(*this & range).IsEmpty();
+}
+
+bool OccupancyBitboard::IsEmpty()
+{
+	uint64_t any = 0;
+
+	for (int word = 0; word < OCCUPANCY_WORDS; word++)
+	{
+		any |= m_words[word];
+	}
+
+	return any == 0;
+}
+
+int OccupancyBitboard::GetCount()
+{
+	int retVal = 0;
+
+	for (int word = 0; word < OCCUPANCY_WORDS; word++)
+	{
+		retVal += CountBits(m_words[word]);
+	}
+
+	return retVal;
+}
+
+int OccupancyBitboard::GetNeighbourMask(int column, int row)
+{
+	int retVal = 0;
+
+	if (IsOccupied(column, row - 1)) retVal |= NEIGHBOUR_NORTH;
+	if (IsOccupied(column + 1, row - 1)) retVal |= NEIGHBOUR_NORTH_EAST;
+	if (IsOccupied(column + 1, row)) retVal |= NEIGHBOUR_EAST;
+	if (IsOccupied(column + 1, row + 1)) retVal |= NEIGHBOUR_SOUTH_EAST;
+	if (IsOccupied(column, row + 1)) retVal |= NEIGHBOUR_SOUTH;
+	if (IsOccupied(column - 1, row + 1)) retVal |= NEIGHBOUR_SOUTH_WEST;
+	if (IsOccupied(column - 1, row)) retVal |= NEIGHBOUR_WEST;
+	if (IsOccupied(column - 1, row - 1)) retVal |= NEIGHBOUR_NORTH_WEST;
+
+	return retVal;
+}
+
+OccupancyBitboard OccupancyBitboard::ShiftNorth()
+{
+	return Shift(-NUM_GRID_COLUMNS);
+}
+
+OccupancyBitboard OccupancyBitboard::ShiftSouth()
+{
+	// Rows pushed past the bottom are dropped.
+	OccupancyBitboard screen;
+	screen.SetBits(0, NUM_GRID_COLUMNS * NUM_GRID_ROWS);
+
+	return Shift(NUM_GRID_COLUMNS) & screen;
+}
+
+OccupancyBitboard OccupancyBitboard::ShiftEast()
+{
+	// The last column would otherwise wrap into the next row.
+	OccupancyBitboard lastColumn;
+
+	for (int row = 0; row < NUM_GRID_ROWS; row++)
+	{
+		lastColumn.SetBits(GetBit(NUM_GRID_COLUMNS - 1, row), 1);
+	}
+
+	return (*this & ~lastColumn).Shift(1);
+}
+
+OccupancyBitboard OccupancyBitboard::ShiftWest()
+{
+	OccupancyBitboard firstColumn;
+
+	for (int row = 0; row < NUM_GRID_ROWS; row++)
+	{
+		firstColumn.SetBits(GetBit(0, row), 1);
+	}
+
+	return (*this & ~firstColumn).Shift(-1);
+}
+
+OccupancyBitboard OccupancyBitboard::operator&(const OccupancyBitboard & other) const
+{
+	OccupancyBitboard retVal;
+
+	for (int word = 0; word < OCCUPANCY_WORDS; word++)
+	{
+		retVal.m_words[word] = m_words[word] & other.m_words[word];
+	}
+
+	return retVal;
+}
+
+OccupancyBitboard OccupancyBitboard::operator|(const OccupancyBitboard & other) const
+{
+	OccupancyBitboard retVal;
+
+	for (int word = 0; word < OCCUPANCY_WORDS; word++)
+	{
+		retVal.m_words[word] = m_words[word] | other.m_words[word];
+	}
+
+	return retVal;
+}
+
+OccupancyBitboard OccupancyBitboard::operator~() const
+{
+	OccupancyBitboard retVal;
+
+	for (int word = 0; word < OCCUPANCY_WORDS; word++)
+	{
+		retVal.m_words[word] = ~m_words[word];
+	}
+
+	return retVal;
+}
+
+void OccupancyBitboard::SetBits(int start, int count)
+{
+	while (count > 0)
+	{
+		int word = start >> 6;
+		int offset = start & 63;
+		int nBits = 64 - offset < count ? 64 - offset : count;
+
+		uint64_t bits = nBits == 64 ? ~(uint64_t)0 : (((uint64_t)1 << nBits) - 1);
+		m_words[word] |= bits << offset;
+
+		start += nBits;
+		count -= nBits;
+	}
+}
+
+OccupancyBitboard OccupancyBitboard::Shift(int nBits)
+{
+	OccupancyBitboard retVal;
+
+	int nWords = (nBits < 0 ? -nBits : nBits) >> 6;
+	int offset = (nBits < 0 ? -nBits : nBits) & 63;
+
+	for (int word = 0; word < OCCUPANCY_WORDS; word++)
+	{
+		uint64_t value = 0;
+
+		if (nBits >= 0)
+		{
+			// Towards higher bits: take from lower words.
+			int source = word - nWords;
+
+			if (source >= 0)
+			{
+				value = m_words[source] << offset;
+
+				if (offset > 0 && source > 0)
+				{
+					value |= m_words[source - 1] >> (64 - offset);
+				}
+			}
+		}
+		else
+		{
+			int source = word + nWords;
+
+			if (source < OCCUPANCY_WORDS)
+			{
+				value = m_words[source] >> offset;
+
+				if (offset > 0 && source + 1 < OCCUPANCY_WORDS)
+				{
+					value |= m_words[source + 1] << (64 - offset);
+				}
+			}
+		}
+
+		retVal.m_words[word] = value;
+	}
+
+	return retVal;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "Constants.h"
+#include <vector>
+
+// One bit per grid space of a screen, row by row, so the 17 x 15
+//	screen fits in four 64-bit words. Tile-aligned questions (is this
+//	space blocked, is anything in this block of spaces blocked) become
+//	a few word operations instead of a walk over the sprites.
+class OccupancyBitboard
+{
+public:
+	OccupancyBitboard();
+
+	void Clear();
+
+	void Set(int column, int row);
+	void Reset(int column, int row);
+
+	// Sets the space of every sprite that is collidable and blocks.
+	void Build(std::vector<BaseSpriteData *> * sprites);
+
+	// Spaces outside the screen are never occupied.
+	bool IsOccupied(int column, int row);
+
+	// Whether any space of the inclusive range is occupied.
+	bool AnyOccupied(int minColumn, int minRow, int maxColumn, int maxRow);
+
+	bool IsEmpty();
+	int GetCount();
+
+	// The eight neighbours of a space as bits, NEIGHBOUR_NORTH through
+	//	NEIGHBOUR_NORTH_WEST.
+	int GetNeighbourMask(int column, int row);
+
+	// The whole board moved one space. Nothing wraps from one edge of
+	//	the screen to the other. For example, board & other.ShiftWest()
+	//	is every occupied space with an occupied space to its east.
+	OccupancyBitboard ShiftNorth();
+	OccupancyBitboard ShiftSouth();
+	OccupancyBitboard ShiftEast();
+	OccupancyBitboard ShiftWest();
+
+	OccupancyBitboard operator&(const OccupancyBitboard & other) const;
+	OccupancyBitboard operator|(const OccupancyBitboard & other) const;
+	OccupancyBitboard operator~() const;
+
+protected:
+
+private:
+	// Bits start..start + count - 1.
+	void SetBits(int start, int count);
+
+	// The board shifted towards higher bits (nBits > 0) or lower bits.
+	OccupancyBitboard Shift(int nBits);
+
+	static int GetBit(int column, int row)
+	{
+		return row * NUM_GRID_COLUMNS + column;
+	}
+
+	uint64_t m_words[OCCUPANCY_WORDS];
+};
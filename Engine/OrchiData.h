@@ -8,12 +8,12 @@ struct OrchiData : public BaseSpriteData
 public:
 	OrchiData() : BaseSpriteData(0, 0, 0.0f, 0.0f)
 	{
-		
+		SetLayer(COLLISION_LAYER_PLAYER);
 	}
 
 	OrchiData(int column, int row, float x, float y) : BaseSpriteData(column, row, x, y)
 	{
-
+		SetLayer(COLLISION_LAYER_PLAYER);
 	}
 
 protected:
@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "PackedCollisionMask.h"
+#include "CollisionKernels.h"
+#include "Constants.h"
+
+PackedCollisionMask::PackedCollisionMask()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nWordsPerRow = 0;
+}
+
+PackedCollisionMask::PackedCollisionMask(
+	CollisionMask * mask,
+	int width,
+	int height)
+{
+	m_nWidth = width;
+	m_nHeight = height;
+	m_nWordsPerRow = (width + 63) / 64 + 1;
+
+	m_bits.assign(m_nWordsPerRow * height, 0);
+
+	for (int row = 0; row < height; row++)
+	{
+		// Same mapping as the per-pixel path in NarrowCollisionStrategy,
+		//	so both paths agree on every texel.
+		int rawRow = (int)((float)row / (float)height * mask->GetHeight());
+		uint64_t * destination = &m_bits[row * m_nWordsPerRow];
+
+		for (int column = 0; column < width; column++)
+		{
+			int rawColumn = (int)((float)column / (float)width * mask->GetWidth());
+
+			if (mask->IsOpaque(rawColumn, rawRow))
+			{
+				destination[column >> 6] |= (uint64_t)1 << (column & 63);
+			}
+		}
+	}
+}
+
+bool PackedCollisionMask::Overlap(
+	PackedCollisionMask * a,
+	int * aTopLeft,
+	PackedCollisionMask * b,
+	int * bTopLeft,
+	int * intersectRect)
+{
+	int left = intersectRect[INTERSECTION_LEFT];
+	int right = intersectRect[INTERSECTION_RIGHT];
+	int top = intersectRect[INTERSECTION_TOP];
+	int bottom = intersectRect[INTERSECTION_BOTTOM];
+
+	// Columns of the intersection relative to each mask.
+	int aColumn = left - aTopLeft[HORIZONTAL_AXIS];
+	int bColumn = left - bTopLeft[HORIZONTAL_AXIS];
+	int width = right - left;
+
+	CollisionKernelTable * kernels = CollisionKernels::Get();
+
+	for (int row = top; row < bottom; row++)
+	{
+		if (kernels->PackedSpanOverlap(
+			a->GetRow(row - aTopLeft[VERTICAL_AXIS]),
+			aColumn,
+			b->GetRow(row - bTopLeft[VERTICAL_AXIS]),
+			bColumn,
+			width))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "pch.h"
+#include "CollisionMask.h"
+#include <vector>
+
+// One bit per texel, resampled to the size the sprite is rendered at.
+//	Each row starts on a 64-bit word and is padded with one extra
+//	word so that a run of 64 bits can be read at any bit offset
+//	without a bounds check.
+class PackedCollisionMask
+{
+public:
+	PackedCollisionMask();
+
+	// Nearest-neighbour resample of the raw alpha to width x height.
+	PackedCollisionMask(
+		CollisionMask * mask,
+		int width,
+		int height);
+
+	int GetWidth()
+	{
+		return m_nWidth;
+	}
+
+	int GetHeight()
+	{
+		return m_nHeight;
+	}
+
+	int GetWordsPerRow()
+	{
+		return m_nWordsPerRow;
+	}
+
+	const uint64_t * GetRow(int row)
+	{
+		return &m_bits[row * m_nWordsPerRow];
+	}
+
+	bool IsSet(int column, int row)
+	{
+		return ((GetRow(row)[column >> 6] >> (column & 63)) & 1) != 0;
+	}
+
+	// Returns the 64 bits starting at bitOffset, lowest bit first.
+	static uint64_t ExtractWord(const uint64_t * row, int bitOffset)
+	{
+		int word = bitOffset >> 6;
+		int shift = bitOffset & 63;
+
+		if (shift == 0)
+		{
+			return row[word];
+		}
+
+		return (row[word] >> shift) | (row[word + 1] << (64 - shift));
+	}
+
+	// Tests whether any set bit of a overlaps any set bit of b.
+	//	The top-left corners and the intersection rectangle
+	//	(left, right, top, bottom) are in screen pixels.
+	static bool Overlap(
+		PackedCollisionMask * a,
+		int * aTopLeft,
+		PackedCollisionMask * b,
+		int * bTopLeft,
+		int * intersectRect);
+
+protected:
+
+private:
+	int m_nWidth;
+	int m_nHeight;
+	int m_nWordsPerRow;
+
+	std::vector<uint64_t> m_bits;
+};
@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "ParallelNarrowPhase.h"
+#include <algorithm>
+
+ParallelNarrowPhase::ParallelNarrowPhase(NarrowCollisionStrategy * narrow, WorkerPool * pool)
+{
+	m_pNarrow = narrow;
+	m_pPool = pool;
+	m_pEvents = NULL;
+}
+
+int ParallelNarrowPhase::Detect(
+	std::vector<CollisionPairTest> * pairs,
+	int width,
+	int height,
+	std::vector<CollisionPairResult> * results)
+{
+	for (size_t i = 0; i < pairs->size(); i++)
+	{
+		CollisionPairTest & pair = (*pairs)[i];
+
+		if (pair.b->nId < pair.a->nId)
+		{
+			std::swap(pair.a, pair.b);
+			std::swap(pair.aMasks, pair.bMasks);
+		}
+
+		pair.nKey = ((unsigned long long)pair.a->nId << 32) | pair.b->nId;
+	}
+
+	std::sort(pairs->begin(), pairs->end());
+
+	size_t nUnique = 0;
+
+	for (size_t i = 0; i < pairs->size(); i++)
+	{
+		if (nUnique == 0 || (*pairs)[nUnique - 1].nKey != (*pairs)[i].nKey)
+		{
+			(*pairs)[nUnique++] = (*pairs)[i];
+		}
+	}
+
+	pairs->resize(nUnique);
+
+	int renderedSpriteDimensions[2];
+	renderedSpriteDimensions[WIDTH_INDEX] = width;
+	renderedSpriteDimensions[HEIGHT_INDEX] = height;
+
+	int nChunks = ((int)pairs->size() + PARALLEL_NARROW_PHASE_CHUNK - 1) / PARALLEL_NARROW_PHASE_CHUNK;
+
+	if ((int)m_chunkResults.size() < nChunks)
+	{
+		m_chunkResults.resize(nChunks);
+	}
+
+	if (m_pPool != NULL)
+	{
+		m_pPool->ParallelFor(nChunks, [this, pairs, &renderedSpriteDimensions](int nChunk, int nWorker)
+		{
+			TestChunk(pairs, nChunk, renderedSpriteDimensions, &m_chunkResults[nChunk]);
+		});
+	}
+	else
+	{
+		for (int i = 0; i < nChunks; i++)
+		{
+			TestChunk(pairs, i, renderedSpriteDimensions, &m_chunkResults[i]);
+		}
+	}
+
+	// The pairs were sorted, so joining the chunks in order keeps
+	//	the results sorted too.
+	size_t nFirst = results->size();
+
+	for (int i = 0; i < nChunks; i++)
+	{
+		results->insert(results->end(), m_chunkResults[i].begin(), m_chunkResults[i].end());
+	}
+
+	if (m_pEvents != NULL)
+	{
+		for (size_t i = nFirst; i < results->size(); i++)
+		{
+			m_pEvents->AddPair((*results)[i].a, (*results)[i].b);
+		}
+	}
+
+	return (int)(results->size() - nFirst);
+}
+
+void ParallelNarrowPhase::TestChunk(
+	std::vector<CollisionPairTest> * pairs,
+	int nChunk,
+	int * renderedSpriteDimensions,
+	std::vector<CollisionPairResult> * results)
+{
+	results->clear();
+
+	int nEnd = (std::min)((nChunk + 1) * PARALLEL_NARROW_PHASE_CHUNK, (int)pairs->size());
+
+	for (int i = nChunk * PARALLEL_NARROW_PHASE_CHUNK; i < nEnd; i++)
+	{
+		const CollisionPairTest & pair = (*pairs)[i];
+
+		// Same layout as the narrow phase: centred on the sprite.
+		int aTopLeft[2];
+		aTopLeft[HORIZONTAL_AXIS] = (int)pair.a->pos.x - renderedSpriteDimensions[WIDTH_INDEX] / 2;
+		aTopLeft[VERTICAL_AXIS] = (int)pair.a->pos.y - renderedSpriteDimensions[HEIGHT_INDEX] / 2;
+
+		int bTopLeft[2];
+		bTopLeft[HORIZONTAL_AXIS] = (int)pair.b->pos.x - renderedSpriteDimensions[WIDTH_INDEX] / 2;
+		bTopLeft[VERTICAL_AXIS] = (int)pair.b->pos.y - renderedSpriteDimensions[HEIGHT_INDEX] / 2;
+
+		DistanceFieldContact contact;
+
+		if (m_pNarrow->TestPair(
+			pair.aMasks,
+			aTopLeft,
+			pair.bMasks,
+			bTopLeft,
+			renderedSpriteDimensions,
+			&contact))
+		{
+			CollisionPairResult result;
+			result.a = pair.a;
+			result.b = pair.b;
+			result.nKey = pair.nKey;
+			result.normal = contact.normal;
+			result.depth = contact.depth;
+
+			results->push_back(result);
+		}
+	}
+}
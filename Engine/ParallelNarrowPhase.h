@@ -0,0 +1,89 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "CollisionMaskSet.h"
+#include "NarrowCollisionStrategy.h"
+#include "CollisionEventStream.h"
+#include "WorkerPool.h"
+#include "Constants.h"
+#include <vector>
+
+// A pair of sprites for ParallelNarrowPhase, with the masks of each.
+struct CollisionPairTest
+{
+	BaseSpriteData * a;
+	BaseSpriteData * b;
+	CollisionMaskSet * aMasks;
+	CollisionMaskSet * bMasks;
+
+	// The ids of the pair, lower first; filled in by Detect.
+	unsigned long long nKey;
+
+	bool operator<(const CollisionPairTest & other) const
+	{
+		return nKey < other.nKey;
+	}
+};
+
+struct CollisionPairResult
+{
+	// a has the lower nId of the two.
+	BaseSpriteData * a;
+	BaseSpriteData * b;
+	unsigned long long nKey;
+
+	// Pushes a out of b.
+	float2 normal;
+	float depth;
+};
+
+// The narrow phase for pairs of sprites (enemies, projectiles),
+//	spread over a WorkerPool. The pairs are sorted on their ids and
+//	cut into chunks of PARALLEL_NARROW_PHASE_CHUNK, so that one job
+//	works through neighbouring pairs, which mostly share a sprite
+//	and its masks. Each chunk writes to a buffer of its own and the
+//	buffers are joined in chunk order, so the results are the same,
+//	and in the same order, whatever the number of workers.
+class ParallelNarrowPhase
+{
+public:
+	// pool may be NULL, which tests every pair on the caller.
+	ParallelNarrowPhase(NarrowCollisionStrategy * narrow, WorkerPool * pool);
+
+	void SetWorkerPool(WorkerPool * pool)
+	{
+		m_pPool = pool;
+	}
+
+	// Colliding pairs are also added to events, in order. NULL stops it.
+	void SetEventStream(CollisionEventStream * events)
+	{
+		m_pEvents = events;
+	}
+
+	// Tests every pair, as if every sprite filled a grid space of
+	//	width x height pixels, and appends the ones that collide to
+	//	results, sorted on their ids. pairs is sorted in place, and a
+	//	pair given twice is tested once. Returns the number appended.
+	int Detect(
+		std::vector<CollisionPairTest> * pairs,
+		int width,
+		int height,
+		std::vector<CollisionPairResult> * results);
+
+protected:
+
+private:
+	void TestChunk(
+		std::vector<CollisionPairTest> * pairs,
+		int nChunk,
+		int * renderedSpriteDimensions,
+		std::vector<CollisionPairResult> * results);
+
+	NarrowCollisionStrategy * m_pNarrow;
+	WorkerPool * m_pPool;
+	CollisionEventStream * m_pEvents;
+
+	// Kept between frames so that they stop allocating.
+	std::vector<std::vector<CollisionPairResult>> m_chunkResults;
+};
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Player.h"
 #include "Constants.h"
+#include <algorithm>
 
 Player::Player(Grid * grid)
 {
@@ -18,108 +19,74 @@ Player::Player(Grid * grid)
 	UpdateGridLocation();
 }
 
-void Player::MoveNorth(int nCollisionState, float fVelocity)
+void Player::MoveNorth(DirectionalCollsionDetectionInfo * contacts, float fVelocity)
 {
-	if (nCollisionState == COLLISION && m_nPreviousMoveDirection == NORTH)
-	{
-	}
-	else
-	{
-		float prospectiveVerticalRatio =
-			m_fVerticalRatio -= fVelocity;
-
-		// Don't go above the top of the screen. 
-		//	Later this will be the trigger to move to the next screen.
-		if (prospectiveVerticalRatio >= 0.f)
-			m_fVerticalRatio = prospectiveVerticalRatio;
-		else
-			m_fVerticalRatio = 0.0f;
-
-		UpdateGridLocation();
-
-
-	}
+	Move(contacts, 0.0f, -fVelocity);
 
 	m_nPreviousMoveDirection = NORTH;
 }
 
-void Player::MoveEast(int nCollisionState, float fVelocity)
+void Player::MoveEast(DirectionalCollsionDetectionInfo * contacts, float fVelocity)
 {
-	if (nCollisionState == COLLISION && m_nPreviousMoveDirection == EAST)
-	{
-	}
-	else
-	{
-		float prospectiveHorizontalRatio =
-			m_fHorizontalRatio += fVelocity;
+	Move(contacts, fVelocity, 0.0f);
 
-		if (prospectiveHorizontalRatio <= 1.0f)
-		{
-			m_fHorizontalRatio = prospectiveHorizontalRatio;
-		}
-		else
-		{
-			m_fHorizontalRatio = 1.0f;
-		}
+	m_nPreviousMoveDirection = EAST;
+}
 
-		UpdateGridLocation();
+void Player::MoveSouth(DirectionalCollsionDetectionInfo * contacts, float fVelocity)
+{
+	Move(contacts, 0.0f, fVelocity);
 
+	m_nPreviousMoveDirection = SOUTH;
+}
 
-	}
+void Player::MoveWest(DirectionalCollsionDetectionInfo * contacts, float fVelocity)
+{
+	Move(contacts, -fVelocity, 0.0f);
 
-	m_nPreviousMoveDirection = EAST;
+	m_nPreviousMoveDirection = WEST;
 }
 
-void Player::MoveSouth(int nCollisionState, float fVelocity)
+void Player::Resolve(DirectionalCollsionDetectionInfo * contacts)
 {
-	if (nCollisionState == COLLISION && m_nPreviousMoveDirection == SOUTH)
+	float2 separation = contacts->GetSeparation();
+
+	if (separation.x == 0.0f && separation.y == 0.0f)
 	{
+		return;
 	}
-	else
-	{
-		float prospectiveVerticalOffset =
-			m_fVerticalRatio += fVelocity;
-
-		// Don't go above the top of the screen. 
-		//	Later this will be the trigger to move to the next screen.
-		if (prospectiveVerticalOffset <= 1.0f)
-			m_fVerticalRatio = prospectiveVerticalOffset;
-		else
-			m_fVerticalRatio = 1.0f;
-
-		UpdateGridLocation();
 
+	float2 gameArea = GetGameArea();
 
-	}
-
-	m_nPreviousMoveDirection = SOUTH;
+	MoveBy(separation.x / gameArea.x, separation.y / gameArea.y);
 }
 
-void Player::MoveWest(int nCollisionState, float fVelocity)
+// The contacts are in pixels and the ratios are of the game area,
+//	which is not square, so the slide is worked out in pixels.
+void Player::Move(DirectionalCollsionDetectionInfo * contacts, float dx, float dy)
 {
-	if (nCollisionState == COLLISION && m_nPreviousMoveDirection == WEST)
-	{
-	}
-	else
-	{
-		float prospectiveHorizontalOffset =
-			m_fHorizontalRatio -= fVelocity;
+	float2 gameArea = GetGameArea();
 
-		if (prospectiveHorizontalOffset >= 0.f)
-		{
-			m_fHorizontalRatio = prospectiveHorizontalOffset;
-		}
-		else
-		{
-			m_fHorizontalRatio = 0.f;
-		}
+	float2 move = contacts->Slide(float2(dx * gameArea.x, dy * gameArea.y));
 
-		UpdateGridLocation();
+	MoveBy(move.x / gameArea.x, move.y / gameArea.y);
+}
 
+// Don't go past the edges of the screen. Engine's exit triggers
+//	take the player to the next screen from there.
+void Player::MoveBy(float dx, float dy)
+{
+	m_fHorizontalRatio = (std::min)((std::max)(m_fHorizontalRatio + dx, 0.0f), 1.0f);
+	m_fVerticalRatio = (std::min)((std::max)(m_fVerticalRatio + dy, 0.0f), 1.0f);
 
-	}
+	UpdateGridLocation();
+}
 
-	m_nPreviousMoveDirection = WEST;
+float2 Player::GetGameArea()
+{
+	return float2(
+		m_grid->GetColumnWidth() * m_grid->GetNumColumns(),
+		m_grid->GetRowHeight() * m_grid->GetNumRows());
 }
 
 void Player::UpdateGridLocation()
@@ -1,16 +1,23 @@
 #pragma once
 #include "Grid.h"
 #include "Constants.h"
+#include "DirectionalCollisionDetectionInfo.h"
 
 class Player
 {
 public:
 	Player(Grid * grid);
 
-	void MoveNorth(int nCollisionState, float fVelocity);
-	void MoveEast(int nCollisionState, float fVelocity);
-	void MoveSouth(int nCollisionState, float fVelocity);
-	void MoveWest(int nCollisionState, float fVelocity);
+	// The part of a move that heads into one of the contacts is
+	//	taken out, so the player slides along walls instead of stopping.
+	void MoveNorth(DirectionalCollsionDetectionInfo * contacts, float fVelocity);
+	void MoveEast(DirectionalCollsionDetectionInfo * contacts, float fVelocity);
+	void MoveSouth(DirectionalCollsionDetectionInfo * contacts, float fVelocity);
+	void MoveWest(DirectionalCollsionDetectionInfo * contacts, float fVelocity);
+
+	// Pushes the player out of the obstacles it overlaps, by the
+	//	deepest penetration of the contacts on each axis.
+	void Resolve(DirectionalCollsionDetectionInfo * contacts);
 
 	float GetVerticalRatio()
 	{
@@ -32,6 +39,15 @@ public:
 		m_fHorizontalRatio = horizontalOffset;
 	}
 
+	// Moves the player straight there, as on entering a new screen.
+	void SetLocation(float horizontalRatio, float verticalRatio)
+	{
+		m_fHorizontalRatio = horizontalRatio;
+		m_fVerticalRatio = verticalRatio;
+
+		UpdateGridLocation();
+	}
+
 	// Grid square where the player is currently located.
 	int * GetGridLocation()
 	{
@@ -41,6 +57,12 @@ public:
 protected:
 	void UpdateGridLocation();
 
+	void Move(DirectionalCollsionDetectionInfo * contacts, float dx, float dy);
+	void MoveBy(float dx, float dy);
+
+	// Size of the game area in pixels, which the ratios are of.
+	float2 GetGameArea();
+
 private:
 	float m_fHorizontalRatio;
 	float m_fVerticalRatio;
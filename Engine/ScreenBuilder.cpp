@@ -1,180 +1,103 @@
 #include "pch.h"
 #include "ScreenBuilder.h"
-#include "ScreenUtils.h"
 
-ScreenBuilder::ScreenBuilder(float screenWidth, float screenHeight)
+ScreenBuilder::ScreenBuilder()
 {
-	m_fScreenWidth = screenWidth;
-	m_fScreenHeight = screenHeight;
 }
 
 /*
 	TODO: Use web services
 */
-void ScreenBuilder::BuildScreen1(std::vector<BaseSpriteData *> * m_treeData)
+void ScreenBuilder::BuildScreen1(TileMap * tiles)
 {
-	m_treeData->clear();
+	tiles->Clear();
 
-	float x = 0.0f;
-	float y = 0.0f;
+	tiles->Fill(TILE_LAYER_OBJECT, 0, 0, 6, 3, TILE_TREE);
+	tiles->Fill(TILE_LAYER_OBJECT, 11, 0, 16, 3, TILE_TREE);
 
-	for (int i = 0; i < 4; i++)
-	{
-		for (int j = 0; j < 7; j++)
-		{
-			ScreenUtils::CalculateSquareCenter(
-				m_fScreenWidth,
-				m_fScreenHeight,
-				j, i, &x, &y);
-
-			m_treeData->push_back(new TreeData(j, i, x, y));
-		}
-	}
-
-	for (int i = 0; i < 4; i++)
-	{
-		for (int j = 11; j < 17; j++)
-		{
-			ScreenUtils::CalculateSquareCenter(
-				m_fScreenWidth,
-				m_fScreenHeight,
-				j, i, &x, &y);
-
-			TreeData data(j, i, x, y);
-			m_treeData->push_back(new TreeData(j, i, x, y));
-		}
-	}
-
-	for (int i = 0; i < 5; i++)
-	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 4, &x, &y);
-		
-		m_treeData->push_back(new TreeData(i, 4, x, y));
-	}
+	tiles->Fill(TILE_LAYER_OBJECT, 0, 4, 4, 4, TILE_TREE);
+	tiles->Fill(TILE_LAYER_OBJECT, 0, 5, 3, 5, TILE_TREE);
+	tiles->Fill(TILE_LAYER_OBJECT, 0, 6, 2, 6, TILE_TREE);
 
-	for (int i = 0; i < 4; i++)
-	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 5, &x, &y);
+	tiles->Fill(TILE_LAYER_OBJECT, 12, 4, 16, 4, TILE_TREE);
 
-		m_treeData->push_back(new TreeData(i, 5, x, y));
-	}
+	tiles->Fill(TILE_LAYER_OBJECT, 12, 9, 16, 9, TILE_TREE);
 
-	for (int i = 0; i < 3; i++)
-	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 6, &x, &y);
-		
-		m_treeData->push_back(new TreeData(i, 6, x, y));
-	}
+	tiles->Fill(TILE_LAYER_OBJECT, 0, 10, 5, 10, TILE_TREE);
+	tiles->Fill(TILE_LAYER_OBJECT, 11, 10, 16, 10, TILE_TREE);
 
+	tiles->Fill(TILE_LAYER_OBJECT, 11, 11, 16, 14, TILE_TREE);
 
-	for (int i = 12; i < 17; i++)
-	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 4, &x, &y);
+	tiles->Fill(TILE_LAYER_OBJECT, 0, 11, 6, 11, TILE_TREE);
+	tiles->Fill(TILE_LAYER_OBJECT, 0, 12, 7, 14, TILE_TREE);
 
-		m_treeData->push_back(new TreeData(i, 4, x, y));
-	}
-
-
-	for (int i = 12; i < 17; i++)
-	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 9, &x, &y);
+//	tiles->Fill(TILE_LAYER_OBJECT, 0, 0, 16, 0, TILE_TREE);
+//	tiles->SetTile(TILE_LAYER_OBJECT, 4, 4, TILE_TREE);
+}
 
-		m_treeData->push_back(new TreeData(i, 9, x, y));
-	}
+void ScreenBuilder::AddExits(
+	OccupancyBitboard * blocking,
+	OccupancyBitboard * north,
+	OccupancyBitboard * east,
+	OccupancyBitboard * south,
+	OccupancyBitboard * west,
+	TriggerIndex * triggers)
+{
+	AddEdgeExits(blocking, north, triggers, 0, 0, 1, 0, NUM_GRID_COLUMNS, NORTH);
+	AddEdgeExits(blocking, south, triggers, 0, NUM_GRID_ROWS - 1, 1, 0, NUM_GRID_COLUMNS, SOUTH);
+	AddEdgeExits(blocking, west, triggers, 0, 0, 0, 1, NUM_GRID_ROWS, WEST);
+	AddEdgeExits(blocking, east, triggers, NUM_GRID_COLUMNS - 1, 0, 0, 1, NUM_GRID_ROWS, EAST);
+}
 
-	
-	for (int i = 0; i < 6; i++)
+void ScreenBuilder::AddEdgeExits(
+	OccupancyBitboard * blocking,
+	OccupancyBitboard * next,
+	TriggerIndex * triggers,
+	int column,
+	int row,
+	int dColumn,
+	int dRow,
+	int count,
+	int nDirection)
+{
+	// The edge of the world.
+	if (next == NULL)
 	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 10, &x, &y);
-
-		m_treeData->push_back(new TreeData(i, 10, x, y));
+		return;
 	}
 
+	int start = -1;
 
-	for (int i = 11; i < 17; i++)
+	// One past the end closes the last run.
+	for (int i = 0; i <= count; i++)
 	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 10, &x, &y);
+		int edgeColumn = column + i * dColumn;
+		int edgeRow = row + i * dRow;
 
-		m_treeData->push_back(new TreeData(i, 10, x, y));
-	}
+		// The player comes in at the opposite edge of the next screen.
+		int nextColumn = dColumn != 0 ? edgeColumn : NUM_GRID_COLUMNS - 1 - edgeColumn;
+		int nextRow = dRow != 0 ? edgeRow : NUM_GRID_ROWS - 1 - edgeRow;
 
+		bool bOpen = i < count &&
+			!blocking->IsOccupied(edgeColumn, edgeRow) &&
+			!next->IsOccupied(nextColumn, nextRow);
 
-	for (int i = 11; i < 17; i++)
-	{
-		for (int j = 11; j < 15; j++)
+		if (bOpen && start < 0)
 		{
-			ScreenUtils::CalculateSquareCenter(
-				m_fScreenWidth,
-				m_fScreenHeight,
-				i, j, &x, &y);
-
-			m_treeData->push_back(new TreeData(i, j, x, y));
+			start = i;
 		}
-	}
-
-
-	for (int i = 0; i < 7; i++)
-	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight, 
-			i, 11, &x, &y);
-
-		m_treeData->push_back(new TreeData(i, 11, x, y));
-	}
-
-	for (int i = 0; i < 8; i++)
-	{
-		for (int j = 12; j < 15; j++)
+		else if (!bOpen && start >= 0)
 		{
-			ScreenUtils::CalculateSquareCenter(
-				m_fScreenWidth,
-				m_fScreenHeight,
-				i, j, &x, &y);
-
-			m_treeData->push_back(new TreeData(i, j, x, y));
+			triggers->AddRegion(
+				TRIGGER_EXIT,
+				column + start * dColumn,
+				row + start * dRow,
+				column + (i - 1) * dColumn,
+				row + (i - 1) * dRow,
+				nDirection,
+				NULL);
+
+			start = -1;
 		}
 	}
-
-/*
-	for (int i = 0; i < 17; i++)
-	{
-		ScreenUtils::CalculateSquareCenter(
-			m_fScreenWidth,
-			m_fScreenHeight,
-			i, 0, &x, &y);
-
-		m_treeData->push_back(new TreeData(i, 0, x, y));
-	}
-*/
-
-/*
-	ScreenUtils::CalculateSquareCenter(
-		m_fScreenWidth,
-		m_fScreenHeight,
-		4, 4, &x, &y);
-
-	m_treeData->push_back(new TreeData(4, 4, x, y));
-*/
-}
\ No newline at end of file
+}
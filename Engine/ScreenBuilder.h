@@ -1,18 +1,48 @@
 #pragma once
 #include "pch.h"
-#include "TreeData.h"
+#include "TileMap.h"
+#include "OccupancyBitboard.h"
+#include "TriggerIndex.h"
 #include <vector>
 
 class ScreenBuilder
 {
 public:
-	ScreenBuilder(float screenWidth, float screenHeight);
-	void BuildScreen1(std::vector<BaseSpriteData *> * m_treeData);
+	ScreenBuilder();
+
+	// Fills in the tiles of the screen. Touches nothing else, so
+	//	it may run on a worker.
+	void BuildScreen1(TileMap * tiles);
+
+	// Adds an exit for every run of open grid spaces along each edge
+	//	of the screen, so that the player only leaves the screen on
+	//	the path. A space is only part of an exit if the space across
+	//	the edge, on the next screen, is open too, so the player never
+	//	arrives inside a tree. The next screens' blocking is NULL
+	//	where there is no screen, and that edge has no exits. Call
+	//	after building the screen: spaces opened up later, by burning
+	//	trees, do not become exits.
+	void AddExits(
+		OccupancyBitboard * blocking,
+		OccupancyBitboard * north,
+		OccupancyBitboard * east,
+		OccupancyBitboard * south,
+		OccupancyBitboard * west,
+		TriggerIndex * triggers);
 
 protected:
 
 private:
-	float m_fScreenWidth;
-	float m_fScreenHeight;
-
+	// The open runs of grid spaces from (column, row), stepping by
+	//	(dColumn, dRow) count times, that are open on next as well.
+	static void AddEdgeExits(
+		OccupancyBitboard * blocking,
+		OccupancyBitboard * next,
+		TriggerIndex * triggers,
+		int column,
+		int row,
+		int dColumn,
+		int dRow,
+		int count,
+		int nDirection);
 };
\ No newline at end of file
@@ -0,0 +1,186 @@
+#pragma once
+#include "pch.h"
+#include "FrameArena.h"
+#include <string.h>
+
+// Array of plain values (pointers, ints) with room for N of them
+//	inside the object, so the common case never touches the heap.
+//	Once full it spills into the frame arena, if it has one, or
+//	else onto the heap. Heap storage is kept by clear, so a vector
+//	that is refilled every frame stops allocating once it has grown
+//	to its largest size. Arena storage is given up by clear, so
+//	clear every vector that uses an arena before resetting it.
+template <typename T, int N>
+class SmallVector
+{
+public:
+	typedef T * iterator;
+	typedef const T * const_iterator;
+
+	SmallVector()
+	{
+		m_pData = m_inline;
+		m_nSize = 0;
+		m_nCapacity = N;
+		m_bHeap = false;
+		m_pArena = NULL;
+	}
+
+	SmallVector(const SmallVector & other)
+	{
+		m_pData = m_inline;
+		m_nSize = 0;
+		m_nCapacity = N;
+		m_bHeap = false;
+		m_pArena = NULL;
+
+		*this = other;
+	}
+
+	~SmallVector()
+	{
+		if (m_bHeap)
+		{
+			delete[] m_pData;
+		}
+	}
+
+	SmallVector & operator=(const SmallVector & other)
+	{
+		if (this != &other)
+		{
+			m_nSize = 0;
+			Reserve(other.m_nSize);
+			memcpy(m_pData, other.m_pData, other.m_nSize * sizeof(T));
+			m_nSize = other.m_nSize;
+		}
+
+		return *this;
+	}
+
+	// Where to spill once the inline storage is full. NULL for
+	//	the heap.
+	void SetArena(FrameArena * arena)
+	{
+		m_pArena = arena;
+	}
+
+	void push_back(const T & value)
+	{
+		if (m_nSize == m_nCapacity)
+		{
+			Reserve(m_nCapacity * 2);
+		}
+
+		m_pData[m_nSize++] = value;
+	}
+
+	void pop_back()
+	{
+		m_nSize--;
+	}
+
+	void clear()
+	{
+		m_nSize = 0;
+
+		if (!m_bHeap && m_pData != m_inline)
+		{
+			m_pData = m_inline;
+			m_nCapacity = N;
+		}
+	}
+
+	void Reserve(int nCapacity)
+	{
+		if (nCapacity <= m_nCapacity)
+		{
+			return;
+		}
+
+		T * pData = NULL;
+		bool bHeap = false;
+
+		if (m_pArena != NULL)
+		{
+			pData = (T *)m_pArena->Allocate(nCapacity * sizeof(T), __alignof(T));
+		}
+
+		if (pData == NULL)
+		{
+			pData = new T[nCapacity];
+			bHeap = true;
+		}
+
+		memcpy(pData, m_pData, m_nSize * sizeof(T));
+
+		if (m_bHeap)
+		{
+			delete[] m_pData;
+		}
+
+		m_pData = pData;
+		m_nCapacity = nCapacity;
+		m_bHeap = bHeap;
+	}
+
+	T & operator[](int index)
+	{
+		return m_pData[index];
+	}
+
+	const T & operator[](int index) const
+	{
+		return m_pData[index];
+	}
+
+	T & back()
+	{
+		return m_pData[m_nSize - 1];
+	}
+
+	iterator begin()
+	{
+		return m_pData;
+	}
+
+	iterator end()
+	{
+		return m_pData + m_nSize;
+	}
+
+	const_iterator begin() const
+	{
+		return m_pData;
+	}
+
+	const_iterator end() const
+	{
+		return m_pData + m_nSize;
+	}
+
+	int size() const
+	{
+		return m_nSize;
+	}
+
+	bool empty() const
+	{
+		return m_nSize == 0;
+	}
+
+	int capacity() const
+	{
+		return m_nCapacity;
+	}
+
+protected:
+
+private:
+	T m_inline[N];
+	T * m_pData;
+	int m_nSize;
+	int m_nCapacity;
+	bool m_bHeap;
+	FrameArena * m_pArena;
+};
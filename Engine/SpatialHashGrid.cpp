@@ -0,0 +1,174 @@
+#include "pch.h"
+#include "SpatialHashGrid.h"
+
+SpatialHashGrid::SpatialHashGrid()
+{
+	m_nColumns = 0;
+	m_nRows = 0;
+	m_nQueryStamp = 0;
+}
+
+void SpatialHashGrid::Resize(int nColumns, int nRows)
+{
+	m_nColumns = nColumns;
+	m_nRows = nRows;
+
+	m_buckets.clear();
+	m_buckets.resize(nColumns * nRows);
+	m_bucketLayers.assign(nColumns * nRows, 0);
+	m_entries.clear();
+}
+
+void SpatialHashGrid::Clear()
+{
+	for (size_t bucket = 0; bucket < m_buckets.size(); bucket++)
+	{
+		m_buckets[bucket].clear();
+		m_bucketLayers[bucket] = 0;
+	}
+
+	m_entries.clear();
+}
+
+void SpatialHashGrid::Insert(BaseSpriteData * sprite)
+{
+	Insert(sprite, sprite->column, sprite->row, sprite->column, sprite->row);
+}
+
+void SpatialHashGrid::Insert(
+	BaseSpriteData * sprite,
+	int minColumn,
+	int minRow,
+	int maxColumn,
+	int maxRow)
+{
+	if (!ClampRange(&minColumn, &minRow, &maxColumn, &maxRow))
+	{
+		return;
+	}
+
+	Entry entry;
+	entry.sprite = sprite;
+	entry.nLayerBit = 1u << sprite->nLayer;
+	entry.nQueryStamp = m_nQueryStamp;
+
+	int nEntry = (int)m_entries.size();
+	m_entries.push_back(entry);
+
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int column = minColumn; column <= maxColumn; column++)
+		{
+			int bucket = GetBucketIndex(column, row);
+
+			m_buckets[bucket].push_back(nEntry);
+			m_bucketLayers[bucket] |= entry.nLayerBit;
+		}
+	}
+}
+
+void SpatialHashGrid::Query(
+	int minColumn,
+	int minRow,
+	int maxColumn,
+	int maxRow,
+	CollisionCandidates * retVal,
+	unsigned int layerMask)
+{
+	if (!ClampRange(&minColumn, &minRow, &maxColumn, &maxRow))
+	{
+		return;
+	}
+
+	// Sprites spanning several cells are only returned once per query.
+	m_nQueryStamp++;
+
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int column = minColumn; column <= maxColumn; column++)
+		{
+			int nBucket = GetBucketIndex(column, row);
+
+			if ((m_bucketLayers[nBucket] & layerMask) == 0)
+			{
+				continue;
+			}
+
+			std::vector<int> & bucket = m_buckets[nBucket];
+
+			for (size_t i = 0; i < bucket.size(); i++)
+			{
+				Entry & entry = m_entries[bucket[i]];
+
+				if ((entry.nLayerBit & layerMask) != 0 &&
+					entry.nQueryStamp != m_nQueryStamp)
+				{
+					entry.nQueryStamp = m_nQueryStamp;
+					retVal->push_back(entry.sprite);
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::QueryNeighbourhood(
+	int column,
+	int row,
+	CollisionCandidates * retVal,
+	unsigned int layerMask)
+{
+	Query(column - 1, row - 1, column + 1, row + 1, retVal, layerMask);
+}
+
+void SpatialHashGrid::BeginQuery()
+{
+	m_nQueryStamp++;
+}
+
+int SpatialHashGrid::QueryCell(
+	int column,
+	int row,
+	unsigned int layerMask,
+	BaseSpriteData ** retVal,
+	int nMaxResults)
+{
+	if (column < 0 || column >= m_nColumns || row < 0 || row >= m_nRows)
+	{
+		return 0;
+	}
+
+	int nBucket = GetBucketIndex(column, row);
+
+	if ((m_bucketLayers[nBucket] & layerMask) == 0)
+	{
+		return 0;
+	}
+
+	std::vector<int> & bucket = m_buckets[nBucket];
+	int nResults = 0;
+
+	for (size_t i = 0; i < bucket.size() && nResults < nMaxResults; i++)
+	{
+		Entry & entry = m_entries[bucket[i]];
+
+		if ((entry.nLayerBit & layerMask) != 0 &&
+			entry.nQueryStamp != m_nQueryStamp)
+		{
+			entry.nQueryStamp = m_nQueryStamp;
+			retVal[nResults++] = entry.sprite;
+		}
+	}
+
+	return nResults;
+}
+
+// Limits the range to the grid. Returns false if nothing is left.
+bool SpatialHashGrid::ClampRange(int * minColumn, int * minRow, int * maxColumn, int * maxRow)
+{
+	if (*minColumn < 0) *minColumn = 0;
+	if (*minRow < 0) *minRow = 0;
+	if (*maxColumn > m_nColumns - 1) *maxColumn = m_nColumns - 1;
+	if (*maxRow > m_nRows - 1) *maxRow = m_nRows - 1;
+
+	return *minColumn <= *maxColumn && *minRow <= *maxRow;
+}
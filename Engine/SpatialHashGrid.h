@@ -0,0 +1,112 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "CollisionCandidates.h"
+#include "Constants.h"
+#include <vector>
+
+// Buckets of sprites keyed on grid column and row.
+//	A sprite that spans several cells is inserted into each of them;
+//	queries return it only once. Each bucket also keeps the layers of
+//	its sprites as bits, so a query can skip buckets holding nothing
+//	on the layers it wants.
+class SpatialHashGrid
+{
+public:
+	SpatialHashGrid();
+
+	void Resize(int nColumns, int nRows);
+	void Clear();
+
+	// Inserts the sprite into the cell at its own column and row.
+	void Insert(BaseSpriteData * sprite);
+
+	// Inserts the sprite into every cell of the inclusive range.
+	void Insert(
+		BaseSpriteData * sprite,
+		int minColumn,
+		int minRow,
+		int maxColumn,
+		int maxRow);
+
+	// Appends every sprite in the inclusive range of cells whose
+	//	layer bit is in layerMask.
+	void Query(
+		int minColumn,
+		int minRow,
+		int maxColumn,
+		int maxRow,
+		CollisionCandidates * retVal,
+		unsigned int layerMask = COLLISION_MASK_ALL);
+
+	// The 3x3 block of cells centred on column, row.
+	void QueryNeighbourhood(
+		int column,
+		int row,
+		CollisionCandidates * retVal,
+		unsigned int layerMask = COLLISION_MASK_ALL);
+
+	// Starts a query made of several calls to QueryCell. Until the
+	//	next BeginQuery, or Query, each sprite is written only once.
+	void BeginQuery();
+
+	// Writes up to nMaxResults sprites from one cell whose layer bit
+	//	is in layerMask and that have not been written since
+	//	BeginQuery. Returns how many were written; call again while
+	//	it fills the buffer. Never allocates.
+	int QueryCell(
+		int column,
+		int row,
+		unsigned int layerMask,
+		BaseSpriteData ** retVal,
+		int nMaxResults);
+
+	int GetNumColumns()
+	{
+		return m_nColumns;
+	}
+
+	int GetNumRows()
+	{
+		return m_nRows;
+	}
+
+	int GetNumSprites()
+	{
+		return (int)m_entries.size();
+	}
+
+protected:
+
+private:
+	struct Entry
+	{
+		BaseSpriteData * sprite;
+
+		// 1 << sprite->nLayer when it was inserted.
+		unsigned int nLayerBit;
+
+		// The last query that returned this entry.
+		unsigned int nQueryStamp;
+	};
+
+	int GetBucketIndex(int column, int row)
+	{
+		return row * m_nColumns + column;
+	}
+
+	bool ClampRange(int * minColumn, int * minRow, int * maxColumn, int * maxRow);
+
+	int m_nColumns;
+	int m_nRows;
+
+	std::vector<Entry> m_entries;
+
+	// Indices into m_entries.
+	std::vector<std::vector<int>> m_buckets;
+
+	// Layer bits of everything in each bucket.
+	std::vector<unsigned int> m_bucketLayers;
+
+	unsigned int m_nQueryStamp;
+};
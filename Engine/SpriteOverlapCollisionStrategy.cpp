@@ -8,54 +8,3 @@ SpriteOverlapCollisionStrategy::SpriteOverlapCollisionStrategy()
 {
 
 }
-
-bool SpriteOverlapCollisionStrategy::Detect(CollisionDetectionInfo * info)
-{
-	return false;
-}
-
-void SpriteOverlapCollisionStrategy::Detect(
-	list<BaseSpriteData> * retVal,
-	float2 playerSize,
-	float2 spriteSize,
-	Player * pPlayer,
-	vector<BaseSpriteData> * sprites,
-	float fWindowWidth,
-	float fWindowHeight)
-{
-/*
-	// Determine the 9 grid spaces around the player's location.
-	BroadStrategy(pPlayer, retVal);
-*/
-}
-
-//int SpriteOverlapCollisionStrategy::BroadStrategy(
-//	Player * player, 
-//	list<BaseSpriteData> * retVal)
-//{
-/*
-	int nCurrentHorizontalSpace = player->GetGridLocation()[HORIZONTAL_AXIS];
-	int nCurrentVerticalSpace = player->GetGridLocation()[VERTICAL_AXIS];
-*/
-
-/*
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace - 1, nCurrentVerticalSpace - 1));
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace, nCurrentVerticalSpace - 1));
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace + 1, nCurrentVerticalSpace - 1));
-
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace - 1, nCurrentVerticalSpace));
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace, nCurrentVerticalSpace));
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace + 1, nCurrentVerticalSpace));
-
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace - 1, nCurrentVerticalSpace + 1));
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace, nCurrentVerticalSpace + 1));
-	retVal->push_back(new GridSpace(nCurrentHorizontalSpace + 1, nCurrentVerticalSpace + 1));
-*/
-
-//	return 1;
-//}
-
-//int SpriteOverlapCollisionStrategy::NarrowStrategy(Player * player, list<BaseSpriteData> * retVal)
-//{
-//	return NULL;
-//}
\ No newline at end of file
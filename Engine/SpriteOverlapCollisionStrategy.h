@@ -1,28 +1,33 @@
 #pragma once
 #include "pch.h"
-#include "CollisionDetectionStrategy.h"
+#include "BroadPhaseStrategy.h"
 #include "Player.h"
 #include "BaseSpriteData.h"
 #include "GridSpace.h"
 
-class SpriteOverlapCollisionStrategy : public CollisionDetectionStrategy
+// Only sprites in the 9 grid spaces around the player are looked
+//	at, and of those the ones whose box overlaps the player's.
+class SpriteOverlapCollisionStrategy : public BroadPhaseStrategy<SpriteOverlapCollisionStrategy>
 {
 public:
 	SpriteOverlapCollisionStrategy();
-	bool Detect(CollisionDetectionInfo * info);
 
-	void Detect(
-		list<BaseSpriteData> * retVal,
-		float2 playerSize,
-		float2 spriteSize,
-		Player * pPlayer,
-		vector<BaseSpriteData> * sprites,
-		float fWindowWidth,
-		float fWindowHeight);
+	bool Accept(const BroadPhaseQuery & query, BaseSpriteData * sprite)
+	{
+		int * gridLocation = query.pPlayer->GetGridLocation();
+
+		int dx = sprite->column - gridLocation[HORIZONTAL_AXIS];
+		int dy = sprite->row - gridLocation[VERTICAL_AXIS];
+
+		if (dx < -1 || dx > 1 || dy < -1 || dy > 1)
+		{
+			return false;
+		}
+
+		return query.playerBox.Overlaps(GetSpriteBox(query, sprite));
+	}
 
 protected:
-	int BroadStrategy(Player * player, list<BaseSpriteData *> * retVal);
-	int NarrowStrategy(Player * player, list<BaseSpriteData *> * retVal);
 
 private:
 };
\ No newline at end of file
@@ -0,0 +1,387 @@
+#include "pch.h"
+#include "SweepAndPrune.h"
+#include <float.h>
+#include <algorithm>
+
+namespace
+{
+	float GetLowerBound(const BoundingBox & box, int axis)
+	{
+		return axis == HORIZONTAL_AXIS ? box.lowerBound.x : box.lowerBound.y;
+	}
+
+	float GetUpperBound(const BoundingBox & box, int axis)
+	{
+		return axis == HORIZONTAL_AXIS ? box.upperBound.x : box.upperBound.y;
+	}
+
+	std::pair<int, int> MakePair(int proxyA, int proxyB)
+	{
+		return proxyA < proxyB ?
+			std::make_pair(proxyA, proxyB) :
+			std::make_pair(proxyB, proxyA);
+	}
+}
+
+SweepAndPrune::SweepAndPrune()
+{
+	m_nFreeList = -1;
+	m_nProxyCount = 0;
+	m_nSwaps = 0;
+}
+
+int SweepAndPrune::AddProxy(const BoundingBox & box, void * userData)
+{
+	int proxyId = AllocateProxy(box, userData);
+
+	// Nothing to remove, so the previous box overlaps nothing.
+	BoundingBox nowhere;
+	nowhere.lowerBound = float2(FLT_MAX, FLT_MAX);
+	nowhere.upperBound = float2(FLT_MAX, FLT_MAX);
+
+	// Append the endpoints past everything else and let them sink into
+	//	place. The min passing other maxes reports the new pairs.
+	for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+	{
+		std::vector<Endpoint> & endpoints = m_endpoints[axis];
+
+		Endpoint endpoint;
+		endpoint.proxy = proxyId;
+
+		endpoint.value = GetUpperBound(box, axis);
+		endpoint.bMin = false;
+		endpoints.push_back(endpoint);
+		m_proxies[proxyId].endpoints[axis][1] = (int)endpoints.size() - 1;
+		SortDown(axis, (int)endpoints.size() - 1, nowhere);
+
+		endpoint.value = GetLowerBound(box, axis);
+		endpoint.bMin = true;
+		endpoints.push_back(endpoint);
+		m_proxies[proxyId].endpoints[axis][0] = (int)endpoints.size() - 1;
+		SortDown(axis, (int)endpoints.size() - 1, nowhere);
+	}
+
+	return proxyId;
+}
+
+void SweepAndPrune::AddProxies(
+	const BoundingBox * boxes,
+	void ** userData,
+	int count,
+	int * proxyIds)
+{
+	for (int i = 0; i < count; i++)
+	{
+		proxyIds[i] = AllocateProxy(boxes[i], userData != NULL ? userData[i] : NULL);
+
+		for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+		{
+			Endpoint endpoint;
+			endpoint.proxy = proxyIds[i];
+
+			endpoint.value = GetLowerBound(boxes[i], axis);
+			endpoint.bMin = true;
+			m_endpoints[axis].push_back(endpoint);
+
+			endpoint.value = GetUpperBound(boxes[i], axis);
+			endpoint.bMin = false;
+			m_endpoints[axis].push_back(endpoint);
+		}
+	}
+
+	for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+	{
+		std::vector<Endpoint> & endpoints = m_endpoints[axis];
+
+		std::sort(endpoints.begin(), endpoints.end(), Less);
+
+		for (int index = 0; index < (int)endpoints.size(); index++)
+		{
+			SetEndpoint(axis, index, endpoints[index]);
+		}
+	}
+
+	// One sweep along x. Every proxy whose min is passed while another
+	//	is open is tested against it; existing pairs are left alone.
+	std::vector<int> open;
+	std::vector<int> openIndex(m_proxies.size(), -1);
+	std::vector<Endpoint> & endpoints = m_endpoints[HORIZONTAL_AXIS];
+
+	for (size_t index = 0; index < endpoints.size(); index++)
+	{
+		int proxyId = endpoints[index].proxy;
+
+		if (endpoints[index].bMin)
+		{
+			const BoundingBox & box = m_proxies[proxyId].box;
+
+			for (size_t i = 0; i < open.size(); i++)
+			{
+				if (box.Overlaps(m_proxies[open[i]].box))
+				{
+					AddPair(proxyId, open[i]);
+				}
+			}
+
+			openIndex[proxyId] = (int)open.size();
+			open.push_back(proxyId);
+		}
+		else
+		{
+			int removed = openIndex[proxyId];
+
+			open[removed] = open.back();
+			openIndex[open[removed]] = removed;
+			open.pop_back();
+		}
+	}
+}
+
+void SweepAndPrune::RemoveProxy(int proxyId)
+{
+	BoundingBox oldBox = m_proxies[proxyId].box;
+
+	// A box that overlaps nothing, so no pairs are made on the way out.
+	m_proxies[proxyId].box.lowerBound = float2(FLT_MAX, FLT_MAX);
+	m_proxies[proxyId].box.upperBound = float2(FLT_MAX, FLT_MAX);
+
+	// Move the endpoints past everything else. The max passing other
+	//	mins drops all of the proxy's pairs on the way out.
+	for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+	{
+		std::vector<Endpoint> & endpoints = m_endpoints[axis];
+
+		int maxIndex = m_proxies[proxyId].endpoints[axis][1];
+		endpoints[maxIndex].value = FLT_MAX;
+		SortUp(axis, maxIndex, oldBox);
+
+		int minIndex = m_proxies[proxyId].endpoints[axis][0];
+		endpoints[minIndex].value = FLT_MAX;
+		SortUp(axis, minIndex, oldBox);
+
+		endpoints.pop_back();
+		endpoints.pop_back();
+	}
+
+	Proxy & proxy = m_proxies[proxyId];
+	proxy.userData = NULL;
+	proxy.nextFree = m_nFreeList;
+	m_nFreeList = proxyId;
+
+	m_nProxyCount--;
+}
+
+void SweepAndPrune::UpdateProxy(int proxyId, const BoundingBox & box)
+{
+	BoundingBox oldBox = m_proxies[proxyId].box;
+	m_proxies[proxyId].box = box;
+
+	for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+	{
+		std::vector<Endpoint> & endpoints = m_endpoints[axis];
+
+		int minIndex = m_proxies[proxyId].endpoints[axis][0];
+		int maxIndex = m_proxies[proxyId].endpoints[axis][1];
+
+		float lower = GetLowerBound(box, axis);
+		float upper = GetUpperBound(box, axis);
+
+		endpoints[minIndex].value = lower;
+		endpoints[maxIndex].value = upper;
+
+		// Grow before shrinking, so that a min never has to pass
+		//	its own max.
+		if (lower < GetLowerBound(oldBox, axis))
+		{
+			SortDown(axis, minIndex, oldBox);
+		}
+
+		if (upper > GetUpperBound(oldBox, axis))
+		{
+			SortUp(axis, maxIndex, oldBox);
+		}
+
+		if (lower > GetLowerBound(oldBox, axis))
+		{
+			SortUp(axis, m_proxies[proxyId].endpoints[axis][0], oldBox);
+		}
+
+		if (upper < GetUpperBound(oldBox, axis))
+		{
+			SortDown(axis, m_proxies[proxyId].endpoints[axis][1], oldBox);
+		}
+	}
+}
+
+void SweepAndPrune::GetPairChanges(
+	std::vector<std::pair<int, int>> * added,
+	std::vector<std::pair<int, int>> * removed)
+{
+	std::map<std::pair<int, int>, int>::iterator iterator;
+
+	for (iterator = m_changes.begin(); iterator != m_changes.end(); iterator++)
+	{
+		if (iterator->second > 0)
+		{
+			added->push_back(iterator->first);
+		}
+		else
+		{
+			removed->push_back(iterator->first);
+		}
+	}
+
+	m_changes.clear();
+}
+
+int SweepAndPrune::AllocateProxy(const BoundingBox & box, void * userData)
+{
+	int proxyId;
+
+	if (m_nFreeList != -1)
+	{
+		proxyId = m_nFreeList;
+		m_nFreeList = m_proxies[proxyId].nextFree;
+	}
+	else
+	{
+		proxyId = (int)m_proxies.size();
+		m_proxies.push_back(Proxy());
+	}
+
+	Proxy & proxy = m_proxies[proxyId];
+	proxy.box = box;
+	proxy.userData = userData;
+	proxy.nextFree = -1;
+
+	m_nProxyCount++;
+
+	return proxyId;
+}
+
+bool SweepAndPrune::IsOverlapping(int proxyA, int proxyB)
+{
+	return m_pairs.find(MakePair(proxyA, proxyB)) != m_pairs.end();
+}
+
+void SweepAndPrune::SetEndpoint(int axis, int index, const Endpoint & endpoint)
+{
+	m_endpoints[axis][index] = endpoint;
+	m_proxies[endpoint.proxy].endpoints[axis][endpoint.bMin ? 0 : 1] = index;
+}
+
+void SweepAndPrune::SortDown(int axis, int index, const BoundingBox & previous)
+{
+	std::vector<Endpoint> & endpoints = m_endpoints[axis];
+	Endpoint endpoint = endpoints[index];
+
+	while (index > 0 && Less(endpoint, endpoints[index - 1]))
+	{
+		Endpoint below = endpoints[index - 1];
+
+		if (below.proxy != endpoint.proxy)
+		{
+			if (endpoint.bMin && !below.bMin)
+			{
+				// Now overlapping on this axis.
+				if (m_proxies[endpoint.proxy].box.Overlaps(m_proxies[below.proxy].box))
+				{
+					AddPair(endpoint.proxy, below.proxy);
+				}
+			}
+			else if (!endpoint.bMin && below.bMin)
+			{
+				if (previous.Overlaps(m_proxies[below.proxy].box))
+				{
+					RemovePair(endpoint.proxy, below.proxy);
+				}
+			}
+		}
+
+		SetEndpoint(axis, index, below);
+		index--;
+		m_nSwaps++;
+	}
+
+	SetEndpoint(axis, index, endpoint);
+}
+
+void SweepAndPrune::SortUp(int axis, int index, const BoundingBox & previous)
+{
+	std::vector<Endpoint> & endpoints = m_endpoints[axis];
+	Endpoint endpoint = endpoints[index];
+	int last = (int)endpoints.size() - 1;
+
+	while (index < last && Less(endpoints[index + 1], endpoint))
+	{
+		Endpoint above = endpoints[index + 1];
+
+		if (above.proxy != endpoint.proxy)
+		{
+			if (!endpoint.bMin && above.bMin)
+			{
+				// Now overlapping on this axis.
+				if (m_proxies[endpoint.proxy].box.Overlaps(m_proxies[above.proxy].box))
+				{
+					AddPair(endpoint.proxy, above.proxy);
+				}
+			}
+			else if (endpoint.bMin && !above.bMin)
+			{
+				if (previous.Overlaps(m_proxies[above.proxy].box))
+				{
+					RemovePair(endpoint.proxy, above.proxy);
+				}
+			}
+		}
+
+		SetEndpoint(axis, index, above);
+		index++;
+		m_nSwaps++;
+	}
+
+	SetEndpoint(axis, index, endpoint);
+}
+
+void SweepAndPrune::AddPair(int proxyA, int proxyB)
+{
+	std::pair<int, int> key = MakePair(proxyA, proxyB);
+
+	if (!m_pairs.insert(key).second)
+	{
+		return;
+	}
+
+	// Cancels a removal earlier in the same frame.
+	std::map<std::pair<int, int>, int>::iterator iterator = m_changes.find(key);
+
+	if (iterator != m_changes.end())
+	{
+		m_changes.erase(iterator);
+	}
+	else
+	{
+		m_changes[key] = 1;
+	}
+}
+
+void SweepAndPrune::RemovePair(int proxyA, int proxyB)
+{
+	std::pair<int, int> key = MakePair(proxyA, proxyB);
+
+	if (m_pairs.erase(key) == 0)
+	{
+		return;
+	}
+
+	std::map<std::pair<int, int>, int>::iterator iterator = m_changes.find(key);
+
+	if (iterator != m_changes.end())
+	{
+		m_changes.erase(iterator);
+	}
+	else
+	{
+		m_changes[key] = -1;
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "pch.h"
+#include "BoundingBox.h"
+#include "Constants.h"
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+
+// Persistent sweep-and-prune broad phase.
+//	The interval endpoints on both axes are kept sorted between
+//	frames. Moving a proxy only insertion-sorts its own endpoints,
+//	which is nearly free when things move a little each frame, and
+//	every swap of a min past a max is exactly where a pair starts or
+//	stops overlapping. Only those changes are reported.
+class SweepAndPrune
+{
+public:
+	SweepAndPrune();
+
+	// Returns the id of the new proxy.
+	int AddProxy(const BoundingBox & box, void * userData);
+	// Adds many proxies at once: sorts the endpoints and sweeps once
+	//	instead of sinking each endpoint in from the end.
+	void AddProxies(
+		const BoundingBox * boxes,
+		void ** userData,
+		int count,
+		int * proxyIds);
+
+	void RemoveProxy(int proxyId);
+	void UpdateProxy(int proxyId, const BoundingBox & box);
+
+	void * GetUserData(int proxyId)
+	{
+		return m_proxies[proxyId].userData;
+	}
+
+	const BoundingBox & GetBox(int proxyId)
+	{
+		return m_proxies[proxyId].box;
+	}
+
+	// Appends the pairs that started and stopped overlapping since the
+	//	last call, lowest id first, sorted. A pair that started and
+	//	stopped in between is not reported.
+	void GetPairChanges(
+		std::vector<std::pair<int, int>> * added,
+		std::vector<std::pair<int, int>> * removed);
+
+	bool IsOverlapping(int proxyA, int proxyB);
+
+	int GetPairCount()
+	{
+		return (int)m_pairs.size();
+	}
+
+	int GetProxyCount()
+	{
+		return m_nProxyCount;
+	}
+
+	// Endpoint swaps since construction, for diagnostics.
+	int GetSwapCount()
+	{
+		return m_nSwaps;
+	}
+
+protected:
+
+private:
+	struct Endpoint
+	{
+		float value;
+		int proxy;
+		bool bMin;
+	};
+
+	struct Proxy
+	{
+		BoundingBox box;
+		void * userData;
+
+		// Index into m_endpoints[axis] of the min (0) and max (1).
+		int endpoints[NUM_DIMENSIONS][2];
+
+		// Next free proxy, or -1 while in use.
+		int nextFree;
+	};
+
+	static bool Less(const Endpoint & a, const Endpoint & b)
+	{
+		// Touching intervals count as overlapping, as in BoundingBox.
+		return a.value < b.value || (a.value == b.value && a.bMin && !b.bMin);
+	}
+
+	int AllocateProxy(const BoundingBox & box, void * userData);
+
+	void SetEndpoint(int axis, int index, const Endpoint & endpoint);
+
+	// previous is the moving proxy's box before this update. Pairs
+	//	only need looking up if it overlapped the other proxy.
+	void SortDown(int axis, int index, const BoundingBox & previous);
+	void SortUp(int axis, int index, const BoundingBox & previous);
+
+	void AddPair(int proxyA, int proxyB);
+	void RemovePair(int proxyA, int proxyB);
+
+	std::vector<Proxy> m_proxies;
+	std::vector<Endpoint> m_endpoints[NUM_DIMENSIONS];
+	int m_nFreeList;
+	int m_nProxyCount;
+	int m_nSwaps;
+
+	std::set<std::pair<int, int>> m_pairs;
+
+	// +1 added, -1 removed since the last GetPairChanges.
+	std::map<std::pair<int, int>, int> m_changes;
+};
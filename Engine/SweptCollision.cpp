@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "SweptCollision.h"
+#include "Constants.h"
+#include <float.h>
+#include <math.h>
+
+namespace
+{
+	void IntersectRect(
+		int * aTopLeft,
+		PackedCollisionMask * a,
+		int * bTopLeft,
+		PackedCollisionMask * b,
+		int * retVal)
+	{
+		int aRight = aTopLeft[HORIZONTAL_AXIS] + a->GetWidth();
+		int aBottom = aTopLeft[VERTICAL_AXIS] + a->GetHeight();
+		int bRight = bTopLeft[HORIZONTAL_AXIS] + b->GetWidth();
+		int bBottom = bTopLeft[VERTICAL_AXIS] + b->GetHeight();
+
+		retVal[INTERSECTION_LEFT] = aTopLeft[HORIZONTAL_AXIS] > bTopLeft[HORIZONTAL_AXIS] ? aTopLeft[HORIZONTAL_AXIS] : bTopLeft[HORIZONTAL_AXIS];
+		retVal[INTERSECTION_TOP] = aTopLeft[VERTICAL_AXIS] > bTopLeft[VERTICAL_AXIS] ? aTopLeft[VERTICAL_AXIS] : bTopLeft[VERTICAL_AXIS];
+		retVal[INTERSECTION_RIGHT] = aRight < bRight ? aRight : bRight;
+		retVal[INTERSECTION_BOTTOM] = aBottom < bBottom ? aBottom : bBottom;
+	}
+
+	bool Overlaps(
+		PackedCollisionMask * a,
+		int * aTopLeft,
+		PackedCollisionMask * b,
+		int * bTopLeft)
+	{
+		int intersectRect[4];
+		IntersectRect(aTopLeft, a, bTopLeft, b, intersectRect);
+
+		if (intersectRect[INTERSECTION_LEFT] >= intersectRect[INTERSECTION_RIGHT] ||
+			intersectRect[INTERSECTION_TOP] >= intersectRect[INTERSECTION_BOTTOM])
+		{
+			return false;
+		}
+
+		return PackedCollisionMask::Overlap(a, aTopLeft, b, bTopLeft, intersectRect);
+	}
+
+	// Steps a, whose box is aBox, one pixel of the longer axis at a
+	//	time, over the part of the move where the boxes overlap, until
+	//	overlaps(topLeft) says it touches b.
+	template<class OverlapTest>
+	bool Sweep(
+		const BoundingBox & aBox,
+		int * aTopLeft,
+		float2 displacement,
+		const BoundingBox & bBox,
+		OverlapTest overlaps,
+		float * pfTimeOfImpact)
+	{
+		float enter;
+		float exit;
+		int axis;
+
+		if (!SweptCollision::SweptBox(aBox, displacement, bBox, &enter, &exit, &axis))
+		{
+			return false;
+		}
+
+		if (overlaps(aTopLeft))
+		{
+			return false;
+		}
+
+		float length = fabs(displacement.x) > fabs(displacement.y) ? fabs(displacement.x) : fabs(displacement.y);
+		int nSteps = (int)ceil(length);
+
+		if (nSteps == 0)
+		{
+			return false;
+		}
+
+		int first = enter > 0.0f ? (int)floor(enter * nSteps) : 1;
+		int last = exit < 1.0f ? (int)ceil(exit * nSteps) : nSteps;
+
+		if (first < 1)
+		{
+			first = 1;
+		}
+
+		for (int step = first; step <= last; step++)
+		{
+			float t = (float)step / (float)nSteps;
+
+			int topLeft[2];
+			topLeft[HORIZONTAL_AXIS] = aTopLeft[HORIZONTAL_AXIS] + (int)floor(displacement.x * t + 0.5f);
+			topLeft[VERTICAL_AXIS] = aTopLeft[VERTICAL_AXIS] + (int)floor(displacement.y * t + 0.5f);
+
+			if (overlaps(topLeft))
+			{
+				// The last position that was still clear.
+				*pfTimeOfImpact = (float)(step - 1) / (float)nSteps;
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+bool SweptCollision::SweptBox(
+	const BoundingBox & moving,
+	float2 displacement,
+	const BoundingBox & target,
+	float * pfEnter,
+	float * pfExit,
+	int * pnAxis)
+{
+	float movingLower[2] = { moving.lowerBound.x, moving.lowerBound.y };
+	float movingUpper[2] = { moving.upperBound.x, moving.upperBound.y };
+	float targetLower[2] = { target.lowerBound.x, target.lowerBound.y };
+	float targetUpper[2] = { target.upperBound.x, target.upperBound.y };
+	float delta[2] = { displacement.x, displacement.y };
+
+	float enter = -FLT_MAX;
+	float exit = FLT_MAX;
+	int axisEntered = HORIZONTAL_AXIS;
+
+	for (int axis = 0; axis < NUM_DIMENSIONS; axis++)
+	{
+		if (delta[axis] == 0.0f)
+		{
+			// Never moves on this axis, so it must already overlap.
+			if (movingUpper[axis] <= targetLower[axis] || movingLower[axis] >= targetUpper[axis])
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		float t1 = (targetLower[axis] - movingUpper[axis]) / delta[axis];
+		float t2 = (targetUpper[axis] - movingLower[axis]) / delta[axis];
+
+		float axisEnter = t1 < t2 ? t1 : t2;
+		float axisExit = t1 < t2 ? t2 : t1;
+
+		if (axisEnter > enter)
+		{
+			enter = axisEnter;
+			axisEntered = axis;
+		}
+
+		if (axisExit < exit)
+		{
+			exit = axisExit;
+		}
+	}
+
+	if (enter > exit || enter > 1.0f || exit < 0.0f)
+	{
+		return false;
+	}
+
+	*pfEnter = enter;
+	*pfExit = exit;
+	*pnAxis = axisEntered;
+
+	return true;
+}
+
+bool SweptCollision::SweptMask(
+	PackedCollisionMask * a,
+	int * aTopLeft,
+	float2 displacement,
+	PackedCollisionMask * b,
+	int * bTopLeft,
+	float * pfTimeOfImpact)
+{
+	BoundingBox aBox;
+	aBox.lowerBound = float2((float)aTopLeft[HORIZONTAL_AXIS], (float)aTopLeft[VERTICAL_AXIS]);
+	aBox.upperBound = float2(aBox.lowerBound.x + a->GetWidth(), aBox.lowerBound.y + a->GetHeight());
+
+	BoundingBox bBox;
+	bBox.lowerBound = float2((float)bTopLeft[HORIZONTAL_AXIS], (float)bTopLeft[VERTICAL_AXIS]);
+	bBox.upperBound = float2(bBox.lowerBound.x + b->GetWidth(), bBox.lowerBound.y + b->GetHeight());
+
+	return Sweep(
+		aBox,
+		aTopLeft,
+		displacement,
+		bBox,
+		[a, b, bTopLeft](int * topLeft) { return Overlaps(a, topLeft, b, bTopLeft); },
+		pfTimeOfImpact);
+}
+
+bool SweptCollision::SweptField(
+	DistanceField * a,
+	int * aTopLeft,
+	float2 displacement,
+	DistanceField * b,
+	int * bTopLeft,
+	int width,
+	int height,
+	float * pfTimeOfImpact)
+{
+	BoundingBox aBox;
+	aBox.lowerBound = float2((float)aTopLeft[HORIZONTAL_AXIS], (float)aTopLeft[VERTICAL_AXIS]);
+	aBox.upperBound = float2(aBox.lowerBound.x + width, aBox.lowerBound.y + height);
+
+	BoundingBox bBox;
+	bBox.lowerBound = float2((float)bTopLeft[HORIZONTAL_AXIS], (float)bTopLeft[VERTICAL_AXIS]);
+	bBox.upperBound = float2(bBox.lowerBound.x + width, bBox.lowerBound.y + height);
+
+	return Sweep(
+		aBox,
+		aTopLeft,
+		displacement,
+		bBox,
+		[a, b, bTopLeft, width, height](int * topLeft)
+		{
+			return DistanceField::Overlap(a, topLeft, b, bTopLeft, width, height, NULL);
+		},
+		pfTimeOfImpact);
+}
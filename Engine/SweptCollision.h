@@ -0,0 +1,53 @@
+#pragma once
+#include "pch.h"
+#include "BoundingBox.h"
+#include "PackedCollisionMask.h"
+#include "DistanceField.h"
+
+// Time of impact queries for a sprite moving by a displacement over
+//	one step, so fast sprites cannot pass through thin obstacles
+//	between two frames. Times run from 0 (start) to 1 (end of step).
+class SweptCollision
+{
+public:
+	// Slab test of a moving box against a still one. pfEnter and
+	//	pfExit are when the boxes start and stop overlapping; pnAxis
+	//	is the axis that was entered last (HORIZONTAL_AXIS or
+	//	VERTICAL_AXIS). Returns false if they never meet in [0, 1].
+	static bool SweptBox(
+		const BoundingBox & moving,
+		float2 displacement,
+		const BoundingBox & target,
+		float * pfEnter,
+		float * pfExit,
+		int * pnAxis);
+
+	// First time in [0, 1] at which the set bits of a, moved by up to
+	//	displacement pixels, touch the set bits of b. Steps one pixel
+	//	at a time, but only while the boxes overlap. Returns false if
+	//	they never touch, or if they already touch at the start, which
+	//	is left to the contact pass.
+	static bool SweptMask(
+		PackedCollisionMask * a,
+		int * aTopLeft,
+		float2 displacement,
+		PackedCollisionMask * b,
+		int * bTopLeft,
+		float * pfTimeOfImpact);
+
+	// The same for two distance fields, both rendered at width x
+	//	height, touching as DistanceField::Overlap sees it.
+	static bool SweptField(
+		DistanceField * a,
+		int * aTopLeft,
+		float2 displacement,
+		DistanceField * b,
+		int * bTopLeft,
+		int width,
+		int height,
+		float * pfTimeOfImpact);
+
+protected:
+
+private:
+};
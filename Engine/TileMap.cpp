@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "TileMap.h"
+#include "ScreenUtils.h"
+#include <algorithm>
+
+namespace
+{
+	// Indexed by tile id.
+	const TileProperties TILE_PROPERTIES[NUM_TILE_TYPES] =
+	{
+		// TILE_NONE
+		{ COLLISION_LAYER_DECORATION, false, false },
+
+		// TILE_TREE
+		{ COLLISION_LAYER_OBSTACLE, true, true },
+	};
+}
+
+TileMap::TileMap()
+{
+	Clear();
+}
+
+void TileMap::Clear()
+{
+	std::fill(m_tiles, m_tiles + NUM_TILE_LAYERS * NUM_GRID_ROWS * NUM_GRID_COLUMNS, (uint16_t)TILE_NONE);
+}
+
+uint16_t TileMap::GetTile(int nLayer, int column, int row)
+{
+	if (!IsOnScreen(column, row))
+	{
+		return TILE_NONE;
+	}
+
+	return m_tiles[GetIndex(nLayer, column, row)];
+}
+
+void TileMap::SetTile(int nLayer, int column, int row, uint16_t tile)
+{
+	if (IsOnScreen(column, row))
+	{
+		m_tiles[GetIndex(nLayer, column, row)] = tile;
+	}
+}
+
+void TileMap::Fill(int nLayer, int left, int top, int right, int bottom, uint16_t tile)
+{
+	left = (std::max)(left, 0);
+	top = (std::max)(top, 0);
+	right = (std::min)(right, NUM_GRID_COLUMNS - 1);
+	bottom = (std::min)(bottom, NUM_GRID_ROWS - 1);
+
+	for (int row = top; row <= bottom; row++)
+	{
+		for (int column = left; column <= right; column++)
+		{
+			m_tiles[GetIndex(nLayer, column, row)] = tile;
+		}
+	}
+}
+
+void TileMap::SetTiles(const uint16_t * tiles)
+{
+	memcpy(m_tiles, tiles, sizeof(m_tiles));
+}
+
+const TileProperties & TileMap::GetProperties(uint16_t tile)
+{
+	if (tile >= NUM_TILE_TYPES)
+	{
+		tile = TILE_NONE;
+	}
+
+	return TILE_PROPERTIES[tile];
+}
+
+float2 TileMap::GetCenter(float screenWidth, float screenHeight, int column, int row)
+{
+	float2 center;
+
+	ScreenUtils::CalculateSquareCenter(
+		screenWidth,
+		screenHeight,
+		column, row, &center.x, &center.y);
+
+	return center;
+}
+
+void TileMap::BuildBlocking(OccupancyBitboard * blocking)
+{
+	blocking->Clear();
+
+	for (int nLayer = 0; nLayer < NUM_TILE_LAYERS; nLayer++)
+	{
+		for (int row = 0; row < NUM_GRID_ROWS; row++)
+		{
+			for (int column = 0; column < NUM_GRID_COLUMNS; column++)
+			{
+				const TileProperties & properties = GetProperties(m_tiles[GetIndex(nLayer, column, row)]);
+
+				if (properties.bCollidable && properties.bBlockable)
+				{
+					blocking->Set(column, row);
+				}
+			}
+		}
+	}
+}
+
+void TileMap::BuildSprites(
+	float screenWidth,
+	float screenHeight,
+	std::vector<BaseSpriteData> * pool,
+	std::vector<BaseSpriteData *> * sprites)
+{
+	pool->clear();
+	sprites->clear();
+
+	// Reserved up front, so that the pointers into pool hold.
+	int nCount = 0;
+
+	for (int i = 0; i < NUM_TILE_LAYERS * NUM_GRID_ROWS * NUM_GRID_COLUMNS; i++)
+	{
+		if (m_tiles[i] != TILE_NONE && m_tiles[i] < NUM_TILE_TYPES)
+		{
+			nCount++;
+		}
+	}
+
+	pool->reserve(nCount);
+	sprites->reserve(nCount);
+
+	for (int nLayer = 0; nLayer < NUM_TILE_LAYERS; nLayer++)
+	{
+		for (int row = 0; row < NUM_GRID_ROWS; row++)
+		{
+			for (int column = 0; column < NUM_GRID_COLUMNS; column++)
+			{
+				uint16_t tile = m_tiles[GetIndex(nLayer, column, row)];
+
+				// Unknown ids are TILE_NONE too, as in GetProperties.
+				if (tile == TILE_NONE || tile >= NUM_TILE_TYPES)
+				{
+					continue;
+				}
+
+				const TileProperties & properties = GetProperties(tile);
+				float2 center = GetCenter(screenWidth, screenHeight, column, row);
+
+				BaseSpriteData sprite(column, row, center.x, center.y);
+				sprite.SetBlockable(properties.bBlockable);
+				sprite.SetCollidable(properties.bCollidable);
+				sprite.SetLayer(properties.nCollisionLayer);
+
+				pool->push_back(sprite);
+				sprites->push_back(&pool->back());
+			}
+		}
+	}
+}
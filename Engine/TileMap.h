@@ -0,0 +1,78 @@
+#pragma once
+#include "pch.h"
+#include "BaseSpriteData.h"
+#include "OccupancyBitboard.h"
+#include "BasicMath.h"
+#include "Constants.h"
+#include <vector>
+
+// What a kind of tile does, shared by every tile of the kind.
+struct TileProperties
+{
+	// COLLISION_LAYER_* of the tile's sprite.
+	int nCollisionLayer;
+	bool bBlockable;
+	bool bCollidable;
+};
+
+// One screen of tiles: a tile id (TILE_*) per grid space for each
+//	TILE_LAYER_*, row by row, in a single array of about a kilobyte.
+//	What a tile does is looked up in a table by its id, and where it
+//	is comes from its row and column, so nothing is stored per tile.
+class TileMap
+{
+public:
+	TileMap();
+
+	// Every tile becomes TILE_NONE.
+	void Clear();
+
+	// Spaces outside the screen are TILE_NONE.
+	uint16_t GetTile(int nLayer, int column, int row);
+	void SetTile(int nLayer, int column, int row, uint16_t tile);
+
+	// Sets the inclusive block of spaces.
+	void Fill(int nLayer, int left, int top, int right, int bottom, uint16_t tile);
+
+	// Every tile at once, NUM_TILE_LAYERS x NUM_GRID_ROWS x
+	//	NUM_GRID_COLUMNS of them, layer by layer and row by row.
+	const uint16_t * GetTiles()
+	{
+		return m_tiles;
+	}
+
+	void SetTiles(const uint16_t * tiles);
+
+	// Unknown ids are treated as TILE_NONE.
+	static const TileProperties & GetProperties(uint16_t tile);
+
+	// The centre of a grid space in pixels.
+	static float2 GetCenter(float screenWidth, float screenHeight, int column, int row);
+
+	// Sets the space of every tile that is collidable and blocks.
+	void BuildBlocking(OccupancyBitboard * blocking);
+
+	// The sprites the collision code works on, one per tile that is
+	//	not TILE_NONE (or unknown), in one block in pool. sprites points into pool,
+	//	so both are only good until the next call.
+	void BuildSprites(
+		float screenWidth,
+		float screenHeight,
+		std::vector<BaseSpriteData> * pool,
+		std::vector<BaseSpriteData *> * sprites);
+
+protected:
+
+private:
+	static int GetIndex(int nLayer, int column, int row)
+	{
+		return (nLayer * NUM_GRID_ROWS + row) * NUM_GRID_COLUMNS + column;
+	}
+
+	static bool IsOnScreen(int column, int row)
+	{
+		return column >= 0 && column < NUM_GRID_COLUMNS && row >= 0 && row < NUM_GRID_ROWS;
+	}
+
+	uint16_t m_tiles[NUM_TILE_LAYERS * NUM_GRID_ROWS * NUM_GRID_COLUMNS];
+};
@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "TriggerIndex.h"
+#include <algorithm>
+
+TriggerIndex::TriggerIndex()
+{
+	m_bDirty = true;
+	m_nColumn = -1;
+	m_nRow = -1;
+	m_nGeneration = 0;
+}
+
+int TriggerIndex::AddRegion(
+	int nType,
+	int left,
+	int top,
+	int right,
+	int bottom,
+	int nDirection,
+	void * userData)
+{
+	TriggerRegion region;
+	region.nId = (int)m_regions.size();
+	region.nType = nType;
+	region.left = (std::max)(left, 0);
+	region.top = (std::max)(top, 0);
+	region.right = (std::min)(right, NUM_GRID_COLUMNS - 1);
+	region.bottom = (std::min)(bottom, NUM_GRID_ROWS - 1);
+	region.nDirection = nDirection;
+	region.userData = userData;
+
+	m_regions.push_back(region);
+	m_bDirty = true;
+
+	return region.nId;
+}
+
+void TriggerIndex::RemoveRegion(int nId)
+{
+	if (nId < 0 || nId >= (int)m_regions.size())
+	{
+		return;
+	}
+
+	m_regions[nId].nType = TRIGGER_NONE;
+	m_bDirty = true;
+
+	std::vector<int>::iterator inside = std::lower_bound(m_inside.begin(), m_inside.end(), nId);
+
+	if (inside != m_inside.end() && *inside == nId)
+	{
+		m_inside.erase(inside);
+	}
+}
+
+void TriggerIndex::Clear()
+{
+	m_regions.clear();
+	m_inside.clear();
+	m_bDirty = true;
+	m_nColumn = -1;
+	m_nRow = -1;
+	m_nGeneration++;
+}
+
+void TriggerIndex::SetCallbacks(int nType, TriggerCallback onEnter, TriggerCallback onLeave)
+{
+	m_onEnter[nType] = onEnter;
+	m_onLeave[nType] = onLeave;
+}
+
+void TriggerIndex::Update(int column, int row)
+{
+	// The player's space is one past the edge at a ratio of 1.
+	column = (std::max)(0, (std::min)(column, NUM_GRID_COLUMNS - 1));
+	row = (std::max)(0, (std::min)(row, NUM_GRID_ROWS - 1));
+
+	if (!m_bDirty && column == m_nColumn && row == m_nRow)
+	{
+		return;
+	}
+
+	m_nColumn = column;
+	m_nRow = row;
+
+	const int * ids = NULL;
+	int nIds = Query(column, row, &ids);
+
+	m_next.assign(ids, ids + nIds);
+
+	// Both lists are sorted, so one pass finds what changed.
+	m_pending.clear();
+
+	size_t i = 0;
+	size_t j = 0;
+
+	while (i < m_inside.size() || j < m_next.size())
+	{
+		if (j == m_next.size() || (i < m_inside.size() && m_inside[i] < m_next[j]))
+		{
+			m_pending.push_back(~m_inside[i++]);
+		}
+		else if (i == m_inside.size() || m_next[j] < m_inside[i])
+		{
+			m_pending.push_back(m_next[j++]);
+		}
+		else
+		{
+			i++;
+			j++;
+		}
+	}
+
+	// Leaves first, so that leaving one exit for the next ends up
+	//	in the new one. stable_partition keeps the id order.
+	std::stable_partition(m_pending.begin(), m_pending.end(), [](int n) { return n < 0; });
+
+	m_inside.swap(m_next);
+
+	unsigned int nGeneration = m_nGeneration;
+
+	for (size_t k = 0; k < m_pending.size(); k++)
+	{
+		// A callback moved to a new screen; the rest are gone.
+		if (nGeneration != m_nGeneration)
+		{
+			break;
+		}
+
+		bool bEnter = m_pending[k] >= 0;
+		int nId = bEnter ? m_pending[k] : ~m_pending[k];
+
+		// Copied, as the callback may add regions.
+		TriggerRegion region = m_regions[nId];
+
+		// Removed by an earlier callback.
+		if (region.nType == TRIGGER_NONE)
+		{
+			continue;
+		}
+
+		TriggerCallback & callback = bEnter ? m_onEnter[region.nType] : m_onLeave[region.nType];
+
+		if (callback)
+		{
+			callback(region);
+		}
+	}
+}
+
+int TriggerIndex::Query(int column, int row, const int ** ids)
+{
+	if (column < 0 || column >= NUM_GRID_COLUMNS || row < 0 || row >= NUM_GRID_ROWS)
+	{
+		*ids = NULL;
+		return 0;
+	}
+
+	if (m_bDirty)
+	{
+		Build();
+	}
+
+	int nCell = GetCell(column, row);
+	int nCount = m_cellStart[nCell + 1] - m_cellStart[nCell];
+
+	*ids = nCount > 0 ? &m_cellRegions[m_cellStart[nCell]] : NULL;
+
+	return nCount;
+}
+
+int TriggerIndex::GetInside(const int ** ids)
+{
+	*ids = m_inside.empty() ? NULL : &m_inside[0];
+
+	return (int)m_inside.size();
+}
+
+void TriggerIndex::Build()
+{
+	int nCells = NUM_GRID_COLUMNS * NUM_GRID_ROWS;
+
+	m_cellStart.assign(nCells + 1, 0);
+
+	// Count the regions of every space, then turn the counts into
+	//	where each space's ids start.
+	for (size_t i = 0; i < m_regions.size(); i++)
+	{
+		const TriggerRegion & region = m_regions[i];
+
+		if (region.nType == TRIGGER_NONE)
+		{
+			continue;
+		}
+
+		for (int row = region.top; row <= region.bottom; row++)
+		{
+			for (int column = region.left; column <= region.right; column++)
+			{
+				m_cellStart[GetCell(column, row) + 1]++;
+			}
+		}
+	}
+
+	for (int i = 0; i < nCells; i++)
+	{
+		m_cellStart[i + 1] += m_cellStart[i];
+	}
+
+	m_cellRegions.resize(m_cellStart[nCells]);
+
+	// Filled in id order, so every space's ids come out sorted.
+	m_cellCursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+
+	for (size_t i = 0; i < m_regions.size(); i++)
+	{
+		const TriggerRegion & region = m_regions[i];
+
+		if (region.nType == TRIGGER_NONE)
+		{
+			continue;
+		}
+
+		for (int row = region.top; row <= region.bottom; row++)
+		{
+			for (int column = region.left; column <= region.right; column++)
+			{
+				m_cellRegions[m_cellCursor[GetCell(column, row)]++] = region.nId;
+			}
+		}
+	}
+
+	m_bDirty = false;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "pch.h"
+#include "Constants.h"
+#include <vector>
+#include <functional>
+
+struct TriggerRegion
+{
+	int nId;
+
+	// TRIGGER_EXIT, TRIGGER_DOOR or TRIGGER_PICKUP.
+	int nType;
+
+	// Grid spaces covered, inclusive.
+	int left;
+	int top;
+	int right;
+	int bottom;
+
+	// NORTH, EAST, SOUTH or WEST for an exit, CENTER otherwise.
+	int nDirection;
+
+	// The door, sprite, etc. behind the region.
+	void * userData;
+};
+
+typedef std::function<void(const TriggerRegion &)> TriggerCallback;
+
+// The trigger regions of one screen (exit squares, doors, pickups),
+//	in grid spaces. Every grid space keeps the ids of the regions
+//	covering it, so finding the regions under the player is a single
+//	lookup however many there are. Update is called once per move and
+//	diffs the regions under the player against the last call, so each
+//	region hears about the player coming and going, and nothing else
+//	has to check the player's position itself.
+class TriggerIndex
+{
+public:
+	TriggerIndex();
+
+	// Returns the id of the region, good until Clear. The rectangle
+	//	is clamped to the screen.
+	int AddRegion(
+		int nType,
+		int left,
+		int top,
+		int right,
+		int bottom,
+		int nDirection,
+		void * userData);
+
+	int AddCell(int nType, int column, int row, int nDirection, void * userData)
+	{
+		return AddRegion(nType, column, row, column, row, nDirection, userData);
+	}
+
+	// The player leaves the region without a leave callback. Safe to
+	//	call from a callback (a pickup removing itself).
+	void RemoveRegion(int nId);
+
+	// Drops every region, without leave callbacks, for a new screen.
+	void Clear();
+
+	// Either may be empty.
+	void SetCallbacks(int nType, TriggerCallback onEnter, TriggerCallback onLeave);
+
+	// The player's grid space, which may be one past the edge of the
+	//	screen. Raises the leave callbacks, then the enter callbacks,
+	//	each in id order. Does nothing if neither the space nor the
+	//	regions changed since the last call. Not reentrant.
+	void Update(int column, int row);
+
+	// The ids of the regions covering a grid space, in id order.
+	int Query(int column, int row, const int ** ids);
+
+	// The ids of the regions the player is in, in id order.
+	int GetInside(const int ** ids);
+
+	const TriggerRegion & GetRegion(int nId)
+	{
+		return m_regions[nId];
+	}
+
+protected:
+
+private:
+	void Build();
+
+	static int GetCell(int column, int row)
+	{
+		return row * NUM_GRID_COLUMNS + column;
+	}
+
+	// Indexed by id. A removed region has its type set to TRIGGER_NONE.
+	std::vector<TriggerRegion> m_regions;
+
+	// Region ids per grid space, row by row: those of space i are
+	//	m_cellRegions[m_cellStart[i]] to m_cellRegions[m_cellStart[i + 1] - 1].
+	std::vector<int> m_cellStart;
+	std::vector<int> m_cellRegions;
+	std::vector<int> m_cellCursor;
+	bool m_bDirty;
+
+	// Sorted ids of the regions the player was in at the last Update.
+	std::vector<int> m_inside;
+	std::vector<int> m_next;
+
+	// Callbacks still to raise; ~id for a leave.
+	std::vector<int> m_pending;
+
+	int m_nColumn;
+	int m_nRow;
+
+	// Counts the calls to Clear, so that Update can tell one happened
+	//	in a callback.
+	unsigned int m_nGeneration;
+
+	TriggerCallback m_onEnter[NUM_TRIGGER_TYPES];
+	TriggerCallback m_onLeave[NUM_TRIGGER_TYPES];
+};
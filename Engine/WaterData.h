@@ -8,7 +8,7 @@ class WaterData : public BaseSpriteData
 public:
 	WaterData(int column, int row, float x, float y) : BaseSpriteData(column, row, x, y)
 	{
-
+		SetLayer(COLLISION_LAYER_WATER);
 	}
 
 protected:
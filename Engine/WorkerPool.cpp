@@ -0,0 +1,125 @@
+#include "pch.h"
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int nWorkers)
+{
+	if (nWorkers <= 0)
+	{
+		nWorkers = (std::max)(1, (int)std::thread::hardware_concurrency());
+	}
+
+	m_nWorkers = nWorkers;
+	m_pJob = NULL;
+	m_nJobs = 0;
+	m_nNextJob = 0;
+	m_nBusy = 0;
+	m_nGeneration = 0;
+	m_bStopping = false;
+
+	// Worker 0 is whoever calls ParallelFor.
+	for (int i = 1; i < nWorkers; i++)
+	{
+		m_threads.push_back(std::thread(&WorkerPool::WorkerMain, this, i));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_bStopping = true;
+	}
+
+	m_wake.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+}
+
+void WorkerPool::ParallelFor(int nJobs, const std::function<void(int, int)> & job)
+{
+	if (nJobs <= 0)
+	{
+		return;
+	}
+
+	// Not worth waking anyone for.
+	if (m_threads.empty() || nJobs == 1)
+	{
+		for (int i = 0; i < nJobs; i++)
+		{
+			job(i, 0);
+		}
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+
+		m_pJob = &job;
+		m_nJobs = nJobs;
+		m_nNextJob = 0;
+		m_nBusy = (int)m_threads.size();
+		m_nGeneration++;
+	}
+
+	m_wake.notify_all();
+
+	RunJobs(0);
+
+	// Every thread has to be done with job before it goes away.
+	std::unique_lock<std::mutex> guard(m_lock);
+	m_done.wait(guard, [this]() { return m_nBusy == 0; });
+
+	m_pJob = NULL;
+}
+
+void WorkerPool::WorkerMain(int nWorker)
+{
+	unsigned int nGeneration = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> guard(m_lock);
+			m_wake.wait(guard, [this, nGeneration]() { return m_bStopping || m_nGeneration != nGeneration; });
+
+			if (m_bStopping)
+			{
+				return;
+			}
+
+			nGeneration = m_nGeneration;
+		}
+
+		RunJobs(nWorker);
+
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+
+			if (--m_nBusy == 0)
+			{
+				m_done.notify_one();
+			}
+		}
+	}
+}
+
+void WorkerPool::RunJobs(int nWorker)
+{
+	for (;;)
+	{
+		int nJob = m_nNextJob++;
+
+		if (nJob >= m_nJobs)
+		{
+			return;
+		}
+
+		(*m_pJob)(nJob, nWorker);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "pch.h"
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// A fixed set of threads for splitting one frame's work into jobs.
+//	The threads are started once and sleep between calls, so a call
+//	costs a wake-up rather than a thread start.
+class WorkerPool
+{
+public:
+	// nWorkers counts the calling thread, which takes jobs too, so
+	//	1 runs everything on the caller. 0 means one per core.
+	WorkerPool(int nWorkers);
+	~WorkerPool();
+
+	int GetNumWorkers()
+	{
+		return m_nWorkers;
+	}
+
+	// Calls job(nJob, nWorker) for every nJob in [0, nJobs), and
+	//	returns once all of them are done. Jobs are handed out in
+	//	order to whichever worker is free, so they may finish in any
+	//	order; nWorker, in [0, GetNumWorkers()), lets a job pick
+	//	scratch memory of its own. Not reentrant.
+	void ParallelFor(int nJobs, const std::function<void(int, int)> & job);
+
+protected:
+
+private:
+	void WorkerMain(int nWorker);
+
+	// Takes jobs until there are none left.
+	void RunJobs(int nWorker);
+
+	int m_nWorkers;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_lock;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	const std::function<void(int, int)> * m_pJob;
+	int m_nJobs;
+	std::atomic<int> m_nNextJob;
+
+	// Threads still working on the current call.
+	int m_nBusy;
+
+	// Counts the calls, so that a thread can tell a new one.
+	unsigned int m_nGeneration;
+
+	bool m_bStopping;
+};
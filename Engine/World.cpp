@@ -0,0 +1,187 @@
+#include "pch.h"
+#include "World.h"
+#include <ppltasks.h>
+#include <algorithm>
+
+World::World(std::shared_ptr<BaseWorldBuilder> builder, int nBudget)
+{
+	m_pBuilder = builder;
+
+	// Room for the player's screen and its four neighbours, whatever
+	//	the budget.
+	m_nMaxScreens = (std::max)(5, nBudget / GetScreenCost());
+
+	m_nColumn = -1;
+	m_nRow = -1;
+	m_fHorizontalRatio = 0.0f;
+	m_fVerticalRatio = 0.0f;
+
+	m_nMisses = 0;
+}
+
+bool World::HasScreen(int column, int row)
+{
+	return m_pBuilder->HasScreen(column, row);
+}
+
+bool World::GetScreen(int column, int row, TileMap * tiles)
+{
+	if (!HasScreen(column, row))
+	{
+		return false;
+	}
+
+	TakePrefetches();
+
+	CachedScreen * screen = Find(column, row);
+
+	if (screen == NULL)
+	{
+		m_nMisses++;
+
+		screen = Insert(column, row);
+
+		if (!m_pBuilder->BuildScreen(column, row, &screen->tiles))
+		{
+			m_index.erase(screen->nKey);
+			m_screens.pop_front();
+
+			return false;
+		}
+	}
+
+	*tiles = screen->tiles;
+
+	return true;
+}
+
+void World::Update(int column, int row, float horizontalRatio, float verticalRatio)
+{
+	TakePrefetches();
+
+	bool bSameScreen = column == m_nColumn && row == m_nRow;
+
+	float dx = horizontalRatio - m_fHorizontalRatio;
+	float dy = verticalRatio - m_fVerticalRatio;
+
+	m_nColumn = column;
+	m_nRow = row;
+	m_fHorizontalRatio = horizontalRatio;
+	m_fVerticalRatio = verticalRatio;
+
+	// The ratios jump on a new screen; wait for a real move.
+	if (!bSameScreen)
+	{
+		return;
+	}
+
+	if (dx < 0.0f && horizontalRatio < WORLD_PREFETCH_RATIO)
+	{
+		Prefetch(column - 1, row);
+	}
+	else if (dx > 0.0f && horizontalRatio > 1.0f - WORLD_PREFETCH_RATIO)
+	{
+		Prefetch(column + 1, row);
+	}
+
+	if (dy < 0.0f && verticalRatio < WORLD_PREFETCH_RATIO)
+	{
+		Prefetch(column, row - 1);
+	}
+	else if (dy > 0.0f && verticalRatio > 1.0f - WORLD_PREFETCH_RATIO)
+	{
+		Prefetch(column, row + 1);
+	}
+}
+
+World::CachedScreen * World::Find(int column, int row)
+{
+	std::map<long long, std::list<CachedScreen>::iterator>::iterator found =
+		m_index.find(GetKey(column, row));
+
+	if (found == m_index.end())
+	{
+		return NULL;
+	}
+
+	// Moves the node without copying the screen.
+	m_screens.splice(m_screens.begin(), m_screens, found->second);
+
+	return &m_screens.front();
+}
+
+World::CachedScreen * World::Insert(int column, int row)
+{
+	while ((int)m_screens.size() >= m_nMaxScreens)
+	{
+		m_index.erase(m_screens.back().nKey);
+		m_screens.pop_back();
+	}
+
+	m_screens.push_front(CachedScreen());
+	m_screens.front().nKey = GetKey(column, row);
+	m_index[m_screens.front().nKey] = m_screens.begin();
+
+	return &m_screens.front();
+}
+
+void World::Prefetch(int column, int row)
+{
+	if (!HasScreen(column, row) || m_index.find(GetKey(column, row)) != m_index.end())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_pending.size(); i++)
+	{
+		if (m_pending[i]->column == column && m_pending[i]->row == row)
+		{
+			return;
+		}
+	}
+
+	std::shared_ptr<PendingScreen> pending = std::make_shared<PendingScreen>();
+	pending->bReady = false;
+	pending->bFound = false;
+	pending->column = column;
+	pending->row = row;
+
+	m_pending.push_back(pending);
+
+	std::shared_ptr<BaseWorldBuilder> builder = m_pBuilder;
+
+	concurrency::create_task([pending, builder]()
+	{
+		std::lock_guard<std::mutex> guard(pending->lock);
+
+		pending->bFound = builder->BuildScreen(pending->column, pending->row, &pending->tiles);
+		pending->bReady = true;
+	});
+}
+
+void World::TakePrefetches()
+{
+	size_t nLeft = 0;
+
+	for (size_t i = 0; i < m_pending.size(); i++)
+	{
+		std::shared_ptr<PendingScreen> pending = m_pending[i];
+
+		// Never stall the frame on the worker; try again next frame.
+		std::unique_lock<std::mutex> guard(pending->lock, std::try_to_lock);
+
+		if (!guard.owns_lock() || !pending->bReady)
+		{
+			m_pending[nLeft++] = pending;
+			continue;
+		}
+
+		// GetScreen may have built it in the meantime.
+		if (pending->bFound && m_index.find(GetKey(pending->column, pending->row)) == m_index.end())
+		{
+			Insert(pending->column, pending->row)->tiles = pending->tiles;
+		}
+	}
+
+	m_pending.resize(nLeft);
+}
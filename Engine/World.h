@@ -1,16 +1,117 @@
+#pragma once
 #include "pch.h"
+#include "TileMap.h"
+#include "WorldBuilder.h"
+#include "Constants.h"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
-/**
-  This represents the entire 2D world which is a grid of Screens
-*/
+// The entire 2D world, a grid of screens. Only the screens near the
+//	player are kept, in a cache bounded by a memory budget that drops
+//	the least recently used screen first, so the size of the world
+//	does not matter. As the player nears the edge of a screen, heading
+//	for it, the screen on the other side is built on a worker, so that
+//	it is ready by the time the player gets there.
 class World
 {
 public:
-	World();
-	//void AddScreen(int horizontalOffset, int verticalOffset, Screen screen);
-	//int MoveToScreen(int direction, Screen * currentScreen);
+	// builder is shared with the workers, so it outlives the world if
+	//	a prefetch is still running when the world is deleted.
+	World(std::shared_ptr<BaseWorldBuilder> builder, int nBudget);
+
+	bool HasScreen(int column, int row);
+
+	// Copies the screen into tiles. A screen that is not cached yet is
+	//	built right away. Returns false if there is no screen there.
+	bool GetScreen(int column, int row, TileMap * tiles);
+
+	// Call once per frame with the screen the player is on and where
+	//	on it they are. Takes in the prefetches that have finished and
+	//	starts the ones the player is heading for.
+	void Update(int column, int row, float horizontalRatio, float verticalRatio);
+
+	int GetNumCached()
+	{
+		return (int)m_screens.size();
+	}
+
+	int GetMaxCached()
+	{
+		return m_nMaxScreens;
+	}
+
+	// Roughly, in bytes.
+	int GetMemoryUsed()
+	{
+		return (int)m_screens.size() * GetScreenCost();
+	}
+
+	// Screens GetScreen had to build itself, because no prefetch had
+	//	finished them.
+	int GetNumMisses()
+	{
+		return m_nMisses;
+	}
 
 protected:
 
 private:
-};
\ No newline at end of file
+	struct CachedScreen
+	{
+		long long nKey;
+		TileMap tiles;
+	};
+
+	// Handed to the worker building it.
+	struct PendingScreen
+	{
+		std::mutex lock;
+		bool bReady;
+		bool bFound;
+		int column;
+		int row;
+		TileMap tiles;
+	};
+
+	static long long GetKey(int column, int row)
+	{
+		return ((long long)row << 32) | (unsigned int)column;
+	}
+
+	// A screen, with its list node and index entry, roughly.
+	static int GetScreenCost()
+	{
+		return sizeof(CachedScreen) + 8 * sizeof(void *);
+	}
+
+	// Makes the screen the most recently used. NULL if not cached.
+	CachedScreen * Find(int column, int row);
+
+	// The new screen is the most recently used; the least recently
+	//	used ones go to make room for it.
+	CachedScreen * Insert(int column, int row);
+
+	void Prefetch(int column, int row);
+	void TakePrefetches();
+
+	std::shared_ptr<BaseWorldBuilder> m_pBuilder;
+
+	// Most recently used first.
+	std::list<CachedScreen> m_screens;
+	std::map<long long, std::list<CachedScreen>::iterator> m_index;
+	int m_nMaxScreens;
+
+	std::vector<std::shared_ptr<PendingScreen>> m_pending;
+
+	// Where the player was at the last Update, to tell which way
+	//	they are heading.
+	int m_nColumn;
+	int m_nRow;
+	float m_fHorizontalRatio;
+	float m_fVerticalRatio;
+
+	int m_nMisses;
+};
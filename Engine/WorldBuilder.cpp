@@ -1,10 +1,20 @@
 #include "pch.h"
+#include "WorldBuilder.h"
 
-class BaseWorldBuilder
+OverworldBuilder::OverworldBuilder(int nColumns, int nRows)
 {
-public:
+	m_nColumns = nColumns;
+	m_nRows = nRows;
+}
 
-protected:
+bool OverworldBuilder::BuildScreen(int column, int row, TileMap * tiles)
+{
+	if (column < 0 || column >= m_nColumns || row < 0 || row >= m_nRows)
+	{
+		return false;
+	}
+
+	m_screenBuilder.BuildScreen1(tiles);
 
-private:
-};
\ No newline at end of file
+	return true;
+}
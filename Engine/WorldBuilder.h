@@ -0,0 +1,62 @@
+#pragma once
+#include "pch.h"
+#include "TileMap.h"
+#include "ScreenBuilder.h"
+
+// Where the screens of a World come from. BuildScreen runs on
+//	workers, several at once, so it must not touch anything the
+//	game changes.
+class BaseWorldBuilder
+{
+public:
+	virtual ~BaseWorldBuilder()
+	{
+	}
+
+	// Returns false if there is no screen at (column, row).
+	virtual bool BuildScreen(int column, int row, TileMap * tiles) = 0;
+
+	// The size of the world, in screens.
+	virtual int GetNumColumns() = 0;
+	virtual int GetNumRows() = 0;
+
+	// Whether BuildScreen would find a screen, without building it.
+	//	Worlds with holes in them override it.
+	virtual bool HasScreen(int column, int row)
+	{
+		return column >= 0 && column < GetNumColumns() &&
+			row >= 0 && row < GetNumRows();
+	}
+
+protected:
+
+private:
+};
+
+// An overworld of nColumns x nRows screens. Only the one screen is
+//	designed so far, so every screen is built from it.
+class OverworldBuilder : public BaseWorldBuilder
+{
+public:
+	OverworldBuilder(int nColumns, int nRows);
+
+	virtual bool BuildScreen(int column, int row, TileMap * tiles);
+
+	virtual int GetNumColumns()
+	{
+		return m_nColumns;
+	}
+
+	virtual int GetNumRows()
+	{
+		return m_nRows;
+	}
+
+protected:
+
+private:
+	ScreenBuilder m_screenBuilder;
+
+	int m_nColumns;
+	int m_nRows;
+};